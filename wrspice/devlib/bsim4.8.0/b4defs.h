@@ -975,6 +975,7 @@ struct bsim4SizeDependParam
     double BSIM4dvtp2factor; /* v4.7 */ 
 
     struct bsim4SizeDependParam  *pNext;
+    struct bsim4SizeDependParam  *pHashNext;    // SRW
 };
 
 
@@ -1933,6 +1934,10 @@ struct sBSIM4modelPOD
     double BSIM4kf;  
 
     struct bsim4SizeDependParam *pSizeDependParamKnot;
+    // SRW - hash table for finding size-dependent parameters by
+    // geometry.
+    struct bsim4SizeDependParam **pSizeDependTab;
+    unsigned int pSizeDependTabMask;
 
     /* Flags */
     unsigned  BSIM4mobModGiven :1;
@@ -2858,6 +2863,7 @@ struct sBSIM4model : sGENmodel, sBSIM4modelPOD
                 pSizeDependParamKnot = pSizeDependParamKnot->pNext;
                 delete px;
             }
+            delete [] pSizeDependTab;
             delete [] BSIM4version;
         }
 
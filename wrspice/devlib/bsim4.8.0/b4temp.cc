@@ -115,6 +115,22 @@ namespace
 
         return 0;
     }
+
+
+    // SRW - Hash the instance geometry, for finding the size-dependent
+    // parameters.  Instances with identical geometry share these.
+    //
+    inline unsigned int size_hash(double l, double w, double nf)
+    {
+        union { double d; unsigned long long u; } ul, uw, unf;
+        ul.d = l;
+        uw.d = w;
+        unf.d = nf;
+        unsigned long long h = ul.u*0x9e3779b97f4a7c15ULL;
+        h ^= uw.u + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h ^= unf.u + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return ((unsigned int)(h ^ (h >> 32)));
+    }
 }
 
 
@@ -247,8 +263,33 @@ BSIM4dev::temperature(sGENmodel *genmod, sCKT *ckt)
         }
         if (!model->BSIM4cgboGiven)
             model->BSIM4cgbo = 2.0 * model->BSIM4dwc * model->BSIM4coxe;
-        model->pSizeDependParamKnot = NULL;
+        // SRW - Free the size-dependent parameters from a previous
+        // call, these are recomputed for the present temperature.
+        while (model->pSizeDependParamKnot) {
+            pParam = model->pSizeDependParamKnot;
+            model->pSizeDependParamKnot = pParam->pNext;
+            delete pParam;
+        }
         pLastKnot = NULL;
+        {
+            // SRW - Size the hash table to the instance count.
+            unsigned int ninst = 0;
+            for (here = model->BSIM4instances; here != NULL;
+                    here = here->BSIM4nextInstance)
+                ninst++;
+            here = 0;
+            unsigned int tsize = 16;
+            while (tsize < ninst)
+                tsize <<= 1;
+            if (!model->pSizeDependTab ||
+                    model->pSizeDependTabMask != tsize - 1) {
+                delete [] model->pSizeDependTab;
+                model->pSizeDependTab = new bsim4SizeDependParam*[tsize];
+                model->pSizeDependTabMask = tsize - 1;
+            }
+            memset(model->pSizeDependTab, 0,
+                tsize*sizeof(bsim4SizeDependParam*));
+        }
 
         Tnom = model->BSIM4tnom;
         TRatio = Temp / Tnom;
@@ -506,7 +547,11 @@ BSIM4dev::temperature(sGENmodel *genmod, sCKT *ckt)
         for (here = model->BSIM4instances; here != NULL;
                 here = here->BSIM4nextInstance)
         {
-            pSizeDependParamKnot = model->pSizeDependParamKnot;
+            // SRW - Look up the geometry in the hash table, rather
+            // than searching the list.
+            unsigned int hv = size_hash(here->BSIM4l, here->BSIM4w,
+                here->BSIM4nf) & model->pSizeDependTabMask;
+            pSizeDependParamKnot = model->pSizeDependTab[hv];
             Size_Not_Found = 1;
             while ((pSizeDependParamKnot != NULL) && Size_Not_Found)
             {
@@ -519,10 +564,7 @@ BSIM4dev::temperature(sGENmodel *genmod, sCKT *ckt)
                     pParam = here->pParam; /*bug-fix  */
                 }
                 else
-                {
-                    pLastKnot = pSizeDependParamKnot;
-                    pSizeDependParamKnot = pSizeDependParamKnot->pNext;
-                }
+                    pSizeDependParamKnot = pSizeDependParamKnot->pHashNext;
             }
 
             /* stress effect */
@@ -540,6 +582,9 @@ BSIM4dev::temperature(sGENmodel *genmod, sCKT *ckt)
                 else
                     pLastKnot->pNext = pParam;
                 pParam->pNext = NULL;
+                pLastKnot = pParam;
+                pParam->pHashNext = model->pSizeDependTab[hv];
+                model->pSizeDependTab[hv] = pParam;
                 here->pParam = pParam;
 
                 pParam->Length = here->BSIM4l;
@@ -187,7 +187,7 @@ MESdev::MESdev()
     dv_numModelParms = NUMELEMS(MESmPTable);
     dv_modelParms = MESmPTable;
 
-    dv_flags = DV_TRUNC;
+    dv_flags = DV_TRUNC | DV_PARTEMP;
 };
 
 
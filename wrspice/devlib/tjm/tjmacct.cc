@@ -129,6 +129,11 @@ TJMdev::accept(sCKT *ckt, sGENmodel *genmod)
                     vmax = vj;
             }
         }
+        // The present recursion state of all instances becomes the
+        // previous state.
+        memcpy(model->tjm_Fcprev_re, model->tjm_Fc_re,
+            4*model->tjm_narray*model->tjm_ninst*sizeof(double));
+
         if (vmax > 0.0) {
             // Limit next time step.
             double delmax = model->TJMtsfact*wrsCONSTphi0/vmax;
@@ -157,15 +162,14 @@ namespace {
 }
 
 
+// Save the phase terms of the accepted point.  The recursion state
+// is saved for all instances of the model in TJMdev::accept.
+//
 void
 sTJMinstance::tjm_accept(double phi)
 {
-    sincos(0.5*phi, tjm_sinphi_2_old, tjm_cosphi_2_old);
-
     sTJMmodel *model = (sTJMmodel*)GENmodPtr;
-    for (int i = 0; i < model->tjm_narray; i++) {
-        tjm_Fcprev[i] = tjm_Fc[i];
-        tjm_Fsprev[i] = tjm_Fs[i];
-    }
+    sincos(0.5*phi, model->tjm_sinphi_2_old[tjm_index],
+        model->tjm_cosphi_2_old[tjm_index]);
 }
 
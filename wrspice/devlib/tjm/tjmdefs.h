@@ -85,6 +85,7 @@ struct TJMdev : public IFdevice
     void parse(int, sCKT*, sLine*);
 //    int loadTest(sGENinstance*, sCKT*);   
     int load(sGENinstance*, sCKT*);   
+    int preLoad(sGENmodel*, sCKT*);
     int setup(sGENmodel*, sCKT*, int*);  
 //    int unsetup(sGENmodel*, sCKT*);
     int resetup(sGENmodel*, sCKT*);
@@ -150,18 +151,10 @@ struct sTJMinstancePOD
 
     // Core MiTMoJCo implementation (github.com/mitmojco, D. R. Gulevich,
     // ITMO University St. Petersburg 197101, Russia) 
-    double tjm_sinphi_2_old;
-    double tjm_cosphi_2_old;
     double tjm_gcrit;
     double tjm_cqp;
     double tjm_cp;
-    IFcomplex *tjm_Fc;
-    IFcomplex *tjm_Fs;
-    IFcomplex *tjm_Fcprev;
-    IFcomplex *tjm_Fsprev;
-    IFcomplex *tjm_alpha0;
-    IFcomplex *tjm_alpha1;
-    IFcomplex *tjm_exp_z;
+    int tjm_index;          // column in the model recursion state arrays
 
     // These parameters scale with area
     double TJMcriti;        // junction critical current
@@ -255,16 +248,12 @@ struct sTJMinstance : sGENinstance, sTJMinstancePOD
     sTJMinstance *next()
         { return (static_cast<sTJMinstance*>(GENnextInstance)); }
 
-    ~sTJMinstance()
-        {
-            delete [] tjm_Fc;
-            // Fs and others are pointers into Fc.
-        }
-
+    int tjm_phase(sCKT*, struct tjmstuff&);
+    void tjm_setstate(sCKT*, struct tjmstuff&);
     void tjm_load(sCKT*, struct tjmstuff&);
     void tjm_init(double);
-    void tjm_newstep(sCKT*);;
     void tjm_update(double);
+    void tjm_currents();
     void tjm_accept(double);
 };
 
@@ -278,8 +267,39 @@ struct sTJMmodelPOD
     IFcomplex   *tjm_A;
     IFcomplex   *tjm_B;
     IFcomplex   *tjm_P;
+    // The recursion coefficients depend only on the time step, so are
+    // kept here and shared by all instances.
+    IFcomplex   *tjm_alpha0;
+    IFcomplex   *tjm_alpha1;
+    IFcomplex   *tjm_exp_z;
+    double      tjm_kdt;        // kgap*omegaJ*delta of the coefficients
     int         tjm_narray;
 
+    // The recursion state of the instances, in structure-of-arrays
+    // form so that all instances can be advanced in one pass.  Each
+    // of the eight F arrays has tjm_narray rows of tjm_ninst values,
+    // the instance with tjm_index k uses element k of each row.  The
+    // remaining arrays have one value per instance.  All are
+    // pointers into tjm_Fc_re.
+    double      *tjm_Fc_re;
+    double      *tjm_Fc_im;
+    double      *tjm_Fs_re;
+    double      *tjm_Fs_im;
+    double      *tjm_Fcprev_re;
+    double      *tjm_Fcprev_im;
+    double      *tjm_Fsprev_re;
+    double      *tjm_Fsprev_im;
+    double      *tjm_sinphi_2_old;
+    double      *tjm_cosphi_2_old;
+    double      *tjm_sinphi_2;
+    double      *tjm_cosphi_2;
+    double      *tjm_FcSp;      // cosine for pairs
+    double      *tjm_FcSq;      // cosine for qp
+    double      *tjm_FsSp;      // sine for pairs
+    double      *tjm_FsSq;      // sine for qp
+    int         tjm_ninst;
+    bool        tjm_batched;    // instances were evaluated in preLoad
+
     int         TJMrtype;
     int         TJMictype;
     double      TJMvg;
@@ -330,13 +350,17 @@ struct sTJMmodel : sGENmodel, sTJMmodelPOD
     ~sTJMmodel()
         {
             delete [] tjm_A;
-            // B and P are pointers into A array
+            // B, P, and the recursion coefficients are pointers into
+            // A array
+            delete [] tjm_Fc_re;
         }
 
     sTJMmodel *next()    { return (static_cast<sTJMmodel*>(GENnextModel)); }
     sTJMinstance *inst() { return (static_cast<sTJMinstance*>(GENinstances)); }
 
     int tjm_init();
+    void tjm_newstep(double);
+    void tjm_recurse(int, int);
 };
 
 // Tunnel parameters database return.  The coefficients are created
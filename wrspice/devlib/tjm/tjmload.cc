@@ -64,6 +64,66 @@ struct tjmstuff
 }
 
 
+namespace {
+    // Intel/GCC-specific function for fast evaluation of sin and cos
+    // of an angle.
+    //
+    inline void sincos(double a, double &si, double &ci)
+    {
+#ifdef ASM_SINCOS
+        asm("fsincos" : "=t" (ci), "=u"  (si) : "0" (a));
+#else
+        si = sin(a);
+        ci = cos(a);
+#endif
+    }
+}
+
+
+// The recursion coefficients are shared by the instances of a model,
+// so are updated for a new time step here, before the instances are
+// loaded.
+//
+// In transient analysis, when the instances are not loaded in
+// threads, the phase of each instance is found here, then the
+// recursion is advanced for all instances of the model in a single
+// pass over the structure-of-arrays state, which vectorizes.  The
+// load function then only stamps the matrix.  When loading in
+// threads, each instance is updated in load as before.
+//
+int
+TJMdev::preLoad(sGENmodel *genmod, sCKT *ckt)
+{
+    bool batch = !ckt->CKTloadThreads && !(ckt->CKTmode & MODEDC) &&
+        (ckt->CKTmode & (MODEINITFLOAT | MODEINITPRED | MODEINITTRAN));
+
+    sTJMmodel *model = static_cast<sTJMmodel*>(genmod);
+    for ( ; model; model = model->next()) {
+        if (ckt->CKTmode & MODEINITPRED)
+            model->tjm_newstep(ckt->CKTdelta);
+        model->tjm_batched = false;
+        if (!batch)
+            continue;
+
+        sTJMinstance *inst;
+        for (inst = model->inst(); inst; inst = inst->next()) {
+            tjmstuff ts;
+            int error = inst->tjm_phase(ckt, ts);
+            if (error != OK)
+                return (error);
+            int k = inst->tjm_index;
+            sincos(0.5*ts.ts_phi, model->tjm_sinphi_2[k],
+                model->tjm_cosphi_2[k]);
+        }
+        model->tjm_recurse(0, model->tjm_ninst);
+        for (inst = model->inst(); inst; inst = inst->next())
+            inst->tjm_currents();
+        model->tjm_batched = true;
+    }
+    return (OK);
+}
+
+
 int
 TJMdev::load(sGENinstance *in_inst, sCKT *ckt)
 {
@@ -93,6 +153,7 @@ TJMdev::load(sGENinstance *in_inst, sCKT *ckt)
                 ts.tjm_iv(model, inst);
             }
 */
+            inst->tjm_setstate(ckt, ts);
             inst->tjm_load(ckt, ts);
             // don't load shunt
 #ifdef NEWLSH
@@ -119,6 +180,7 @@ TJMdev::load(sGENinstance *in_inst, sCKT *ckt)
             ts.ts_dcrt = 0.0;
             ts.ts_crt  = 0.0;
         
+            inst->tjm_setstate(ckt, ts);
             inst->tjm_load(ckt, ts);
 
             // Load the shunt resistance implied if vshunt given.
@@ -176,47 +238,20 @@ TJMdev::load(sGENinstance *in_inst, sCKT *ckt)
     }
 #endif
 
-    ts.ts_pfac = ckt->CKTdelta / PHI0_2PI;
-    if (ckt->CKTorder > 1)
-        ts.ts_pfac *= .5;
+    if (model->tjm_batched) {
+        // The phase and recursion were done in preLoad.
+        ts.ts_phi = *(ckt->CKTstate0 + inst->TJMphase);
+    }
+    else {
+        int error = inst->tjm_phase(ckt, ts);
+        if (error != OK)
+            return (error);
+        if (!(ckt->CKTmode & MODEDC))
+            inst->tjm_update(ts.ts_phi);
+    }
+    inst->tjm_load(ckt, ts);
 
     if (ckt->CKTmode & MODEINITFLOAT) {
-        ts.ts_vj  = *(ckt->CKTrhsOld + inst->TJMposNode) -
-                *(ckt->CKTrhsOld + inst->TJMnegNode);
-
-        double absvj  = fabs(ts.ts_vj);
-        double temp   = *(ckt->CKTstate0 + inst->TJMvoltage);
-        double absold = fabs(temp);
-        double maxvj  = SPMAX(absvj,absold);
-        temp  -= ts.ts_vj;
-        double absdvj = fabs(temp);
-
-        // check convergence
-        if (!ckt->CKTnoncon) {
-            double tol = ckt->CKTcurTask->TSKreltol*maxvj +
-                ckt->CKTcurTask->TSKabstol;
-            if (absdvj > tol) {
-#ifdef TJM_DEBUG
-                printf("%s %g %g %g %g\n", (const char*)inst->GENname,
-                    maxvj, absdvj, ts.ts_vj,
-                    *(ckt->CKTstate0 + inst->TJMvoltage));
-#endif
-                ckt->incNoncon();
-            }
-        }
-
-        ts.ts_phi = *(ckt->CKTstate1 + inst->TJMphase);
-        temp = ts.ts_vj;
-        if (ckt->CKTorder > 1)
-            temp += *(ckt->CKTstate1 + inst->TJMvoltage);
-        ts.ts_phi += ts.ts_pfac*temp;
-
-        ts.ts_dcrt = 0;
-        ts.ts_crt  = inst->TJMcriti;
-    
-        ckt->integrate(inst->TJMvoltage, inst->TJMdelVdelT);
-        inst->tjm_load(ckt, ts);
-
         // Load the shunt resistance implied if vshunt given.
         if (model->TJMvShuntGiven && inst->TJMgshunt > 0.0) {
             ckt->ldadd(inst->TJMrshPosPosPtr, inst->TJMgshunt);
@@ -265,30 +300,6 @@ TJMdev::load(sGENinstance *in_inst, sCKT *ckt)
     }
 
     if (ckt->CKTmode & MODEINITPRED) {
-
-        double y0 = DEV.pred(ckt, inst->TJMdvdt);
-        if (ckt->CKTorder != 1)
-            y0 += *(ckt->CKTstate1 + inst->TJMdvdt);
-
-        double temp = *(ckt->CKTstate1 + inst->TJMvoltage);
-        double rag0  = ckt->CKTorder == 1 ? ckt->CKTdelta : .5*ckt->CKTdelta;
-        ts.ts_vj  = temp + rag0*y0;
-
-        ts.ts_phi = *(ckt->CKTstate1 + inst->TJMphase);
-        temp = ts.ts_vj;
-        if (ckt->CKTorder > 1)
-            temp += *(ckt->CKTstate1 + inst->TJMvoltage);
-        ts.ts_phi += ts.ts_pfac*temp;
-
-        inst->TJMdelVdelT = ckt->find_ceq(inst->TJMvoltage);
-
-        inst->tjm_newstep(ckt);
-
-        ts.ts_dcrt = 0;
-        ts.ts_crt  = inst->TJMcriti;
-
-        inst->tjm_load(ckt, ts);
-
         // Load the shunt resistance implied if vshunt given.
         if (model->TJMvShuntGiven && inst->TJMgshunt > 0.0) {
             ckt->ldadd(inst->TJMrshPosPosPtr, inst->TJMgshunt);
@@ -338,32 +349,6 @@ TJMdev::load(sGENinstance *in_inst, sCKT *ckt)
     }
 
     if (ckt->CKTmode & MODEINITTRAN) {
-        if (ckt->CKTmode & MODEUIC) {
-            ts.ts_vj  = inst->TJMinitVoltage;
-            ts.ts_phi = inst->TJMinitPhase;
-            *(ckt->CKTstate1 + inst->TJMvoltage) = ts.ts_vj;
-            *(ckt->CKTstate1 + inst->TJMphase) = ts.ts_phi;
-        }
-        else {
-            ts.ts_vj  = 0;
-#ifdef NEWJJDC
-            *(ckt->CKTstate1 + inst->TJMvoltage) = 0.0;
-            // The RHS node voltage was set to zero in the doTask code.
-            ts.ts_phi = *(ckt->CKTstate1 + inst->TJMphase);
-            *(ckt->CKTstate0 + inst->TJMvoltage) = 0.0;
-#else
-            ts.ts_phi = 0;
-#endif
-        }
-
-        inst->TJMdelVdelT = ckt->find_ceq(inst->TJMvoltage);
-        inst->tjm_init(ts.ts_phi);
-
-        ts.ts_dcrt = 0;
-        ts.ts_crt  = inst->TJMcriti;
-
-        inst->tjm_load(ckt, ts);
-
         if (model->TJMvShuntGiven && inst->TJMgshunt > 0.0) {
             ckt->ldadd(inst->TJMrshPosPosPtr, inst->TJMgshunt);
             ckt->ldadd(inst->TJMrshPosNegPtr, -inst->TJMgshunt);
@@ -429,30 +414,125 @@ TJMdev::load(sGENinstance *in_inst, sCKT *ckt)
 // End of TJMdev functions.
 
 
-namespace {
-    // Intel/GCC-specific function for fast evaluation of sin and cos
-    // of an angle.
-    //
-    inline void sincos(double a, double &si, double &ci)
-    {
-#ifdef ASM_SINCOS
-        asm("fsincos" : "=t" (ci), "=u"  (si) : "0" (a));
+// Compute the junction voltage and phase for a transient load, and
+// save these in the state vector.  This is the part of the load
+// that precedes the recursion update.
+//
+int
+sTJMinstance::tjm_phase(sCKT *ckt, tjmstuff &ts)
+{
+    ts.ts_pfac = ckt->CKTdelta / PHI0_2PI;
+    if (ckt->CKTorder > 1)
+        ts.ts_pfac *= .5;
+
+    if (ckt->CKTmode & MODEINITFLOAT) {
+        ts.ts_vj  = *(ckt->CKTrhsOld + TJMposNode) -
+                *(ckt->CKTrhsOld + TJMnegNode);
+
+        double absvj  = fabs(ts.ts_vj);
+        double temp   = *(ckt->CKTstate0 + TJMvoltage);
+        double absold = fabs(temp);
+        double maxvj  = SPMAX(absvj,absold);
+        temp  -= ts.ts_vj;
+        double absdvj = fabs(temp);
+
+        // check convergence
+        if (!ckt->CKTnoncon) {
+            double tol = ckt->CKTcurTask->TSKreltol*maxvj +
+                ckt->CKTcurTask->TSKabstol;
+            if (absdvj > tol) {
+#ifdef TJM_DEBUG
+                printf("%s %g %g %g %g\n", (const char*)GENname,
+                    maxvj, absdvj, ts.ts_vj,
+                    *(ckt->CKTstate0 + TJMvoltage));
+#endif
+                ckt->incNoncon();
+            }
+        }
+
+        ts.ts_phi = *(ckt->CKTstate1 + TJMphase);
+        temp = ts.ts_vj;
+        if (ckt->CKTorder > 1)
+            temp += *(ckt->CKTstate1 + TJMvoltage);
+        ts.ts_phi += ts.ts_pfac*temp;
+
+        ts.ts_dcrt = 0;
+        ts.ts_crt  = TJMcriti;
+
+        ckt->integrate(TJMvoltage, TJMdelVdelT);
+    }
+    else if (ckt->CKTmode & MODEINITPRED) {
+        double y0 = DEV.pred(ckt, TJMdvdt);
+        if (ckt->CKTorder != 1)
+            y0 += *(ckt->CKTstate1 + TJMdvdt);
+
+        double temp = *(ckt->CKTstate1 + TJMvoltage);
+        double rag0  = ckt->CKTorder == 1 ? ckt->CKTdelta : .5*ckt->CKTdelta;
+        ts.ts_vj  = temp + rag0*y0;
+
+        ts.ts_phi = *(ckt->CKTstate1 + TJMphase);
+        temp = ts.ts_vj;
+        if (ckt->CKTorder > 1)
+            temp += *(ckt->CKTstate1 + TJMvoltage);
+        ts.ts_phi += ts.ts_pfac*temp;
+
+        TJMdelVdelT = ckt->find_ceq(TJMvoltage);
+
+        ts.ts_dcrt = 0;
+        ts.ts_crt  = TJMcriti;
+    }
+    else if (ckt->CKTmode & MODEINITTRAN) {
+        if (ckt->CKTmode & MODEUIC) {
+            ts.ts_vj  = TJMinitVoltage;
+            ts.ts_phi = TJMinitPhase;
+            *(ckt->CKTstate1 + TJMvoltage) = ts.ts_vj;
+            *(ckt->CKTstate1 + TJMphase) = ts.ts_phi;
+        }
+        else {
+            ts.ts_vj  = 0;
+#ifdef NEWJJDC
+            *(ckt->CKTstate1 + TJMvoltage) = 0.0;
+            // The RHS node voltage was set to zero in the doTask code.
+            ts.ts_phi = *(ckt->CKTstate1 + TJMphase);
+            *(ckt->CKTstate0 + TJMvoltage) = 0.0;
 #else
-        si = sin(a);
-        ci = cos(a);
+            ts.ts_phi = 0;
 #endif
+        }
+
+        TJMdelVdelT = ckt->find_ceq(TJMvoltage);
+        tjm_init(ts.ts_phi);
+
+        ts.ts_dcrt = 0;
+        ts.ts_crt  = TJMcriti;
     }
+    else
+        return (E_BADPARM);
+
+    tjm_setstate(ckt, ts);
+    return (OK);
 }
 
 
+// Save the junction values in the state vector.  The pair and qp
+// currents saved are those of the previous evaluation.
+//
 void
-sTJMinstance::tjm_load(sCKT *ckt, tjmstuff &ts)
+sTJMinstance::tjm_setstate(sCKT *ckt, tjmstuff &ts)
 {
     *(ckt->CKTstate0 + TJMvoltage) = ts.ts_vj;
     *(ckt->CKTstate0 + TJMphase)   = ts.ts_phi;
     *(ckt->CKTstate0 + TJMcrti)    = tjm_cp;
     *(ckt->CKTstate0 + TJMqpi)     = tjm_cqp + (tjm_gcrit + TJMg0)*ts.ts_vj;
+}
+
 
+// Load the matrix and rhs.  Except in DC analysis, the recursion must
+// have been updated for the present phase.
+//
+void
+sTJMinstance::tjm_load(sCKT *ckt, tjmstuff &ts)
+{
     double crhs, gqt;
     if (ckt->CKTmode & MODEDC) {
         double crt = ts.ts_crt*sin(ts.ts_phi); 
@@ -460,7 +540,6 @@ sTJMinstance::tjm_load(sCKT *ckt, tjmstuff &ts)
         crhs = crt - gqt*ts.ts_phi;
     }
     else {
-        tjm_update(ts.ts_phi);
         crhs = tjm_cp + tjm_cqp + TJMdelVdelT*TJMcap;
         gqt = tjm_gcrit + TJMg0 +  ckt->CKTag[0]*TJMcap;
     }
@@ -497,41 +576,41 @@ sTJMinstance::tjm_load(sCKT *ckt, tjmstuff &ts)
 void
 sTJMinstance::tjm_init(double phi)
 {
+    sTJMmodel *model = (sTJMmodel*)GENmodPtr;
+    int k = tjm_index;
     double sinphi_2, cosphi_2;
     sincos(0.5*phi, sinphi_2, cosphi_2);
-    tjm_sinphi_2_old = sinphi_2;
-    tjm_cosphi_2_old = cosphi_2;
+    model->tjm_sinphi_2_old[k] = sinphi_2;
+    model->tjm_cosphi_2_old[k] = cosphi_2;
 
-    sTJMmodel *model = (sTJMmodel*)GENmodPtr;
-    int narray = model->tjm_narray;
     tjm_gcrit = model->tjm_alphaN * sqrt(TJMcap*TJMcriti/PHI0_2PI);
 
-    if (!tjm_Fc) {
-        tjm_Fc = new IFcomplex[7*narray];
-        tjm_Fs = tjm_Fc + narray;
-        tjm_Fcprev = tjm_Fs + narray;
-        tjm_Fsprev = tjm_Fcprev + narray;
-        tjm_alpha0 =  tjm_Fsprev + narray;
-        tjm_alpha1 = tjm_alpha0 + narray;
-        tjm_exp_z = tjm_alpha1 + narray;
-        memset(tjm_Fc, 0, 7*narray*sizeof(IFcomplex));
-    }
-
-    for (int i = 0; i < narray; i++) {
-        tjm_Fcprev[i] = cIFcomplex(cosphi_2, 0.0);
-        tjm_Fsprev[i] = cIFcomplex(sinphi_2, 0.0);
+    int n = model->tjm_ninst;
+    for (int i = 0; i < model->tjm_narray; i++) {
+        model->tjm_Fcprev_re[i*n + k] = cosphi_2;
+        model->tjm_Fcprev_im[i*n + k] = 0.0;
+        model->tjm_Fsprev_re[i*n + k] = sinphi_2;
+        model->tjm_Fsprev_im[i*n + k] = 0.0;
     }
 }
 
 
+// Compute the recursion coefficients for the present time step, called
+// from TJMdev::preLoad before the instances are loaded.  These
+// depend only on the model and time step, so are computed once here
+// rather than for each instance, and are not recomputed if the time
+// step is unchanged, which is usual in SFQ circuits.
+//
 void
-sTJMinstance::tjm_newstep(sCKT *ckt)
+sTJMmodel::tjm_newstep(double delta)
 {
-    sTJMmodel *model = (sTJMmodel*)GENmodPtr;
-    double kdt = model->tjm_kgap*model->TJMomegaJ*ckt->CKTdelta;
+    double kdt = tjm_kgap*TJMomegaJ*delta;
+    if (kdt == tjm_kdt)
+        return;
+    tjm_kdt = kdt;
 
-    for (int i = 0; i < model->tjm_narray; i++) {
-        IFcomplex z(model->tjm_P[i]*kdt);
+    for (int i = 0; i < tjm_narray; i++) {
+        IFcomplex z(tjm_P[i]*kdt);
         double d = exp(z.real);
         cIFcomplex ez(d*cos(z.imag), d*sin(z.imag));
         tjm_exp_z[i] = ez;
@@ -542,33 +621,111 @@ sTJMinstance::tjm_newstep(sCKT *ckt)
 }
 
 
+// Advance the recursion of the instances with tjm_index k0 through
+// k1-1, given the sine and cosine of phi/2 in tjm_sinphi_2 and
+// tjm_cosphi_2.  The pair and qp sums are left in tjm_FcSp, etc.
+// The loops over the instances are unit-stride with the coefficients
+// held in registers, so are vectorized when all instances are
+// updated together.  Instances with different indices can be updated
+// concurrently.
+//
+void
+sTJMmodel::tjm_recurse(int k0, int k1)
+{
+    const double *sinphi_2 = tjm_sinphi_2;
+    const double *cosphi_2 = tjm_cosphi_2;
+    const double *sinphi_2_old = tjm_sinphi_2_old;
+    const double *cosphi_2_old = tjm_cosphi_2_old;
+    double *FcSp = tjm_FcSp;
+    double *FcSq = tjm_FcSq;
+    double *FsSp = tjm_FsSp;
+    double *FsSq = tjm_FsSq;
+    for (int k = k0; k < k1; k++) {
+        FcSp[k] = 0.0;
+        FcSq[k] = 0.0;
+        FsSp[k] = 0.0;
+        FsSq[k] = 0.0;
+    }
+
+    int n = tjm_ninst;
+    for (int i = 0; i < tjm_narray; i++) {
+        double ez_r = tjm_exp_z[i].real;
+        double ez_i = tjm_exp_z[i].imag;
+        double a0_r = tjm_alpha0[i].real;
+        double a0_i = tjm_alpha0[i].imag;
+        double a1_r = tjm_alpha1[i].real;
+        double a1_i = tjm_alpha1[i].imag;
+        double A_r = tjm_A[i].real;
+        double A_i = tjm_A[i].imag;
+        double B_r = tjm_B[i].real;
+        double B_i = tjm_B[i].imag;
+
+        double *Fc_re = tjm_Fc_re + i*n;
+        double *Fc_im = tjm_Fc_im + i*n;
+        double *Fs_re = tjm_Fs_re + i*n;
+        double *Fs_im = tjm_Fs_im + i*n;
+        const double *Fcprev_re = tjm_Fcprev_re + i*n;
+        const double *Fcprev_im = tjm_Fcprev_im + i*n;
+        const double *Fsprev_re = tjm_Fsprev_re + i*n;
+        const double *Fsprev_im = tjm_Fsprev_im + i*n;
+
+        // The arrays don't overlap, but there are too many for the
+        // compiler to check this at run time.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+        for (int k = k0; k < k1; k++) {
+            // Fc = exp_z*Fcprev + alpha0*cosphi_2_old + alpha1*cosphi_2
+            double c_r = ez_r*Fcprev_re[k] - ez_i*Fcprev_im[k] +
+                a0_r*cosphi_2_old[k] + a1_r*cosphi_2[k];
+            double c_i = ez_r*Fcprev_im[k] + ez_i*Fcprev_re[k] +
+                a0_i*cosphi_2_old[k] + a1_i*cosphi_2[k];
+            // Fs = exp_z*Fsprev + alpha0*sinphi_2_old + alpha1*sinphi_2
+            double s_r = ez_r*Fsprev_re[k] - ez_i*Fsprev_im[k] +
+                a0_r*sinphi_2_old[k] + a1_r*sinphi_2[k];
+            double s_i = ez_r*Fsprev_im[k] + ez_i*Fsprev_re[k] +
+                a0_i*sinphi_2_old[k] + a1_i*sinphi_2[k];
+            Fc_re[k] = c_r;
+            Fc_im[k] = c_i;
+            Fs_re[k] = s_r;
+            Fs_im[k] = s_i;
+
+            // Keep the pair and qp terms separate so we can access
+            // them individually.
+            FcSp[k] += A_r*c_r - A_i*c_i;
+            FcSq[k] += B_r*c_r - B_i*c_i;
+            FsSp[k] += A_r*s_r - A_i*s_i;
+            FsSq[k] += B_r*s_r - B_i*s_i;
+        }
+    }
+}
+
+
+// Update the recursion of this instance alone, used when loading in
+// threads.
+//
 void
 sTJMinstance::tjm_update(double phi)
 {
-    double sinphi_2, cosphi_2;
-    sincos(0.5*phi, sinphi_2, cosphi_2);
+    sTJMmodel *model = (sTJMmodel*)GENmodPtr;
+    int k = tjm_index;
+    sincos(0.5*phi, model->tjm_sinphi_2[k], model->tjm_cosphi_2[k]);
+    model->tjm_recurse(k, k + 1);
+    tjm_currents();
+}
 
-    // Keep the pair and qp terms separate so we can access them
-    // individually.
 
-    double FcSp = 0.0;  // cosine for pairs
-    double FcSq = 0.0;  // cosine for qp
-    double FsSp = 0.0;  // sine for pairs
-    double FsSq = 0.0;  // sine for qp
+// Set the pair and qp currents from the sums left by
+// sTJMmodel::tjm_recurse.
+//
+void
+sTJMinstance::tjm_currents()
+{
     sTJMmodel *model = (sTJMmodel*)GENmodPtr;
-    for (int i = 0; i < model->tjm_narray; i++) {
-        tjm_Fc[i] = tjm_exp_z[i]*tjm_Fcprev[i] + 
-            tjm_alpha0[i]*tjm_cosphi_2_old + tjm_alpha1[i]*cosphi_2;
-        tjm_Fs[i] = tjm_exp_z[i]*tjm_Fsprev[i] +
-            tjm_alpha0[i]*tjm_sinphi_2_old + tjm_alpha1[i]*sinphi_2;
-
-        FcSp += (model->tjm_A[i]*tjm_Fc[i]).real;
-        FcSq += (model->tjm_B[i]*tjm_Fc[i]).real;
-        FsSp += (model->tjm_A[i]*tjm_Fs[i]).real;
-        FsSq += (model->tjm_B[i]*tjm_Fs[i]).real;
-    }
+    int k = tjm_index;
+    double sinphi_2 = model->tjm_sinphi_2[k];
+    double cosphi_2 = model->tjm_cosphi_2[k];
     double fct = TJMcriti * model->tjm_kgap_rejpt;
-    tjm_cp  = fct*(sinphi_2*FcSp + cosphi_2*FsSp);
-    tjm_cqp = fct*(sinphi_2*FcSq - cosphi_2*FsSq);
+    tjm_cp  = fct*(sinphi_2*model->tjm_FcSp[k] + cosphi_2*model->tjm_FsSp[k]);
+    tjm_cqp = fct*(sinphi_2*model->tjm_FcSq[k] - cosphi_2*model->tjm_FsSq[k]);
 }
-
@@ -518,7 +518,7 @@ TJMdev::setup(sGENmodel *genmod, sCKT *ckt, int *states)
 #endif
             }
 #endif
-            // Make sure that the arrays are built now.
+            // Initialize the recursion state.
             inst->tjm_init(0.0);
         }
     }
@@ -558,9 +558,15 @@ sTJMmodel::tjm_init()
         return (E_PANIC);
     }
     tjm_narray = cs->cfs_size;
-    tjm_A = new IFcomplex[3*tjm_narray];
+    delete [] tjm_A;
+    tjm_A = new IFcomplex[6*tjm_narray];
     tjm_B = tjm_A + tjm_narray;
     tjm_P = tjm_B + tjm_narray;
+    tjm_alpha0 = tjm_P + tjm_narray;
+    tjm_alpha1 = tjm_alpha0 + tjm_narray;
+    tjm_exp_z = tjm_alpha1 + tjm_narray;
+    memset(tjm_alpha0, 0, 3*tjm_narray*sizeof(IFcomplex));
+    tjm_kdt = 0.0;
     for (int i = 0; i < tjm_narray; i++) {
         tjm_A[i] = cs->cfs_A[i];
         tjm_B[i] = cs->cfs_B[i];
@@ -584,6 +590,33 @@ sTJMmodel::tjm_init()
         tjm_A[i] = (TJMicFactor*tjm_A[i]) / (-tjm_kgap*tjm_P[i]);
         tjm_B[i] = (tjm_B[i]) / (-tjm_kgap*tjm_P[i]);
     }
+
+    // Allocate the recursion state, and assign each instance a column.
+    tjm_ninst = 0;
+    for (sTJMinstance *inst = this->inst(); inst; inst = inst->next())
+        inst->tjm_index = tjm_ninst++;
+    int nf = tjm_narray*tjm_ninst;
+    delete [] tjm_Fc_re;
+    tjm_Fc_re = new double[8*nf + 8*tjm_ninst];
+    memset(tjm_Fc_re, 0, (8*nf + 8*tjm_ninst)*sizeof(double));
+    tjm_Fc_im = tjm_Fc_re + nf;
+    tjm_Fs_re = tjm_Fc_im + nf;
+    tjm_Fs_im = tjm_Fs_re + nf;
+    // The Fcprev, Fsprev arrays must follow in the same order, as
+    // these are copied as a block in TJMdev::accept.
+    tjm_Fcprev_re = tjm_Fs_im + nf;
+    tjm_Fcprev_im = tjm_Fcprev_re + nf;
+    tjm_Fsprev_re = tjm_Fcprev_im + nf;
+    tjm_Fsprev_im = tjm_Fsprev_re + nf;
+    tjm_sinphi_2_old = tjm_Fsprev_im + nf;
+    tjm_cosphi_2_old = tjm_sinphi_2_old + tjm_ninst;
+    tjm_sinphi_2 = tjm_cosphi_2_old + tjm_ninst;
+    tjm_cosphi_2 = tjm_sinphi_2 + tjm_ninst;
+    tjm_FcSp = tjm_cosphi_2 + tjm_ninst;
+    tjm_FcSq = tjm_FcSp + tjm_ninst;
+    tjm_FsSp = tjm_FcSq + tjm_ninst;
+    tjm_FsSq = tjm_FsSp + tjm_ninst;
+    tjm_batched = false;
     return (OK);
 }
 // End of sTJMmodel functions.
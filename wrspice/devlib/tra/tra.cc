@@ -112,6 +112,10 @@ IP("rel",               TRA_RELTOL,         IF_REAL,
                 "Not used"),
 IP("abs",               TRA_ABSTOL,         IF_REAL,
                 "Not used"),
+IO("exactconv",         TRA_EXACTCONV,      IF_FLAG,
+                "Use exact convolution"),
+IO("recconv",           TRA_RECCONV,        IF_FLAG,
+                "Use recursive (pole-residue) convolution"),
 IO("v1",                TRA_V1,             IF_REAL|IF_VOLT|IF_AC,
                 "Initial voltage at end 1"),
 IO("i1",                TRA_I1,             IF_REAL|IF_AMP|IF_AC,
@@ -206,7 +210,11 @@ IO("rel",               TRA_MOD_RELTOL,     IF_REAL,
 IO("abs",               TRA_MOD_ABSTOL,     IF_REAL,
                 "Abs. rate of change of deriv. for bkpt"),
 IP("ltra",              TRA_MOD_LTRA,       IF_FLAG,
-                "LTRA model")
+                "LTRA model"),
+IO("exactconv",         TRA_MOD_EXACTCONV,  IF_FLAG,
+                "Use exact convolution"),
+IO("recconv",           TRA_MOD_RECCONV,    IF_FLAG,
+                "Use recursive (pole-residue) convolution")
 };
 
 const char *TRAnames[] = {
@@ -318,6 +326,8 @@ TRAdev::delModl(sGENmodel **model, IFuid modname, sGENmodel *modfast)
 //  compactabs      real    compaction absltol
 //  rel             real    breakpoint reltol
 //  abs             real    breakpoint abstol
+//  exactconv       flag    level 2 convolution method (1 of 2)
+//  recconv         flag    level 2 convolution method (2 of 2)
 //
 void
 TRAdev::parse(int type, sCKT *ckt, sLine *current)
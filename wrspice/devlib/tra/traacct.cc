@@ -180,6 +180,8 @@ sTRAinstance::accept(sCKT *ckt)
     if (TRAlevel == CONV_LEVEL) {
         if (TRAcase == TRA_RG)
             return (OK);
+        if (TRAconvType == TRA_RECCONV)
+            ltra_rec_accept(ckt);
     }
     else {
         if (tv->prev)
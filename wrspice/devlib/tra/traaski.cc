@@ -87,6 +87,8 @@ TRAdev::askInst(const sCKT *ckt, const sGENinstance *geninst, int which,
         &&L_TRA_COMPACTABS,
         &&L_TRA_RELTOL,
         &&L_TRA_ABSTOL,
+        &&L_TRA_EXACTCONV,
+        &&L_TRA_RECCONV,
         &&L_TRA_V1,
         &&L_TRA_I1,
         &&L_TRA_V2,
@@ -203,6 +205,14 @@ TRAdev::askInst(const sCKT *ckt, const sGENinstance *geninst, int which,
     L_TRA_ABSTOL:
         data->v.rValue = inst->TRAabstol;
         return (OK);
+    L_TRA_EXACTCONV:
+        data->type = IF_FLAG;
+        data->v.iValue = (inst->TRAconvType == TRA_EXACTCONV);
+        return (OK);
+    L_TRA_RECCONV:
+        data->type = IF_FLAG;
+        data->v.iValue = (inst->TRAconvType == TRA_RECCONV);
+        return (OK);
     L_TRA_V1:
         data->v.rValue = inst->TRAinitVolt1;
         return (OK);
@@ -388,6 +398,14 @@ TRAdev::askInst(const sCKT *ckt, const sGENinstance *geninst, int which,
     case TRA_ABSTOL:
         data->v.rValue = inst->TRAabstol;
         break;
+    case TRA_EXACTCONV:
+        data->type = IF_FLAG;
+        data->v.iValue = (inst->TRAconvType == TRA_EXACTCONV);
+        break;
+    case TRA_RECCONV:
+        data->type = IF_FLAG;
+        data->v.iValue = (inst->TRAconvType == TRA_RECCONV);
+        break;
     case TRA_V1:
         data->v.rValue = inst->TRAinitVolt1;
         break;
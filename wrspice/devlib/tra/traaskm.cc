@@ -146,6 +146,14 @@ TRAdev::askModl(const sGENmodel *genmod, int which, IFdata *data)
     case TRA_MOD_ABSTOL:
         value->rValue = model->TRAabstol;
         break;
+    case TRA_MOD_EXACTCONV:
+        value->iValue = (model->TRAconvType == TRA_EXACTCONV);
+        data->type = IF_INTEGER;
+        break;
+    case TRA_MOD_RECCONV:
+        value->iValue = (model->TRAconvType == TRA_RECCONV);
+        data->type = IF_INTEGER;
+        break;
     default:
         return (E_BADPARM);
     }
@@ -76,6 +76,13 @@
 #define PADE_LEVEL 1
 #define CONV_LEVEL 2
 
+// Maximum number of poles used in recursive convolution.
+#define TRA_MAXPOLES 80
+
+// Number of recursive convolution terms per instance:  h1dash, h2,
+// and h3dash, each convolved with a quantity from both ports.
+#define TRA_NUMREC 6
+
 namespace TRA {
 
 struct TRAdev : public IFdevice
@@ -178,6 +185,7 @@ struct sTRAconvModelPOD
     double TRAg;             // conductance per length
     double TRAlength;        // length
     double TRAtd;            // delay
+    int TRAconvType;         // requested convolution method
 
     double TRAadmit;         // admittance Y - calculated
     double TRAalpha;         // alpha - calculated
@@ -198,6 +206,18 @@ struct sTRAconvModelPOD
 
     double TRAcallTime;      // time when coeffs were set up
     timelist<sTRAconval> *TRAcvdb; // lists of convolution coefficients
+
+    // Recursive convolution.  The step responses of h1dash, h2, and
+    // h3dash (the latter two shifted by the delay) are fitted with
+    //   K(t) = TRArecKinf + sum_k TRArecRes[k]*exp(-TRArecPole[k]*t)
+    // using a common set of poles.
+    int TRArecPoles;                    // number of poles, 0 if not fit
+    double TRArecFitErr;                // max relative fit error
+    double TRArecPole[TRA_MAXPOLES];    // poles
+    double TRArecRes[3][TRA_MAXPOLES];  // residues, per kernel
+    double TRArecKinf[3];               // step response final values
+    double TRArecExp[TRA_MAXPOLES];     // per step: exp(-p*h)
+    double TRArecCoef[3][TRA_MAXPOLES]; // per step: c*(1-exp(-p*h))/(p*h)
 };
 
 struct sTRAconvModel : sTRAconvModelPOD
@@ -214,6 +234,9 @@ struct sTRAconvModel : sTRAconvModelPOD
     void rlcCoeffsSetup(sCKT*);
     double rlcH2Func(double);
     double rlcH3dashFunc(double, double, double, double);
+    double stepResponse(int, int, double);
+    bool recFitSetup(sTRAinstance*, double);
+    void recCoeffsSetup(sCKT*);
     double lteCalculate(sCKT*, sTRAinstance*, double);
 
     sTRAconvModel *next;
@@ -267,8 +290,13 @@ struct sTRAinstancePOD
     int TRAhowToInterp; // back time interpolation method
     int TRAlteConType;  // timetoint truncation method
     int TRAbreakType;   // breakpoint rescheduling method
+    int TRAconvType;    // convolution method, exact or recursive
     int TRAdoload;      // internal flag
 
+    double *TRArecState;            // recursive convolution state
+    double TRArecPrev[TRA_NUMREC];  // convolved values at last time point
+    double TRArecCur[TRA_NUMREC];   // convolved values at current time
+
     double *TRAibr1Pos1Ptr;     // pointers to sparse matrix
     double *TRAibr1Neg1Ptr;
     double *TRAibr1Pos2Ptr;
@@ -308,13 +336,18 @@ struct sTRAinstancePOD
     unsigned TRAbreakGiven : 1;
     unsigned TRAreltolGiven : 1;
     unsigned TRAabstolGiven : 1;
+    unsigned TRAconvGiven : 1;
 };
 
 struct sTRAinstance : sGENinstance, sTRAinstancePOD
 {
     sTRAinstance() : sGENinstance(), sTRAinstancePOD()
         { GENnumNodes = 4; }
-    ~sTRAinstance() { delete TRAtvdb; }
+    ~sTRAinstance()
+        {
+            delete TRAtvdb;
+            delete [] TRArecState;
+        }
 
     sTRAinstance *next()
         { return (static_cast<sTRAinstance*>(GENnextInstance)); }
@@ -328,6 +361,8 @@ struct sTRAinstance : sGENinstance, sTRAinstancePOD
     int pade_pred(double, double, double, double*);
     int ltra_load(sCKT*);
     int ltra_pred(sCKT*, ltrastuff*);
+    int ltra_rec_pred(sCKT*, ltrastuff*);
+    void ltra_rec_accept(sCKT*);
 };
 
 struct sTRAmodelPOD
@@ -352,6 +387,7 @@ struct sTRAmodelPOD
     int TRAhowToInterp; // back time interpolation method
     int TRAlteConType;  // timetoint truncation method
     int TRAbreakType;   // breakpoint rescheduling method
+    int TRAconvType;    // convolution method, exact or recursive
 
     unsigned TRAlengthGiven : 1;
     unsigned TRAlGiven : 1;
@@ -373,6 +409,7 @@ struct sTRAmodelPOD
     unsigned TRAhowToInterpGiven : 1;
     unsigned TRAlteConTypeGiven : 1;
     unsigned TRAbreakTypeGiven : 1;
+    unsigned TRAconvTypeGiven : 1;
 
     sTRAconvModel *TRAconvModels;
 };
@@ -431,6 +468,8 @@ enum {
     TRA_COMPACTABS,
     TRA_RELTOL,
     TRA_ABSTOL,
+    TRA_EXACTCONV,
+    TRA_RECCONV,
     TRA_V1,
     TRA_I1,
     TRA_V2,
@@ -479,7 +518,9 @@ enum {
     TRA_MOD_COMPACTABS,
     TRA_MOD_RELTOL,
     TRA_MOD_ABSTOL,
-    TRA_MOD_LTRA
+    TRA_MOD_LTRA,
+    TRA_MOD_EXACTCONV,
+    TRA_MOD_RECCONV
 };
 
 #endif // TRADEFS_H
@@ -565,11 +565,16 @@ sTRAinstance::ltra_load(sCKT *ckt)
 
         if (TRAcase == TRA_LC || TRAcase == TRA_RLC) {
             if (TRAcase == TRA_RLC) {
-                // set up lists of values of the functions at the
-                // necessary timepoints. 
-                TRAconvModel->rlcCoeffsSetup(ckt);
+                if (TRAconvType == TRA_RECCONV)
+                    TRAconvModel->recCoeffsSetup(ckt);
+                else {
+                    // set up lists of values of the functions at the
+                    // necessary timepoints. 
+                    TRAconvModel->rlcCoeffsSetup(ckt);
 
-                TRAtvdb->free_tail(TRAconvModel->TRAcvdb->tail()->time);
+                    TRAtvdb->free_tail(
+                        TRAconvModel->TRAcvdb->tail()->time);
+                }
             }
 
             // setting up the coefficients for interpolation
@@ -604,11 +609,15 @@ sTRAinstance::ltra_load(sCKT *ckt)
                 ls.ls_over = 0;
         }
         else if (TRAcase == TRA_RC) {
-            // set up lists of values of the coefficients at the
-            // necessary timepoints. 
-            TRAconvModel->rcCoeffsSetup(ckt);
+            if (TRAconvType == TRA_RECCONV)
+                TRAconvModel->recCoeffsSetup(ckt);
+            else {
+                // set up lists of values of the coefficients at the
+                // necessary timepoints. 
+                TRAconvModel->rcCoeffsSetup(ckt);
 
-            TRAtvdb->free_tail(TRAconvModel->TRAcvdb->tail()->time);
+                TRAtvdb->free_tail(TRAconvModel->TRAcvdb->tail()->time);
+            }
         }
         else if (TRAcase != TRA_RG)
             return (E_BADPARM);
@@ -741,7 +750,11 @@ sTRAinstance::ltra_load(sCKT *ckt)
     if (ckt->CKTmode & (MODEINITPRED | MODEINITTRAN)) {
 
         // first iteration of each timepoint
-        int i = ltra_pred(ckt, &ls);
+        int i;
+        if (TRAconvType == TRA_RECCONV)
+            i = ltra_rec_pred(ckt, &ls);
+        else
+            i = ltra_pred(ckt, &ls);
         if (i)
             return (i);
     }
@@ -947,6 +960,103 @@ sTRAinstance::ltra_pred(sCKT *ckt, ltrastuff *ls)
 }
 
 
+// Recursive convolution counterpart of ltra_pred.
+//
+// The convolved quantities are indexed as
+//   0  v1 with h1dash      1  v2 with h1dash
+//   2  i2 with h2          3  i1 with h2
+//   4  v2 with h3dash      5  v1 with h3dash
+// and are relative to the initial values.  For the RLC line, the h2
+// and h3dash terms use the delayed values, which are known here.
+//
+int
+sTRAinstance::ltra_rec_pred(sCKT*, ltrastuff *ls)
+{
+    sTRAconvModel *model = TRAconvModel;
+    int np = model->TRArecPoles;
+    TRAinput1 = TRAinput2 = 0.0;
+
+    double v1d = 0.0, v2d = 0.0, i1d = 0.0, i2d = 0.0;
+    if (TRAcase == TRA_RLC) {
+        ls->ltra_interp(&v1d, &v2d, &i1d, &i2d);
+        if (ls->ls_over) {
+            TRArecCur[2] = i2d - TRAinitCur2;
+            TRArecCur[3] = i1d - TRAinitCur1;
+            TRArecCur[4] = v2d - TRAinitVolt2;
+            TRArecCur[5] = v1d - TRAinitVolt1;
+        }
+        else {
+            TRArecCur[2] = 0.0;
+            TRArecCur[3] = 0.0;
+            TRArecCur[4] = 0.0;
+            TRArecCur[5] = 0.0;
+        }
+    }
+    else if (TRAcase != TRA_RC)
+        return (E_BADPARM);
+
+    // The history part of each convolution.
+    double fc[3];
+    fc[0] = model->TRAh1dashFirstCoeff;
+    fc[1] = model->TRAh2FirstCoeff;
+    fc[2] = model->TRAh3dashFirstCoeff;
+    double hist[TRA_NUMREC];
+    for (int j = 0; j < TRA_NUMREC; j++) {
+        int m = j >> 1;
+        const double *x = TRArecState + j*np;
+        double sum = 0.0;
+        for (int k = 0; k < np; k++)
+            sum += model->TRArecExp[k]*x[k];
+        hist[j] = sum - TRArecPrev[j]*(fc[m] - model->TRArecKinf[m]);
+    }
+
+    if (TRAcase == TRA_RLC) {
+        // convolution of h1dash with v1 and v2, first terms are in
+        // the matrix
+        double dummy1 = hist[0] + TRAinitVolt1*(model->TRAintH1dash - fc[0]);
+        double dummy2 = hist[1] + TRAinitVolt2*(model->TRAintH1dash - fc[0]);
+        TRAinput1 -= dummy1*model->TRAadmit;
+        TRAinput2 -= dummy2*model->TRAadmit;
+
+        // convolution of h2 with i2 and i1
+        dummy1 = fc[1]*TRArecCur[2] + hist[2] + TRAinitCur2*model->TRAintH2;
+        dummy2 = fc[1]*TRArecCur[3] + hist[3] + TRAinitCur1*model->TRAintH2;
+        TRAinput1 += dummy1;
+        TRAinput2 += dummy2;
+
+        // convolution of h3dash with v2 and v1
+        dummy1 = fc[2]*TRArecCur[4] + hist[4] +
+            TRAinitVolt2*model->TRAintH3dash;
+        dummy2 = fc[2]*TRArecCur[5] + hist[5] +
+            TRAinitVolt1*model->TRAintH3dash;
+        TRAinput1 += model->TRAadmit*dummy1;
+        TRAinput2 += model->TRAadmit*dummy2;
+
+        // lossless-like parts
+        if (!ls->ls_over) {
+            TRAinput1 += model->TRAattenuation*
+                (TRAinitVolt2*model->TRAadmit + TRAinitCur2);
+            TRAinput2 += model->TRAattenuation*
+                (TRAinitVolt1*model->TRAadmit + TRAinitCur1);
+        }
+        else {
+            TRAinput1 += model->TRAattenuation*(v2d*model->TRAadmit + i2d);
+            TRAinput2 += model->TRAattenuation*(v1d*model->TRAadmit + i1d);
+        }
+    }
+    else {
+        // All first terms are in the matrix.
+        TRAinput1 -= hist[0] + TRAinitVolt1*(model->TRAintH1dash - fc[0]);
+        TRAinput2 -= hist[1] + TRAinitVolt2*(model->TRAintH1dash - fc[0]);
+        TRAinput1 += hist[2] + TRAinitCur2*(model->TRAintH2 - fc[1]);
+        TRAinput2 += hist[3] + TRAinitCur1*(model->TRAintH2 - fc[1]);
+        TRAinput1 += hist[4] + TRAinitVolt2*(model->TRAintH3dash - fc[2]);
+        TRAinput2 += hist[5] + TRAinitVolt1*(model->TRAintH3dash - fc[2]);
+    }
+    return (OK);
+}
+
+
 void
 ltrastuff::ltra_interp(double *v1, double *v2, double *i1, double *i2)
 {
@@ -69,6 +69,7 @@ namespace {
     double ltra_rlcH3dashIntFunc(double, double, double);
     double ltra_rcH1dashTwiceIntFunc(double, double);
     double ltra_rcH2TwiceIntFunc(double, double);
+    double ltra_rlcH2ShiftFunc(double, double, double, double);
 }
 
 
@@ -463,6 +464,65 @@ sTRAconvModel::rlcH3dashFunc(double time, double T, double alpha, double beta)
 }
 
 
+// Return the step response (the integral of the impulse response) of
+// kernel which (0: h1dash, 1: h2, 2: h3dash) at time t, for the line
+// case tcase.  For the RLC line, the h2 and h3dash responses are
+// shifted by the delay, i.e., t is measured from TRAtd.  This is used
+// when fitting the recursive convolution, which requires evaluation
+// over many decades of t, so scaled Bessel functions are used to
+// avoid overflow.
+//
+double
+sTRAconvModel::stepResponse(int which, int tcase, double t)
+{
+    if (tcase == TRA_RLC) {
+        if (t <= 0.0)
+            return (0.0);
+        if (which == 0) {
+            // result = e^{-beta*t}*I_0(beta*t) - 1
+            double x = TRAbeta*t;
+            return (bessZZ(x, -x) - 1.0);
+        }
+        if (which == 1) {
+            // There is no closed form, integrate h2 numerically. 
+            // The interval is divided geometrically toward zero, with
+            // Simpson's rule applied in each part.
+            //
+            const int nseg = 40;
+            const int nsimp = 8;
+            double sum = 0.0;
+            double hi = t;
+            for (int i = 0; i < nseg; i++) {
+                double lo = 0.5*hi;
+                double dx = (hi - lo)/nsimp;
+                double a = ltra_rlcH2ShiftFunc(lo, TRAtd, TRAalpha, TRAbeta) +
+                    ltra_rlcH2ShiftFunc(hi, TRAtd, TRAalpha, TRAbeta);
+                for (int j = 1; j < nsimp; j++) {
+                    a += ((j & 1) ? 4.0 : 2.0)*ltra_rlcH2ShiftFunc(lo + j*dx,
+                        TRAtd, TRAalpha, TRAbeta);
+                }
+                sum += a*dx/3.0;
+                hi = lo;
+            }
+            sum += hi*ltra_rlcH2ShiftFunc(0.0, TRAtd, TRAalpha, TRAbeta);
+            return (sum);
+        }
+        return (ltra_rlcH3dashIntFunc(t + TRAtd, TRAtd, TRAbeta));
+    }
+    if (tcase == TRA_RC) {
+        if (t <= 0.0)
+            return (which == 0 ? HUGE_VAL : 0.0);
+        double a = 0.25*TRArclsqr/t;
+        if (which == 0)
+            return (sqrt(TRAcByR/(M_PI*t)));
+        if (which == 1)
+            return (a >= 100.0 ? 0.0 : erfc(sqrt(a)));
+        return (a >= 700.0 ? 0.0 : sqrt(TRAcByR/(M_PI*t))*exp(-a));
+    }
+    return (0.0);
+}
+
+
 // i is the index of the latest value, 
 // a,b,c values correspond to values at t_{i-2}, t{i-1} and t_i
 //
@@ -1014,5 +1074,17 @@ namespace {
         }
         return (0.0);
     }
-}
 
+
+    // ltra_rlcH2ShiftFunc - h2 at time T + s, as in rlcH2Func but
+    // safe for large arguments
+    //
+    double
+    ltra_rlcH2ShiftFunc(double s, double T, double alpha, double beta)
+    {
+        if (alpha == 0.0 || s < 0.0)
+            return (0.0);
+        double besselarg = alpha*sqrt(s*(s + 2.0*T));
+        return (alpha*alpha*T*bessYY(besselarg, -beta*(s + T)));
+    }
+}
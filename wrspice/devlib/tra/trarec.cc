@@ -0,0 +1,377 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * WRspice Circuit Simulation and Analysis Tool:  Device Library          *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+//-------------------------------------------------------------------------
+// This is a general transmission line model derived from:
+//  1) the spice3 TRA (lossless) model
+//  2) the spice3 LTRA (lossy, convolution) model
+//  3) the kspice TXL (lossy, Pade approximation convolution) model
+// Authors:
+//  1985 Thomas L. Quarles
+//  1990 Jaijeet S. Roychowdhury
+//  1990 Shen Lin
+//  1992 Charles Hough
+//  2002 Stephen R. Whiteley
+// Copyright Regents of the University of California.  All rights reserved.
+//-------------------------------------------------------------------------
+#include "tradefs.h"
+
+
+//
+// Recursive convolution for the lossy (level 2) transmission line.
+//
+// The full convolution sums over the entire time history, so that the
+// cost of each time point grows with the simulated time.  Here, the
+// step response of each convolution kernel is fitted at setup by a
+// sum of decaying exponentials
+//
+//   K(t) = Kinf + sum_k c_k*exp(-p_k*t)
+//
+// For an input u(t) that is piecewise linear between time points,
+// which is the same assumption made in computing the full convolution
+// coefficients, each exponential term can be advanced from one time
+// point to the next exactly, using only the state at the previous
+// time point.  The cost and storage per time point are then constant.
+//
+
+namespace {
+    bool lsq_solve(double*, double*, int, int, double*);
+}
+
+
+// Fit the step responses of the convolution kernels, called once per
+// convolution model at setup.  The poles are fixed, spaced
+// logarithmically over the time range of interest, and the residues
+// are obtained by weighted linear least squares.  The fit is checked
+// against the exact step response at points between the fitting
+// points, and if the relative error exceeds tol the fit is rejected,
+// and false is returned.
+//
+bool
+sTRAconvModel::recFitSetup(sTRAinstance *inst, double tol)
+{
+    TRArecPoles = 0;
+    TRArecFitErr = 0.0;
+    int tcase = inst->TRAcase;
+
+    // Find the time range.  The kernels are negligible below tmin,
+    // and are very close to the final value above tmax.
+    double tmin, tmax, tpmin, ppd;
+    if (tcase == TRA_RLC) {
+        if (TRAbeta <= 0.0 || TRAtd <= 0.0)
+            return (false);
+        double tb = 1.0/TRAbeta;
+        double ta = tb*tb/TRAtd;
+        tmin = SPMIN(tb, TRAtd);
+        if (ta < tmin)
+            tmin = ta;
+        tmin *= 1e-3;
+        tmax = 1e5*SPMAX(tb, TRAtd);
+        tpmin = tmin;
+        ppd = 3.0;
+        TRArecKinf[0] = TRAintH1dash;
+        TRArecKinf[1] = TRAintH2;
+        TRArecKinf[2] = TRAintH3dash;
+    }
+    else if (tcase == TRA_RC) {
+        if (TRArclsqr <= 0.0)
+            return (false);
+        tmin = 1e-4*TRArclsqr;
+        tmax = 1e6*TRArclsqr;
+        // The h1dash kernel is singular at t = 0, extend the poles
+        // below the fitting range to follow it.
+        tpmin = 1e-2*tmin;
+        ppd = 6.0;
+        TRArecKinf[0] = TRAintH1dash;
+        TRArecKinf[1] = TRAintH2;
+        TRArecKinf[2] = TRAintH3dash;
+    }
+    else
+        return (false);
+
+    // Poles spaced evenly per decade, spanning the range.  The RC
+    // kernels have a sharper onset and need a denser spacing.
+    double ldecs = log10(tmax/tpmin);
+    int np = (int)(ppd*ldecs) + 1;
+    if (np > TRA_MAXPOLES)
+        np = TRA_MAXPOLES;
+    double lpmin = log(tpmin);
+    double lstep = log(tmax/tpmin)/(np - 1);
+    for (int k = 0; k < np; k++)
+        TRArecPole[k] = exp(-(lpmin + k*lstep));
+    double lmin = log(tmin);
+
+    // Fitting points, four per pole, and check points halfway
+    // between (log scale).  The first row is for t = 0, where the
+    // step response is finite.
+    int nsamp = 4*np + 1;
+    int nrows = nsamp + 1 + np;
+    double *tp = new double[nsamp];
+    double *tc = new double[nsamp];
+    double sstep = log(tmax/tmin)/(nsamp - 1);
+    for (int j = 0; j < nsamp; j++) {
+        tp[j] = exp(lmin + j*sstep);
+        tc[j] = exp(lmin + (j + 0.5)*sstep);
+    }
+    double *A = new double[nrows*np];
+    double *b = new double[nrows];
+    double *y = new double[nsamp];
+
+    bool ok = true;
+    double maxerr = 0.0;
+    for (int m = 0; m < 3 && ok; m++) {
+        double kinf = TRArecKinf[m];
+        double ymax = 0.0;
+        for (int j = 0; j < nsamp; j++) {
+            y[j] = stepResponse(m, tcase, tp[j]) - kinf;
+            if (fabs(y[j]) > ymax)
+                ymax = fabs(y[j]);
+        }
+        if (ymax == 0.0) {
+            // Kernel is identically zero.
+            for (int k = 0; k < np; k++)
+                TRArecRes[m][k] = 0.0;
+            continue;
+        }
+        bool has_zero = !(tcase == TRA_RC && m == 0);
+        double wfloor = 1e-3*ymax;
+
+        int r = 0;
+        if (has_zero) {
+            // Step response at t = 0, heavily weighted.
+            double w = 10.0/ymax;
+            for (int k = 0; k < np; k++)
+                A[k] = w;
+            b[0] = w*(stepResponse(m, tcase, 0.0) - kinf);
+            r++;
+        }
+        for (int j = 0; j < nsamp; j++, r++) {
+            // Relative error weighting.
+            double w = 1.0/(fabs(y[j]) + wfloor);
+            double *a = A + r*np;
+            for (int k = 0; k < np; k++)
+                a[k] = w*exp(-TRArecPole[k]*tp[j]);
+            b[r] = w*y[j];
+        }
+        // Small regularization, keeps the residues from growing large
+        // with alternating signs.
+        for (int i = 0; i < np; i++, r++) {
+            double *a = A + r*np;
+            for (int k = 0; k < np; k++)
+                a[k] = (k == i) ? 1e-6/ymax : 0.0;
+            b[r] = 0.0;
+        }
+        if (!lsq_solve(A, b, r, np, TRArecRes[m])) {
+            ok = false;
+            break;
+        }
+
+        // Check against the exact step response.
+        for (int j = 0; j < nsamp - 1; j++) {
+            double t = tc[j];
+            double f = 0.0;
+            for (int k = 0; k < np; k++)
+                f += TRArecRes[m][k]*exp(-TRArecPole[k]*t);
+            double e = fabs(f - (stepResponse(m, tcase, t) - kinf))/ymax;
+            if (e > maxerr)
+                maxerr = e;
+        }
+    }
+    delete [] tp;
+    delete [] tc;
+    delete [] A;
+    delete [] b;
+    delete [] y;
+
+    TRArecFitErr = maxerr;
+    if (!ok || maxerr > tol)
+        return (false);
+    TRArecPoles = np;
+    return (true);
+}
+
+
+// Compute the coefficients for the present time step.  These are the
+// same for all instances that use this model.  The "first
+// coefficients" are set as for the full convolution, since these are
+// used in the matrix loading.
+//
+void
+sTRAconvModel::recCoeffsSetup(sCKT *ckt)
+{
+    if (ckt->CKTtime == TRAcallTime)
+        return;  // Already set up for this time point.
+    TRAcallTime = ckt->CKTtime;
+
+    // Only the last accepted time point is needed.
+    sTRAconval *cv = TRAcvdb->head();
+    TRAcvdb->free_tail(cv->time);
+    double h = ckt->CKTtime - cv->time;
+
+    double fc[3];
+    fc[0] = TRArecKinf[0];
+    fc[1] = TRArecKinf[1];
+    fc[2] = TRArecKinf[2];
+    for (int k = 0; k < TRArecPoles; k++) {
+        double ph = TRArecPole[k]*h;
+        TRArecExp[k] = exp(-ph);
+        double e = (ph < 1e-8) ? 1.0 - 0.5*ph : -expm1(-ph)/ph;
+        for (int m = 0; m < 3; m++) {
+            double c = TRArecRes[m][k]*e;
+            TRArecCoef[m][k] = c;
+            fc[m] += c;
+        }
+    }
+    TRAh1dashFirstCoeff = fc[0];
+    TRAh2FirstCoeff = fc[1];
+    TRAh3dashFirstCoeff = fc[2];
+}
+
+
+// Advance the recursive convolution state to the accepted time point. 
+// Call after the present values have been added to the history list.
+//
+void
+sTRAinstance::ltra_rec_accept(sCKT *ckt)
+{
+    sTRAconvModel *model = TRAconvModel;
+    int np = model->TRArecPoles;
+    if (ckt->CKTmode & MODEINITTRAN) {
+        // Time zero, the convolved quantities are zero by definition.
+        if (!TRArecState)
+            TRArecState = new double[TRA_NUMREC*np];
+        memset(TRArecState, 0, TRA_NUMREC*np*sizeof(double));
+        for (int j = 0; j < TRA_NUMREC; j++) {
+            TRArecPrev[j] = 0.0;
+            TRArecCur[j] = 0.0;
+        }
+        return;
+    }
+
+    sTRAtimeval *tv = TRAtvdb->head();
+    TRArecCur[0] = tv->v_i - TRAinitVolt1;
+    TRArecCur[1] = tv->v_o - TRAinitVolt2;
+    if (TRAcase == TRA_RC) {
+        TRArecCur[2] = tv->i_o - TRAinitCur2;
+        TRArecCur[3] = tv->i_i - TRAinitCur1;
+        TRArecCur[4] = TRArecCur[1];
+        TRArecCur[5] = TRArecCur[0];
+    }
+    for (int j = 0; j < TRA_NUMREC; j++) {
+        int m = j >> 1;
+        double *x = TRArecState + j*np;
+        double du = TRArecCur[j] - TRArecPrev[j];
+        for (int k = 0; k < np; k++)
+            x[k] = model->TRArecExp[k]*x[k] + model->TRArecCoef[m][k]*du;
+        TRArecPrev[j] = TRArecCur[j];
+    }
+
+    // The history list is needed only for the delayed values, and
+    // for the truncation error and breakpoint estimation.  Keep two
+    // points before t - td for interpolation.
+    double tt = ckt->CKTtime - TRAtd;
+    for ( ; tv; tv = tv->prev) {
+        if (tv->time < tt)
+            break;
+    }
+    if (tv && tv->prev) {
+        tv = tv->prev;
+        if (tv->prev)
+            TRAtvdb->free_tail(tv->prev->time);
+    }
+}
+
+
+namespace {
+    // Solve the overdetermined system A*x = b in the least-squares
+    // sense, by Householder QR factorization.  A is m x n, row-major,
+    // m >= n, and is overwritten, as is b.
+    //
+    bool
+    lsq_solve(double *A, double *b, int m, int n, double *x)
+    {
+        for (int k = 0; k < n; k++) {
+            double nrm = 0.0;
+            for (int i = k; i < m; i++)
+                nrm += A[i*n + k]*A[i*n + k];
+            nrm = sqrt(nrm);
+            if (nrm == 0.0)
+                return (false);
+            double akk = A[k*n + k];
+            double alpha = (akk > 0.0) ? -nrm : nrm;
+
+            // Householder vector v = a_k - alpha*e_k, stored in place.
+            A[k*n + k] = akk - alpha;
+            double vtv = 0.0;
+            for (int i = k; i < m; i++)
+                vtv += A[i*n + k]*A[i*n + k];
+            if (vtv == 0.0)
+                return (false);
+
+            for (int j = k + 1; j < n; j++) {
+                double s = 0.0;
+                for (int i = k; i < m; i++)
+                    s += A[i*n + k]*A[i*n + j];
+                s = 2.0*s/vtv;
+                for (int i = k; i < m; i++)
+                    A[i*n + j] -= s*A[i*n + k];
+            }
+            double s = 0.0;
+            for (int i = k; i < m; i++)
+                s += A[i*n + k]*b[i];
+            s = 2.0*s/vtv;
+            for (int i = k; i < m; i++)
+                b[i] -= s*A[i*n + k];
+
+            // Diagonal of R.
+            A[k*n + k] = alpha;
+        }
+
+        // Back substitution.
+        for (int k = n - 1; k >= 0; k--) {
+            double s = b[k];
+            for (int j = k + 1; j < n; j++)
+                s -= A[k*n + j]*x[j];
+            x[k] = s/A[k*n + k];
+        }
+        return (true);
+    }
+}
+
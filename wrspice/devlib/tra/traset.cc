@@ -138,6 +138,8 @@ TRAdev::setup(sGENmodel *genmod, sCKT *ckt, int *state)
                 inst->TRAreltol = model->TRAreltol;
             if (!inst->TRAabstolGiven)
                 inst->TRAabstol = model->TRAabstol;
+            if (!inst->TRAconvGiven)
+                inst->TRAconvType = model->TRAconvType;
 
             const char *s = inst->tranline_params();
             if (s) {
@@ -221,6 +223,8 @@ TRAdev::setup(sGENmodel *genmod, sCKT *ckt, int *state)
                     (inst->TRAbreakType != TRA_ALLBREAKS) &&
                     (inst->TRAbreakType != TRA_TESTBREAKS))
                 inst->TRAbreakType = TRA_TESTBREAKS;
+            if (inst->TRAconvType != TRA_RECCONV)
+                inst->TRAconvType = TRA_EXACTCONV;
 
 #ifdef NEWJJDC
             if (ckt->CKTjjDCphase && inst->TRAr == 0.0) {
@@ -920,7 +924,8 @@ sTRAinstance::ltra_setup(sCKT *ckt)
     for (sTRAconvModel *cm = ((sTRAmodel*)GENmodPtr)->TRAconvModels; cm;
             cm = cm->next) {
         if (cm->TRAl == TRAl && cm->TRAc == TRAc && cm->TRAr == TRAr &&
-                cm->TRAg == TRAg && cm->TRAlength == TRAlength) {
+                cm->TRAg == TRAg && cm->TRAlength == TRAlength &&
+                cm->TRAconvType == TRAconvType) {
             TRAconvModel = cm;
             break;
         }
@@ -933,6 +938,11 @@ sTRAinstance::ltra_setup(sCKT *ckt)
         TRAconvModel->next = ((sTRAmodel*)GENmodPtr)->TRAconvModels;
         ((sTRAmodel*)GENmodPtr)->TRAconvModels = TRAconvModel;
     }
+    if (TRAconvType == TRA_RECCONV && TRAconvModel->TRArecPoles == 0) {
+        // Recursive convolution not available, fit failed or not
+        // needed (LC and RG lines).
+        TRAconvType = TRA_EXACTCONV;
+    }
 
     if (TRAcase == TRA_RLC && TRAlteConType != TRA_TRUNCDONTCUT) {
 
@@ -996,7 +1006,7 @@ sTRAinstance::ltra_setup(sCKT *ckt)
 
 
 int
-sTRAconvModel::setup(sCKT*, sTRAinstance *inst)
+sTRAconvModel::setup(sCKT *ckt, sTRAinstance *inst)
 {
     TRAl = inst->TRAl;
     TRAc = inst->TRAc;
@@ -1004,6 +1014,7 @@ sTRAconvModel::setup(sCKT*, sTRAinstance *inst)
     TRAg = inst->TRAg;
     TRAlength = inst->TRAlength;
     TRAtd = inst->TRAtd;
+    TRAconvType = inst->TRAconvType;
 
     if (inst->TRAcase == TRA_LC) {
         TRAadmit = 1.0/inst->TRAz;
@@ -1056,6 +1067,21 @@ sTRAconvModel::setup(sCKT*, sTRAinstance *inst)
     }
     else
         return (E_BADPARM);
+
+    if (TRAconvType == TRA_RECCONV &&
+            (inst->TRAcase == TRA_RLC || inst->TRAcase == TRA_RC)) {
+        // Fit the kernels for recursive convolution, this is done
+        // once here and the result is shared by all instances with
+        // the same line parameters.
+
+        double tol = ckt->CKTcurTask->TSKreltol;
+        if (!recFitSetup(inst, tol)) {
+            DVO.textOut(OUT_WARNING,
+                "%s: recursive convolution fit error %g exceeds %g,\n"
+                "using exact convolution.",
+                inst->GENname, TRArecFitErr, tol);
+        }
+    }
     return (OK);
 }
 
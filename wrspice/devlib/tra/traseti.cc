@@ -86,6 +86,8 @@ TRAdev::setInst(int param, IFdata *data, sGENinstance *geninst)
         &&L_TRA_COMPACTABS,
         &&L_TRA_RELTOL,
         &&L_TRA_ABSTOL,
+        &&L_TRA_EXACTCONV,
+        &&L_TRA_RECCONV,
         &&L_TRA_V1,
         &&L_TRA_I1,
         &&L_TRA_V2,
@@ -214,6 +216,14 @@ TRAdev::setInst(int param, IFdata *data, sGENinstance *geninst)
         inst->TRAabstol = value->rValue;
         inst->TRAabstolGiven = true;
         return (OK);
+    L_TRA_EXACTCONV:
+        inst->TRAconvType = TRA_EXACTCONV;
+        inst->TRAconvGiven = true;
+        return (OK);
+    L_TRA_RECCONV:
+        inst->TRAconvType = TRA_RECCONV;
+        inst->TRAconvGiven = true;
+        return (OK);
     L_TRA_V1:
         inst->TRAinitVolt1 = value->rValue;
         return (OK);
@@ -344,6 +354,14 @@ TRAdev::setInst(int param, IFdata *data, sGENinstance *geninst)
         inst->TRAabstol = value->rValue;
         inst->TRAabstolGiven = true;
         break;
+    case TRA_EXACTCONV:
+        inst->TRAconvType = TRA_EXACTCONV;
+        inst->TRAconvGiven = true;
+        break;
+    case TRA_RECCONV:
+        inst->TRAconvType = TRA_RECCONV;
+        inst->TRAconvGiven = true;
+        break;
     case TRA_V1:
         inst->TRAinitVolt1 = value->rValue;
         break;
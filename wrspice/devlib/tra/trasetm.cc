@@ -164,6 +164,14 @@ TRAdev::setModl(int param, IFdata *data, sGENmodel *genmod)
         model->TRAlevel = CONV_LEVEL;
         model->TRAlevelGiven = true;
         break;
+    case TRA_MOD_EXACTCONV:
+        model->TRAconvType = TRA_EXACTCONV;
+        model->TRAconvTypeGiven = true;
+        break;
+    case TRA_MOD_RECCONV:
+        model->TRAconvType = TRA_RECCONV;
+        model->TRAconvTypeGiven = true;
+        break;
     default:
         return (E_BADPARM);
     }
@@ -76,6 +76,7 @@ struct sJobc
                 pr_pid = p;
                 pr_saveout = false;
                 pr_tempinp = false;
+                pr_pooled = false;
             }
 
         ~proc_t()
@@ -96,6 +97,8 @@ struct sJobc
         void set_tempinp(bool b)        { pr_tempinp = b; }
         bool saveout()                  { return (pr_saveout); }
         void set_saveout(bool b)        { pr_saveout = b; }
+        bool pooled()                   { return (pr_pooled); }
+        void set_pooled(bool b)         { pr_pooled = b; }
         proc_t *next()                  { return (pr_next); }
         void set_next(proc_t *p)        { pr_next = p; }
         int pid()                       { return (pr_pid); }
@@ -110,6 +113,7 @@ struct sJobc
         int pr_pid;             // The pid of the spice job.
         bool pr_saveout;        // Don't unlink the output file.
         bool pr_tempinp;        // Unlink input file.
+        bool pr_pooled;         // Run by a pool worker, pid is a job id.
     };
 
     // Struct to hold info on remote servers.
@@ -206,12 +210,89 @@ struct sJobc
         sdone_t *next;
     };
 
+#ifndef WIN32
+    // A persistent local worker process.  Workers are forked from
+    // this process so that the loaded device modules, libraries, and
+    // option settings are inherited, and are reused for any number of
+    // jobs.  Jobs are passed over a Unix socket pair.
+    //
+    struct pwork_t
+    {
+        pwork_t(int p, int f, pwork_t *n)
+            {
+                pw_next = n;
+                pw_pid = p;
+                pw_fd = f;
+                pw_jobid = 0;
+            }
+
+        pwork_t *next()                 { return (pw_next); }
+        void set_next(pwork_t *n)       { pw_next = n; }
+        int pid()                       { return (pw_pid); }
+        int fd()                        { return (pw_fd); }
+        void set_fd(int f)              { pw_fd = f; }
+        int jobid()                     { return (pw_jobid); }
+        void set_jobid(int i)           { pw_jobid = i; }
+
+    private:
+        pwork_t *pw_next;
+        int pw_pid;             // Worker process id.
+        int pw_fd;              // Our end of the socket pair, -1 if dead.
+        int pw_jobid;           // Job in progress, 0 if idle.
+    };
+
+    // A job waiting for a free pool worker.  The queue is kept in
+    // descending priority order, first-come first-served within a
+    // priority level.
+    //
+    struct pjob_t
+    {
+        pjob_t(int i, int p, const char *d, const char *r, const char *o)
+            {
+                pj_next = 0;
+                pj_deck = lstring::copy(d);
+                pj_raw = lstring::copy(r);
+                pj_out = lstring::copy(o);
+                pj_id = i;
+                pj_priority = p;
+            }
+
+        ~pjob_t()
+            {
+                delete [] pj_deck;
+                delete [] pj_raw;
+                delete [] pj_out;
+            }
+
+        pjob_t *next()                  { return (pj_next); }
+        void set_next(pjob_t *n)        { pj_next = n; }
+        const char *deck()              { return (pj_deck); }
+        const char *raw()               { return (pj_raw); }
+        const char *out()               { return (pj_out); }
+        int id()                        { return (pj_id); }
+        int priority()                  { return (pj_priority); }
+
+    private:
+        pjob_t *pj_next;
+        char *pj_deck;          // Input file.
+        char *pj_raw;           // Rawfile to create.
+        char *pj_out;           // Standard output/error file.
+        int pj_id;              // Job id, negative.
+        int pj_priority;        // Larger values run first.
+    };
+#endif
+
     sJobc()
         {
             jc_jobs = 0;
             jc_servers = 0;
             jc_complete_list = 0;
             jc_numchanged = 0;
+#ifndef WIN32
+            jc_pool = 0;
+            jc_pool_queue = 0;
+            jc_pool_lastid = 0;
+#endif
         }
 
     void rhost(wordlist*);
@@ -222,7 +303,7 @@ struct sJobc
     bool submit(const char*, const char*, const char*, const char*,
         sFtCirc*, rjob_t*);
     bool submit_local(const char*, const char*, const char*, sFtCirc*,
-        rjob_t*, const char*);
+        rjob_t*, const char*, int = 0);
     const char *gethost();
 
 private:
@@ -244,12 +325,24 @@ private:
     static void th_local_hdlr(void*);
 #else
     static void sigchild(int, int, void*);
+
+    int pool_size();
+    bool pool_submit(const char*, const char*, const char*, int, int*);
+    void pool_dispatch();
+    void pool_check();
+    static void pool_worker(int);
+    static void pool_sigchild(int, int, void*);
 #endif
 
     rjob_t *jc_jobs;
     rserv_t *jc_servers;
     sdone_t *jc_complete_list;
     int jc_numchanged;  // How many children have changed in state.
+#ifndef WIN32
+    pwork_t *jc_pool;   // Persistent local workers.
+    pjob_t *jc_pool_queue;  // Jobs waiting for a worker.
+    int jc_pool_lastid; // Last pooled job id assigned.
+#endif
 };
 
 
@@ -57,6 +57,7 @@ Authors: 1985 Thomas L. Quarles
 #define WITH_ATOMIC
 #define THREAD_SAFE_EVAL
 
+#include <stdio.h>
 #include <math.h>
 #include "ifdata.h"
 #ifdef WITH_THREADS
@@ -82,6 +83,7 @@ struct VerilogBlock;
 struct sJOB;
 struct sTASK;
 struct sCKT;
+struct sPerfStats;
 struct sFtCirc;
 struct sHtab;
 struct IFmacro;
@@ -1106,8 +1108,11 @@ struct sSTATS
             STATpageFaults = 0;
             STATvolCxSwitch = 0;
             STATinvolCxSwitch = 0;
+            STATperf = 0;
         }
 
+    ~sSTATS();
+
     double STATtotAnalTime; // total time for analysis
     double STATtranTime;    // transient analysis time
     double STATloadTime;    // time spent in device loading
@@ -1140,6 +1145,90 @@ struct sSTATS
     int STATpageFaults;     // page faults during analysis
     int STATvolCxSwitch;    // voluntary context switches during analysis
     int STATinvolCxSwitch;  // involuntary context switches during analysis
+
+    sPerfStats *STATperf;   // detailed profile, when "profile" is set
+};
+
+
+// Load time accumulated per device model, for the profile.
+//
+struct sPerfModel
+{
+    const sGENmodel *pm_model;  // model, identity only
+    char *pm_name;              // copy of model name
+    int pm_type;                // device type index
+    int pm_loads;               // number of load passes
+    unsigned long pm_calls;     // number of instance load calls
+    unsigned long long pm_ns;   // total load time, nanoseconds
+};
+
+// One solved transient time point, for the profile.
+//
+struct sPerfStep
+{
+    unsigned long long ps_start;    // wall time offset, nanoseconds
+    unsigned long long ps_dur;      // duration of iteration, nanoseconds
+    double ps_time;                 // circuit time
+    double ps_delta;                // time step
+    int ps_iters;                   // Newton iterations
+    int ps_status;                  // PS_xxx below
+};
+
+#define PS_CONVERGED    0x1
+#define PS_ACCEPTED     0x2
+
+// Maximum number of time points saved in the step trace.
+#define PF_MAXSTEPS     200000
+
+// Detailed performance data, collected only when the "profile"
+// variable is set when an analysis starts.  The timing uses the
+// monotonic clock, and all times are saved in nanoseconds.
+//
+// The per-model load times are collected in the single-threaded
+// loader.  When loading is done with helper threads, the busy time
+// of each thread is recorded instead, since per-instance timing
+// would require locking.
+//
+struct sPerfStats
+{
+    sPerfStats();
+    ~sPerfStats();
+
+    static unsigned long long ticks();
+
+    void reset();
+    sPerfModel *find_model(const sGENmodel*);
+    void set_threads(int);
+    void add_step(double, double, int, bool, unsigned long long);
+    void accept_step();
+    void print_json(FILE*, const sSTATS*) const;
+
+    void add_thread_ns(int t, unsigned long long ns)
+        {
+            if (t >= 0 && t < pf_numthreads)
+                pf_thread_ns[t] += ns;
+        }
+
+    unsigned long long pf_start;    // wall clock at reset
+    unsigned long long pf_wall;     // wall time to end of run
+    sPerfModel *pf_models;          // model load records
+    int pf_nummodels;
+    int pf_modsize;
+    int pf_modcur;                  // next expected model record
+    int pf_numthreads;              // threads including the main thread
+    unsigned long long *pf_thread_ns;   // per-thread busy time
+    unsigned long long pf_load_ns;      // total load wall time
+    unsigned long pf_loads;             // number of load calls
+    sPerfStep *pf_steps;            // transient step trace
+    int pf_numsteps;
+    int pf_stepsize;
+    int pf_reorders;                // matrix reorder count
+    int pf_factors;                 // numerical factorizations
+    int pf_solves;                  // forward/back substitutions
+    int pf_singular;                // factorizations found singular
+    unsigned long long pf_reorder_ns;
+    unsigned long long pf_factor_ns;
+    unsigned long long pf_solve_ns;
 };
 
 
@@ -1240,38 +1329,70 @@ private:
     unsigned int        ix;
 };
 
+// Interface for objects that generate breakpoints on demand.  Rather
+// than entering all of its breakpoints in the table, a source (such
+// as a PWL function) registers one of these, and only its next
+// breakpoint is kept queued.  The lattice takes ownership.
+//
+struct sCKTbreakSource
+{
+    virtual ~sCKTbreakSource() { }
+
+    // Return the first breakpoint later than t, or a negative value
+    // if there are no more.
+    virtual double next_break(double t) = 0;
+};
+
 // Breakpoint control.
 //
+// Breakpoints are kept in a binary min-heap.  An entry is either a
+// single breakpoint, or the next breakpoint of a periodic lattice or
+// a sCKTbreakSource, which is replaced by the following breakpoint of
+// the source when it is passed.  Thus each source has only one entry,
+// and the cost per time step is logarithmic in the number of
+// entries.  Breakpoints closer than the minimum break are merged.
+//
 struct sCKTlattice
 {
+    // Periodic or generated breakpoint source.
     struct lattice
     {
         double offs;
         double per;
+        sCKTbreakSource *gen;   // if nonzero, offs/per are unused
+
+        double next(double) const;
+    };
+
+    // Heap entry, src is the lattice index, or -1 for a single
+    // breakpoint.
+    struct brkent
+    {
+        double time;
+        int src;
     };
 
     sCKTlattice()
         {
             lattices = 0;
-            breaks = 0;
+            heap = 0;
+            hashtab = 0;
             numLattices = 0;
+            lattSize = 0;
             numBreaks = 0;
+            heapSize = 0;
+            hashMask = 0;
+            brkSet = false;
         }
 
     ~sCKTlattice()
         {
-            delete [] lattices;
-            delete [] breaks;
+            clear();
         }
 
     void init()
         {
-            delete [] lattices;
-            delete [] breaks;
-            lattices = 0;
-            breaks = 0;
-            numLattices = 0;
-            numBreaks = 0;
+            clear();
         }
 
     int numbreaks() { return (numBreaks); }
@@ -1279,13 +1400,28 @@ struct sCKTlattice
     void clear_break(double, double, double*);
     bool set_break(double, double, double, double*);
     void set_lattice(double, double);
+    void set_source(sCKTbreakSource*, double, double, double*);
     double nextbreak(double, double);
 
 private:
+    void clear();
+    int add_lattice(double, double, sCKTbreakSource*);
+    void push(double, int);
+    void pop();
+    void sift_down(int);
+    void sift_up(int);
+    void purge(double);
+    void collapse(double, double);
+
     lattice *lattices;
-    double *breaks;
+    brkent *heap;
+    int *hashtab;           // lattice hash, for duplicate removal
     int numLattices;
+    int lattSize;
     int numBreaks;
+    int heapSize;
+    unsigned int hashMask;
+    bool brkSet;            // a single breakpoint has been added
 };
 
 
@@ -1646,6 +1782,7 @@ struct sCKT : sCKTPOD
     int breakInit();
     int breakSet(double);
     int breakSetLattice(double, double);
+    int breakSetSource(sCKTbreakSource*);
     void clrTable();
     int convTest();
     int delInst(sGENmodel*, IFuid, sGENinstance*);
@@ -242,7 +242,8 @@ struct CshPar
     void TopLevel();                        // Go to top context level
     void SetAltPrompt();                    // Set prompt for contest level
     wordlist *GetCommand(const char*);      // Get a command
-    void DoCommand(wordlist*);              // Process a command
+    void DoCommand(wordlist*, bool = false); // Process a command
+    bool IsPlain(const wordlist*);          // Text needs no substitution
     void Reset(bool);                       // Reset after interrupt
 
     // glob.cc
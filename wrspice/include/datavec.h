@@ -136,6 +136,9 @@ struct sPoly
         }
 
     bool interp(double*, double*, double*, int, double*, int);
+    bool interp_vecs(double**, double**, int, double*, int, double*, int);
+    void interp_range(const double*, double*, const double*, int,
+        const double*, int, int) const;
     bool polyfit(double*, double*, double*);
     double peval(double, double*, int = 0);
 
@@ -395,7 +398,7 @@ struct sPlot
 
     // linear.cc
     void linearize(wordlist*);
-    void lincopy(sDataVec*, double*, int, sPlot*);
+    sDataVec *lincopy(sDataVec*, int, sPlot*);
 
     // postcoms.cc
     sDvList *write(sDvList*, bool, const char*);
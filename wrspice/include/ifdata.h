@@ -560,6 +560,7 @@ enum DEV_BKMODE { DEV_CLEAR, DEV_SAVE, DEV_RESTORE };
 #define DV_NONOIS   0x200   // no NOISE analysis with this device
 #define DV_NOPZ     0x400   // no PZ analysis with this device
 #define DV_NODIST   0x800   // no DISTO analysis with this device
+#define DV_PARTEMP  0x1000  // temperature function is thread-safe
 
 // structure:  IFdevice
 //
@@ -818,6 +819,13 @@ struct IFdevice
     // devices in the model.
     virtual int load(sGENinstance*, sCKT*)              { return (OK); };
 
+    // preLoad();      Per-model work done ahead of load().
+    // This is called once per load from the main thread, with the
+    // model list, before any instances are loaded.  Model data that
+    // load() would otherwise update must be set here, as load() may
+    // be running in several threads.
+    virtual int preLoad(sGENmodel*, sCKT*)              { return (OK); };
+
     // setup();        Initialize devices before soloution begins.
     virtual int setup(sGENmodel*, sCKT*, int*)          { return (OK); };
 
@@ -882,6 +890,7 @@ struct IFdevice
 
     const char *name()          const { return (dv_name); }
     const char *description()   const { return (dv_description); }
+    const char *module()        const { return (dv_module); }
     int numKeys()               const { return (dv_numKeys); }
     int flags()                 const { return (dv_flags); }
 
@@ -129,6 +129,7 @@ public:
     void parseMod(sLine*);
     void parseDefMod(sLine*, sCKT*);
     bool checkKey(char, int);
+    bool findLev(const char*, int*, bool);
 
     // inptran.cc
     bool isTranFunc(const char*);
@@ -182,7 +183,6 @@ private:
     void delMosLevelMapping(int);
     void clearMosLevelMaps();
     int getMosLevelMapping(int);
-    bool findLev(const char*, int*, bool);
     sINPmodel *mosFind(sLine*, const char*, double, double);
     int mosLWcnds(sLine*, sINPmodel*, double, double);
     bool instantiateMod(sLine*, sINPmodel*, sCKT*);
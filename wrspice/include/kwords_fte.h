@@ -213,6 +213,7 @@ extern const char *kw_degrees;
 
 // the command configuration keywords
 extern const char *kw_appendwrite;
+extern const char *kw_aspool;
 extern const char *kw_checkiterate;
 extern const char *kw_diff_abstol;
 extern const char *kw_diff_reltol;
@@ -241,11 +242,16 @@ extern const char *kw_printnoheader;
 extern const char *kw_printnoindex;
 extern const char *kw_printnopageheader;
 extern const char *kw_printnoscale;
+extern const char *kw_profile;
 extern const char *kw_random;
 extern const char *kw_rawfile;
 extern const char *kw_rawfileprec;
 extern const char *kw_rhost;
 extern const char *kw_rprogram;
+extern const char *kw_savecomp;
+extern const char *kw_savemindt;
+extern const char *kw_savetol;
+extern const char *kw_savewin;
 extern const char *kw_spectrace;
 extern const char *kw_specwindow;
 extern const char *kw_specwindoworder;
@@ -52,6 +52,8 @@ Authors: 1988 Wayne A. Christopher
 // sRunDesc functions, low-level output control.
 //
 
+struct sRunDesc;
+
 
 // Struct used to store information on a data object.
 //
@@ -64,6 +66,7 @@ struct dataDesc
     void pushRealValue(double, unsigned int);
     void addComplexValue(IFcomplex, bool);
     void pushComplexValue(IFcomplex, unsigned int);
+    void addCompressedValue(double, double, const sRunDesc*);
 
     const char *name;   // The name of the vector
     sDataVec *vec;      // The data
@@ -76,6 +79,12 @@ struct dataDesc
     bool useVecIndx;    // Use vector for special array index
     bool regular;       // True if regular vector, false if special
     bool rollover_ok;   // If true, roll over
+
+    // Waveform compression, used only if cscale is set.
+    sDataVec *cscale;   // Per-vector scale, saved points only
+    double c_peak;      // Largest magnitude seen
+    double c_slo;       // Slope limits from the last saved point
+    double c_shi;
 };
 
 // Struct used to store run status and context.  This is returned from
@@ -114,6 +123,11 @@ struct sRunDesc
             rd_seglimit     = 0.0;
             rd_segindex     = 0;
             rd_scrolling    = false;
+
+            rd_comptol      = 0.0;
+            rd_compmindt    = 0.0;
+            rd_compwins     = 0;
+            rd_numcompwins  = 0;
         }
 
     ~sRunDesc()
@@ -127,12 +141,14 @@ struct sRunDesc
             delete [] rd_data;
             delete rd_rd;
             delete rd_segfilebase;
+            delete [] rd_compwins;
         }
 
     void plotInit(double, double, double, sPlot*);
     void addPointToPlot(IFvalue*, IFvalue*, bool);
     void pushPointToPlot(sCKT*, IFvalue*, IFvalue*, unsigned int);
     void setupSegments(const char*, double, sOUTdata*);
+    void setupCompress();
     void dumpSegment();
     void resetVecs();
     void plotEnd();
@@ -224,6 +240,22 @@ struct sRunDesc
 
     void set_scrolling(bool b)      { rd_scrolling = b; }
 
+    double comptol()                const { return (rd_comptol); }
+    double compmindt()              const { return (rd_compmindt); }
+
+    // Return true if x is within a save window, or no windows are
+    // given.
+    bool in_compwin(double x) const
+        {
+            if (!rd_numcompwins)
+                return (true);
+            for (int i = 0; i < rd_numcompwins; i++) {
+                if (x >= rd_compwins[2*i] && x <= rd_compwins[2*i + 1])
+                    return (true);
+            }
+            return (false);
+        }
+
     double ref_value()
         {
             if (rd_refIndex >= 0 && rd_data)
@@ -262,6 +294,12 @@ private:
     double rd_seglimit;     // end of segment
     int rd_segindex;        // count of segments outputs
     bool rd_scrolling;      // true when scrolling
+
+    // These parameters are for waveform compression.
+    double rd_comptol;      // relative error tolerance
+    double rd_compmindt;    // minimum spacing of saved points
+    double *rd_compwins;    // save window start/end pairs
+    int rd_numcompwins;     // number of save windows
 };
 
 #endif
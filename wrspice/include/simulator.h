@@ -637,6 +637,8 @@ struct IFsimulator
     void Show(wordlist*, char**, bool, int);
     void CheckDevlib();
     void LoadModules(const char*);
+    void LoadDeferredModules(const char*, const char*);
+    void DeferredModuleRefs(int, int*, int*, int*, bool*);
 
     // fte/dotcards.cc
     sLine *GetDotOpts(sLine*);
@@ -663,6 +665,7 @@ struct IFsimulator
     void Periodic();
     bool ImplicitCommand(wordlist*);
     bool IsTrue(wordlist*);
+    bool IsTrue(pnode*);
     void SetFPEmode(FPEmode);
     FPEmode SetCircuitFPEmode();
 
@@ -510,6 +510,8 @@ sTRANint::accept(sCKT *ckt, sSTATS *stat, int *done, int *afterpause)
             ckt->breakClr();
 
         stat->STATaccepted++;
+        if (stat->STATperf)
+            stat->STATperf->accept_step();
         ckt->CKTbreak = 0;
         if (error)
             return (error);
@@ -700,7 +702,13 @@ sTRANint::step(sCKT *ckt, sSTATS *stat)
         int niter = stat->STATnumIter;
         int maxiters = ckt->CKTcurTask->TSKtranMaxIter;
 
+        unsigned long long pfStart =
+            stat->STATperf ? sPerfStats::ticks() : 0;
         int cverr = ckt->NIiter(maxiters);
+        if (stat->STATperf) {
+            stat->STATperf->add_step(ckt->CKTtime, ckt->CKTdelta,
+                stat->STATnumIter - niter, (cverr == OK), pfStart);
+        }
 
         // The bound_step maximum time step set by Verilog-A support,
         // computed in the load functions.
@@ -46,115 +46,60 @@ Authors: 1985 Thomas L. Quarles
 ****************************************************************************/
 
 #include "circuit.h"
+#include <string.h>
 
 
 //
 // Breakpoint/lattice point functions (sCKTlattice).
 //
 
+// Return the first breakpoint of the lattice later than t, or a
+// negative value if none.
+//
+double
+sCKTlattice::lattice::next(double t) const
+{
+    if (gen)
+        return (gen->next_break(t));
+    if (t < offs)
+        return (offs);
+    double tn = offs + per*(floor((t - offs)/per) + 1.0);
+    if (tn <= t)
+        tn += per;
+    return (tn);
+}
+
+
 // Delete the first time from the breakpoint table for the given circuit.
 //
 void
 sCKTlattice::clear_break(double ckt_time, double minbrk, double *ckt_breaks)
 {
+    purge(ckt_time);
     *ckt_breaks = nextbreak(*ckt_breaks, minbrk);
     *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-    int i;
-    for (i = 0; i < numBreaks; i++)
-        if (breaks[i] > ckt_time)
-            break;
-    if (i) {
-        numBreaks -= i;
-        for (int j = 0; j < numBreaks; j++)
-            breaks[j] = breaks[j+i];
-    }
 }
 
 
 // Add the given time to the breakpoint table for the given circuit,
 // return true if breakpoint actually added.
 //
+// Unlike the flat table used previously, points close to an existing
+// breakpoint or lattice point are not merged here.  This is done
+// lazily as the points are reached, in collapse().
+//
 bool
 sCKTlattice::set_break(double time, double ckt_time, double minbrk,
     double *ckt_breaks)
 {
-    if (lattices) {
-        for (int i = 0; i < numLattices; i++) {
-            double dt0, dt1;
-            if (time < lattices[i].offs) {
-                dt0 = lattices[i].offs + lattices[i].per;
-                dt1 = lattices[i].offs;;
-            }
-            else{
-                dt0 = lattices[i].per *
-                    ceil((time - lattices[i].offs)/lattices[i].per) +
-                    lattices[i].offs;
-                dt1 = lattices[i].per *
-                    floor((time - lattices[i].offs)/lattices[i].per) +
-                    lattices[i].offs;
-            }
-            if (fabs(time - dt0) < minbrk ||
-                    fabs(time - dt1) < minbrk) {
-                if (time < *ckt_breaks)
-                    *ckt_breaks = nextbreak(ckt_time, minbrk);
-                *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-                return (false);
-            }
-        }
-    }
-    if (!breaks) {
-        breaks = new double[1];
-        breaks[0] = time;
-        numBreaks = 1;
+    purge(ckt_time);
+    push(time, -1);
+    if (!brkSet) {
+        // The first point (time 0 from breakInit) does not update the
+        // circuit breakpoints.
+        brkSet = true;
         return (false);
     }
-    for (int i = 0; i < numBreaks; i++) {
-        if (breaks[i] > time) { // passed
-            if ((breaks[i] - time) <= minbrk) {
-                // Very close together - take earlier point.
-                breaks[i] = time;
-                if (time < *ckt_breaks)
-                    *ckt_breaks = nextbreak(ckt_time, minbrk);
-                *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-                return (true);
-            }
-            if (time - breaks[i-1] <= minbrk) {
-                // very close together, but after, so skip
-                if (time < *ckt_breaks)
-                    *ckt_breaks = nextbreak(ckt_time, minbrk);
-                *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-                return (true);
-            }
-            // Fits in middle - new array & insert.
-            double *tmp = new double[numBreaks + 1];
-            int j;
-            for (j = 0; j < i; j++)
-                *(tmp + j) = breaks[j];
-            *(tmp + i) = time;
-            for (j = i; j < numBreaks; j++) {
-                *(tmp + j+1) = breaks[j];
-            }
-            delete [] breaks;;
-            numBreaks++;
-            breaks = tmp;
-            if (time < *ckt_breaks)
-                *ckt_breaks = nextbreak(ckt_time, minbrk);
-            *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-            return (true);
-        }
-    }
-    // never found it - beyond end of time - extend
-    if (time - breaks[numBreaks-1] <= minbrk) {
-        // very close together - keep earlier, throw out new point
-        if (time < *ckt_breaks)
-            *ckt_breaks = nextbreak(ckt_time, minbrk);
-        *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
-        return (true);
-    }
-    // Fits at end - grow array & add.
-    Realloc(&breaks, numBreaks+1, numBreaks);
-    breaks[numBreaks] = time;
-    numBreaks++;
     if (time < *ckt_breaks)
         *ckt_breaks = nextbreak(ckt_time, minbrk);
     *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
@@ -167,22 +112,74 @@ sCKTlattice::set_break(double time, double ckt_time, double minbrk,
 void
 sCKTlattice::set_lattice(double offs, double per)
 {
-    if (lattices) {
-        for (int i = 0; i < numLattices; i++) {
-            if (offs == lattices[i].offs && per == lattices[i].per)
+    if (per <= 0.0)
+        return;
+
+    // Look for a duplicate, in the hash table.
+    unsigned long long k[2];
+    memcpy(k, &offs, sizeof(double));
+    memcpy(k+1, &per, sizeof(double));
+    unsigned long long h = k[0]*0x9e3779b97f4a7c15ULL ^ k[1];
+    h ^= h >> 29;
+    if (hashtab) {
+        for (unsigned int i = h & hashMask; hashtab[i];
+                i = (i + 1) & hashMask) {
+            const lattice *l = lattices + hashtab[i] - 1;
+            if (!l->gen && l->offs == offs && l->per == per)
                 return;
         }
-        Realloc(&lattices, numLattices+1, numLattices);
-        lattices[numLattices].offs = offs;
-        lattices[numLattices].per = per;
-        numLattices++;
+    }
+
+    int ix = add_lattice(offs, per, 0);
+    if (!hashtab || (unsigned int)numLattices > (hashMask + 1)/2) {
+        // Rebuild at twice the size.
+        delete [] hashtab;
+        hashMask = hashtab ? 2*hashMask + 1 : 63;
+        while ((unsigned int)numLattices > (hashMask + 1)/2)
+            hashMask = 2*hashMask + 1;
+        hashtab = new int[hashMask + 1];
+        memset(hashtab, 0, (hashMask + 1)*sizeof(int));
+        for (int j = 0; j < numLattices; j++) {
+            const lattice *l = lattices + j;
+            if (l->gen)
+                continue;
+            memcpy(k, &l->offs, sizeof(double));
+            memcpy(k+1, &l->per, sizeof(double));
+            unsigned long long hh = k[0]*0x9e3779b97f4a7c15ULL ^ k[1];
+            hh ^= hh >> 29;
+            unsigned int i = hh & hashMask;
+            while (hashtab[i])
+                i = (i + 1) & hashMask;
+            hashtab[i] = j + 1;
+        }
     }
     else {
-        lattices = new lattice[1];
-        lattices[0].offs = offs;
-        lattices[0].per = per;
-        numLattices = 1;
+        unsigned int i = h & hashMask;
+        while (hashtab[i])
+            i = (i + 1) & hashMask;
+        hashtab[i] = ix + 1;
+    }
+    push(offs, ix);
+}
+
+
+// Add a breakpoint generator, which is now owned by the lattice.  The
+// circuit breakpoints are updated as for set_break.
+//
+void
+sCKTlattice::set_source(sCKTbreakSource *gen, double ckt_time,
+    double minbrk, double *ckt_breaks)
+{
+    double time = gen->next_break(ckt_time);
+    if (time < 0.0) {
+        delete gen;
+        return;
     }
+    purge(ckt_time);
+    push(time, add_lattice(0.0, 0.0, gen));
+    if (time < *ckt_breaks)
+        *ckt_breaks = nextbreak(ckt_time, minbrk);
+    *(ckt_breaks+1) = nextbreak(*ckt_breaks, minbrk);
 }
 
 
@@ -191,31 +188,177 @@ sCKTlattice::set_lattice(double offs, double per)
 double
 sCKTlattice::nextbreak(double t, double minbrk)
 {
-    double dt0 = 0.0;
-    int i;
-    if (lattices) {
-        for (i = 0; i < numLattices; i++) {
-            double dt1 = lattices[i].offs;
-            if (t > lattices[i].offs) {
-                dt1 += lattices[i].per *
-                    ceil((t - lattices[i].offs)/lattices[i].per);
-            }
-            if (fabs(dt1 - t) < minbrk)
-                dt1 += lattices[i].per;
-            if (dt0 == 0.0 || dt1 < dt0)
-                dt0 = dt1;
-        }
+    double thresh = t + minbrk;
+    collapse(t, thresh);
+    if (!numBreaks)
+        return (0.0);
+    if (heap[0].time >= thresh)
+        return (heap[0].time);
+
+    // The root is the single entry in [t, thresh), the answer is the
+    // smaller child.
+    double tn = 0.0;
+    if (numBreaks > 1)
+        tn = heap[1].time;
+    if (numBreaks > 2 && heap[2].time < tn)
+        tn = heap[2].time;
+    return (tn);
+}
+
+
+// Free everything.
+//
+void
+sCKTlattice::clear()
+{
+    for (int i = 0; i < numLattices; i++)
+        delete lattices[i].gen;
+    delete [] lattices;
+    delete [] heap;
+    delete [] hashtab;
+    lattices = 0;
+    heap = 0;
+    hashtab = 0;
+    numLattices = 0;
+    lattSize = 0;
+    numBreaks = 0;
+    heapSize = 0;
+    hashMask = 0;
+    brkSet = false;
+}
+
+
+// Add a lattice or generator to the list, return the index.
+//
+int
+sCKTlattice::add_lattice(double offs, double per, sCKTbreakSource *gen)
+{
+    if (numLattices >= lattSize) {
+        lattSize = lattSize ? 2*lattSize : 16;
+        lattice *tmp = new lattice[lattSize];
+        if (numLattices)
+            memcpy(tmp, lattices, numLattices*sizeof(lattice));
+        delete [] lattices;
+        lattices = tmp;
     }
-    for (i = 0; i < numBreaks; i++) {
-        if (breaks[i] > t)
+    lattice *l = lattices + numLattices;
+    l->offs = offs;
+    l->per = per;
+    l->gen = gen;
+    return (numLattices++);
+}
+
+
+void
+sCKTlattice::push(double time, int src)
+{
+    if (numBreaks >= heapSize) {
+        heapSize = heapSize ? 2*heapSize : 64;
+        brkent *tmp = new brkent[heapSize];
+        if (numBreaks)
+            memcpy(tmp, heap, numBreaks*sizeof(brkent));
+        delete [] heap;
+        heap = tmp;
+    }
+    heap[numBreaks].time = time;
+    heap[numBreaks].src = src;
+    numBreaks++;
+    sift_up(numBreaks - 1);
+}
+
+
+// Remove the root entry.
+//
+void
+sCKTlattice::pop()
+{
+    numBreaks--;
+    if (numBreaks > 0) {
+        heap[0] = heap[numBreaks];
+        sift_down(0);
+    }
+}
+
+
+void
+sCKTlattice::sift_down(int i)
+{
+    brkent e = heap[i];
+    for (;;) {
+        int c = 2*i + 1;
+        if (c >= numBreaks)
+            break;
+        if (c + 1 < numBreaks && heap[c+1].time < heap[c].time)
+            c++;
+        if (heap[c].time >= e.time)
+            break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = e;
+}
+
+
+void
+sCKTlattice::sift_up(int i)
+{
+    brkent e = heap[i];
+    while (i > 0) {
+        int p = (i - 1)/2;
+        if (heap[p].time <= e.time)
             break;
+        heap[i] = heap[p];
+        i = p;
     }
-    while (i < numBreaks && fabs(t - breaks[i]) < minbrk)
-        i++;
-    if (i == numBreaks)
-        return (dt0);
-    if (dt0 > 0.0 && dt0 < breaks[i])
-        return (dt0);
-    return (breaks[i]);
+    heap[i] = e;
 }
 
+
+// Remove the entries at or before t, the lattice and generator
+// entries are replaced by their next breakpoint after t.
+//
+void
+sCKTlattice::purge(double t)
+{
+    while (numBreaks && heap[0].time <= t) {
+        int src = heap[0].src;
+        double tn = src < 0 ? -1.0 : lattices[src].next(t);
+        if (tn < 0.0)
+            pop();
+        else {
+            heap[0].time = tn;
+            sift_down(0);
+        }
+    }
+}
+
+
+// Merge the entries earlier than thresh.  Entries in [t, thresh) are
+// replaced by a single breakpoint at the earliest of these, and
+// earlier entries, which can no longer be reached, are dropped.
+// Lattice and generator entries are advanced past thresh.  After
+// this, there is at most one entry in the heap earlier than thresh,
+// at the root.
+//
+void
+sCKTlattice::collapse(double t, double thresh)
+{
+    double tmin = -1.0;
+    while (numBreaks && heap[0].time < thresh) {
+        double tb = heap[0].time;
+        if (tb >= t && (tmin < 0.0 || tb < tmin))
+            tmin = tb;
+        int src = heap[0].src;
+        double tn = -1.0;
+        if (src >= 0)
+            tn = lattices[src].next(tb < t ? t : tb);
+        if (tn < 0.0)
+            pop();
+        else {
+            heap[0].time = tn;
+            sift_down(0);
+        }
+    }
+    if (tmin >= 0.0)
+        push(tmin, -1);
+}
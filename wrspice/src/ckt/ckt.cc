@@ -58,6 +58,7 @@ Authors: 1985 Thomas L. Quarles
 #include "verilog.h"
 #include "commands.h"
 #include "graph.h"
+#include "kwords_fte.h"
 #include "sparse/spmatrix.h"
 #include "spnumber/hash.h"
 #include "miscutil/errorrec.h"
@@ -178,11 +179,27 @@ namespace {
 #endif
 
 
+    // Per-thread data, identifies the thread for the busy time
+    // accounting when profiling.  The main thread is 0.  This is
+    // attached to every pool thread, and owned by the pool, since
+    // profiling can be turned on or off between runs that reuse a
+    // pool.
+    //
+    struct sPerfThreadData : public sTPthreadData
+    {
+        sPerfThreadData(int n) { tnum = n; }
+
+        int tnum;
+    };
+
+
     // Thread work procedure.
     //
-    int thread_proc(sTPthreadData*, void *arg)
+    int thread_proc(sTPthreadData *tdata, void *arg)
     {
         sInstBatch *b = (sInstBatch*)arg;
+        sPerfStats *perf = tdata ? b->ckt()->CKTstat->STATperf : 0;
+        unsigned long long t0 = perf ? sPerfStats::ticks() : 0;
         for (int i = 0; i < b->count(); i++) {
             sGENinstance *d = b->list(i);
             if (!d)
@@ -194,6 +211,11 @@ namespace {
                 return (error);
             }
         }
+        if (perf) {
+            // Profiling, tdata is a sPerfThreadData.
+            perf->add_thread_ns(((sPerfThreadData*)tdata)->tnum,
+                sPerfStats::ticks() - t0);
+        }
         return (0);
     }
 
@@ -204,6 +226,35 @@ namespace {
     {
         free((sInstBatch*)arg);
     }
+
+
+    // Job for multi-threaded temperature processing, one model.
+    //
+    struct sTempJob
+    {
+        sTempJob(sCKT *c, sGENmodel *m)
+            {
+                tj_ckt = c;
+                tj_model = m;
+            }
+
+        sCKT *tj_ckt;
+        sGENmodel *tj_model;
+    };
+
+
+    int temp_thread_proc(sTPthreadData*, void *arg)
+    {
+        sTempJob *j = (sTempJob*)arg;
+        sGENmodel *m = j->tj_model;
+        return (DEV.device(m->GENmodType)->temperature(m, j->tj_ckt));
+    }
+
+
+    void temp_destroy_proc(void *arg)
+    {
+        delete (sTempJob*)arg;
+    }
 }
 
 #endif // WITH_THREADS
@@ -440,6 +491,21 @@ sCKT::breakSetLattice(double offs, double per)
 }
 
 
+// Add a breakpoint generator, the breakpoints are obtained from the
+// generator as needed.  The generator is freed when the breakpoints
+// are reinitialized.
+//
+int
+sCKT::breakSetSource(sCKTbreakSource *gen)
+{
+    CKTlattice.set_source(gen, CKTtime, CKTcurTask->TSKminBreak, CKTbreaks);
+    if (Sp.GetFlag(FT_SIMDB))
+        TTY.err_printf("adding breakpoint source: num = %d\n",
+            CKTlattice.numbreaks());
+    return (OK);
+}
+
+
 // Clear the tables.
 //
 void
@@ -571,7 +637,22 @@ sCKT::doTask(bool reset)
                 CKTstat->STATloopThreads = 0;
 #endif
                 CKTstat->STATruns++;
+                if (Sp.GetVar(kw_profile, VTYP_BOOL, 0)) {
+                    if (!CKTstat->STATperf)
+                        CKTstat->STATperf = new sPerfStats;
+                    else
+                        CKTstat->STATperf->reset();
+                    CKTstat->STATperf->set_threads(1);
+                }
+                else {
+                    delete CKTstat->STATperf;
+                    CKTstat->STATperf = 0;
+                }
                 error = IFanalysis::analysis(i)->anFunc(this, reset);
+                if (CKTstat->STATperf) {
+                    CKTstat->STATperf->pf_wall =
+                        sPerfStats::ticks() - CKTstat->STATperf->pf_start;
+                }
 #ifdef HAVE_GETRUSAGE
                 getrusage(RUSAGE_SELF, &ruse2);
                 CKTstat->STATpageFaults = ruse2.ru_majflt - ruse.ru_majflt;
@@ -969,6 +1050,8 @@ sCKT::load(bool noclear)
     CKTdevMaxDelta = 0.0;
 
     double startTime = OP.seconds();
+    sPerfStats *perf = CKTstat->STATperf;
+    unsigned long long pfStart = perf ? sPerfStats::ticks() : 0;
     int size = CKTmatrix->spGetSize(1);
     memset(CKTrhs, 0, (size+1)*sizeof(double));
 
@@ -996,9 +1079,31 @@ sCKT::load(bool noclear)
     if (CKTmutModels) {
         muttype = CKTmutModels->GENmodType;
         for (sGENmodel *dm = CKTmutModels; dm; dm = dm->GENnextModel) {
+            unsigned long long t0 = perf ? sPerfStats::ticks() : 0;
+            int cnt = 0;
             for (sGENinstance *d = dm->GENinstances; d;
                     d = d->GENnextInstance) {
                 DEV.device(muttype)->load(d, this);
+                cnt++;
+            }
+            if (perf) {
+                sPerfModel *pm = perf->find_model(dm);
+                pm->pm_loads++;
+                pm->pm_calls += cnt;
+                pm->pm_ns += sPerfStats::ticks() - t0;
+            }
+        }
+    }
+
+    // Give the devices a chance to update shared model data, before
+    // the instances are loaded, possibly in parallel.
+    {
+        sCKTmodGen mgen(CKTmodels);
+        for (sGENmodel *m = mgen.next(); m; m = mgen.next()) {
+            int error = DEV.device(m->GENmodType)->preLoad(m, this);
+            if (error) {
+                CKTtrapCheck = tchk;
+                return (error);
             }
         }
     }
@@ -1065,7 +1170,8 @@ sCKT::load(bool noclear)
             // Update the thread pool.
             delete CKTloadPool;
             CKTloadPool = new cThreadPool(CKTloadThreads);
-            CKTstat->STATloadThreads = CKTloadThreads;
+            for (int i = 0; i < CKTloadThreads; i++)
+                CKTloadPool->setThreadData(new sPerfThreadData(i+1), i);
 
             // Add the tasks, clear the list.
             while (batch) {
@@ -1077,7 +1183,11 @@ sCKT::load(bool noclear)
         }
     }
     if (CKTloadThreads > 0) {
-        int error = CKTloadPool->run(0);
+        CKTstat->STATloadThreads = CKTloadThreads;
+        if (perf)
+            perf->set_threads(CKTloadThreads + 1);
+        sPerfThreadData mainData(0);
+        int error = CKTloadPool->run(perf ? &mainData : 0);
         if (error) {
             CKTtrapCheck = tchk;
             return (error);
@@ -1100,7 +1210,8 @@ sCKT::load(bool noclear)
                 (CKTloadPool->num_threads() != (unsigned int)CKTloadThreads)) {
             delete CKTloadPool;
             CKTloadPool = new cThreadPool(CKTloadThreads);
-            CKTstat->STATloadThreads = CKTloadThreads;
+            for (int i = 0; i < CKTloadThreads; i++)
+                CKTloadPool->setThreadData(new sPerfThreadData(i+1), i);
 
             sInstBatch *batch = 0;
             int j = 0;
@@ -1132,7 +1243,11 @@ sCKT::load(bool noclear)
             }
             delete batch;
         }
-        int error = CKTloadPool->run(0);
+        CKTstat->STATloadThreads = CKTloadThreads;
+        if (perf)
+            perf->set_threads(CKTloadThreads + 1);
+        sPerfThreadData mainData(0);
+        int error = CKTloadPool->run(perf ? &mainData : 0);
         if (error) {
             CKTtrapCheck = tchk;
             return (error);
@@ -1148,6 +1263,8 @@ sCKT::load(bool noclear)
                 continue;
             for (sGENmodel *dm = m; dm; dm = dm->GENnextModel) {
                 int noncon = CKTnoncon;
+                unsigned long long t0 = perf ? sPerfStats::ticks() : 0;
+                int cnt = 0;
                 for (sGENinstance *d = dm->GENinstances; d;
                         d = d->GENnextInstance) {
                     int error = DEV.device(m->GENmodType)->load(d, this);
@@ -1157,6 +1274,13 @@ sCKT::load(bool noclear)
                         CKTtrapCheck = tchk;
                         return (error);
                     }
+                    cnt++;
+                }
+                if (perf) {
+                    sPerfModel *pm = perf->find_model(dm);
+                    pm->pm_loads++;
+                    pm->pm_calls += cnt;
+                    pm->pm_ns += sPerfStats::ticks() - t0;
                 }
                 if (CKTstepDebug) {
                     if (noncon != CKTnoncon) {
@@ -1169,6 +1293,8 @@ sCKT::load(bool noclear)
                 }
             }
         }
+        if (perf)
+            perf->add_thread_ns(0, sPerfStats::ticks() - pfStart);
     }
 
     CKTtrapCheck = tchk;
@@ -1202,6 +1328,10 @@ sCKT::load(bool noclear)
         }
     }
     CKTstat->STATloadTime += OP.seconds() - startTime;
+    if (perf) {
+        perf->pf_loads++;
+        perf->pf_load_ns += sPerfStats::ticks() - pfStart;
+    }
     return (OK);
 }
 
@@ -2294,6 +2424,67 @@ int
 sCKT::temp()
 {
     CKTvt = wrsCONSTKoverQ * CKTcurTask->TSKtemp;
+#ifdef WITH_THREADS
+    if (CKTcurTask->TSKloadThreads > 0) {
+        // Process the models in parallel, using the loadthrds count. 
+        // Each model is a separate job, the device temperature
+        // functions see a single model since the model lists are
+        // temporarily broken.  Only devices whose temperature
+        // function is known to be thread-safe, which set DV_PARTEMP,
+        // are done this way.  Others are done first, in the usual
+        // way.
+
+        int nmods = 0;
+        sCKTmodGen mgen(CKTmodels);
+        for (sGENmodel *m = mgen.next(); m; m = mgen.next()) {
+            if (!(DEV.device(m->GENmodType)->flags() & DV_PARTEMP)) {
+                int error = DEV.device(m->GENmodType)->temperature(m, this);
+                if (error)
+                    return (error);
+                continue;
+            }
+            for (sGENmodel *dm = m; dm; dm = dm->GENnextModel)
+                nmods++;
+        }
+        if (nmods > 1) {
+            sGENmodel **nexts = new sGENmodel*[nmods];
+            cThreadPool pool(CKTcurTask->TSKloadThreads);
+            int cnt = 0;
+            mgen = sCKTmodGen(CKTmodels);
+            for (sGENmodel *m = mgen.next(); m; m = mgen.next()) {
+                if (!(DEV.device(m->GENmodType)->flags() & DV_PARTEMP))
+                    continue;
+                for (sGENmodel *dm = m; dm; dm = nexts[cnt++]) {
+                    nexts[cnt] = dm->GENnextModel;
+                    dm->GENnextModel = 0;
+                    pool.submit(temp_thread_proc, new sTempJob(this, dm),
+                        temp_destroy_proc);
+                }
+            }
+            int error = pool.run(0);
+
+            cnt = 0;
+            mgen = sCKTmodGen(CKTmodels);
+            for (sGENmodel *m = mgen.next(); m; m = mgen.next()) {
+                if (!(DEV.device(m->GENmodType)->flags() & DV_PARTEMP))
+                    continue;
+                for (sGENmodel *dm = m; dm; dm = dm->GENnextModel)
+                    dm->GENnextModel = nexts[cnt++];
+            }
+            delete [] nexts;
+            return (error);
+        }
+        mgen = sCKTmodGen(CKTmodels);
+        for (sGENmodel *m = mgen.next(); m; m = mgen.next()) {
+            if (!(DEV.device(m->GENmodType)->flags() & DV_PARTEMP))
+                continue;
+            int error = DEV.device(m->GENmodType)->temperature(m, this);
+            if (error)
+                return (error);
+        }
+        return (OK);
+    }
+#endif
     sCKTmodGen mgen(CKTmodels);
     for (sGENmodel *m = mgen.next(); m; m = mgen.next()) {
         int error = DEV.device(m->GENmodType)->temperature(m, this);
@@ -270,6 +270,8 @@ sCKT::NIiter(int maxIter)
             }
         }
         double startTime = OP.seconds();
+        unsigned long long pfStart =
+            CKTstat->STATperf ? sPerfStats::ticks() : 0;
         error = loadGmin();
         if (error)
             break;
@@ -280,6 +282,11 @@ sCKT::NIiter(int maxIter)
             if (CKTtranTrace > 1)
                 TTY.err_printf("Reordering matrix\n");
             CKTstat->STATreorderTime += OP.seconds() - startTime;
+            if (CKTstat->STATperf) {
+                CKTstat->STATperf->pf_reorders++;
+                CKTstat->STATperf->pf_reorder_ns +=
+                    sPerfStats::ticks() - pfStart;
+            }
             if (error) {
                 // can't handle these errors - pass up!
                 if (CKTstepDebug) {
@@ -329,6 +336,13 @@ sCKT::NIiter(int maxIter)
             CKTstat->STATdecompTime += dt;
             if (!(CKTmode & MODEDC) && (CKTmode & MODETRAN))
                 CKTstat->STATtranDecompTime += dt;
+            if (CKTstat->STATperf) {
+                CKTstat->STATperf->pf_factors++;
+                CKTstat->STATperf->pf_factor_ns +=
+                    sPerfStats::ticks() - pfStart;
+                if (error == E_SINGULAR)
+                    CKTstat->STATperf->pf_singular++;
+            }
             if (error) {
                 if (error == E_SINGULAR) {
                     CKTniState |= NISHOULDREORDER;
@@ -379,11 +393,17 @@ sCKT::NIiter(int maxIter)
 #endif
 
         startTime = OP.seconds();
+        if (CKTstat->STATperf)
+            pfStart = sPerfStats::ticks();
         CKTmatrix->spSolve(CKTrhs, CKTrhs, 0, 0);
         double dt = OP.seconds() - startTime;;
         CKTstat->STATsolveTime += dt;
         if (!(CKTmode & MODEDC) && (CKTmode & MODETRAN))
             CKTstat->STATtranSolveTime += dt;
+        if (CKTstat->STATperf) {
+            CKTstat->STATperf->pf_solves++;
+            CKTstat->STATperf->pf_solve_ns += sPerfStats::ticks() - pfStart;
+        }
         error = check_fpe(false);
         if (error) {
             if (CKTstepDebug)
@@ -0,0 +1,391 @@
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * WRspice Circuit Simulation and Analysis Tool                           *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "config.h"
+#include "device.h"
+#include "misc.h"
+#include <sys/time.h>
+#include <time.h>
+
+
+//
+// Detailed performance data collection, enabled by the "profile"
+// variable.  The data are dumped in JSON format by "rusage -json".
+// The output includes a "traceEvents" array, so that the file can be
+// loaded directly into the Chrome trace viewer.
+//
+
+// Storage is reclaimed here, the struct is otherwise a plain
+// container.
+//
+sSTATS::~sSTATS()
+{
+    delete STATperf;
+}
+
+
+sPerfStats::sPerfStats()
+{
+    pf_start = ticks();
+    pf_wall = 0;
+    pf_models = 0;
+    pf_nummodels = 0;
+    pf_modsize = 0;
+    pf_modcur = 0;
+    pf_numthreads = 0;
+    pf_thread_ns = 0;
+    pf_load_ns = 0;
+    pf_loads = 0;
+    pf_steps = 0;
+    pf_numsteps = 0;
+    pf_stepsize = 0;
+    pf_reorders = 0;
+    pf_factors = 0;
+    pf_solves = 0;
+    pf_singular = 0;
+    pf_reorder_ns = 0;
+    pf_factor_ns = 0;
+    pf_solve_ns = 0;
+}
+
+
+sPerfStats::~sPerfStats()
+{
+    for (int i = 0; i < pf_nummodels; i++)
+        delete [] pf_models[i].pm_name;
+    delete [] pf_models;
+    delete [] pf_thread_ns;
+    delete [] pf_steps;
+}
+
+
+// Static function.
+// Return a monotonic time stamp in nanoseconds.
+//
+unsigned long long
+sPerfStats::ticks()
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (((unsigned long long)ts.tv_sec)*1000000000 + ts.tv_nsec);
+#else
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return (((unsigned long long)tv.tv_sec)*1000000000 +
+        ((unsigned long long)tv.tv_usec)*1000);
+#endif
+}
+
+
+// Clear all data, called when an analysis starts.  The model records
+// are freed, since the models may not exist after a reset.
+//
+void
+sPerfStats::reset()
+{
+    for (int i = 0; i < pf_nummodels; i++)
+        delete [] pf_models[i].pm_name;
+    delete [] pf_models;
+    pf_models = 0;
+    pf_nummodels = 0;
+    pf_modsize = 0;
+    pf_modcur = 0;
+    delete [] pf_thread_ns;
+    pf_thread_ns = 0;
+    pf_numthreads = 0;
+    pf_load_ns = 0;
+    pf_loads = 0;
+    pf_numsteps = 0;
+    pf_reorders = 0;
+    pf_factors = 0;
+    pf_solves = 0;
+    pf_singular = 0;
+    pf_reorder_ns = 0;
+    pf_factor_ns = 0;
+    pf_solve_ns = 0;
+    pf_start = ticks();
+    pf_wall = 0;
+}
+
+
+// Return the record for the model, creating it if necessary.  Since
+// the loader visits models in the same order on each pass, the
+// record following the last one returned is checked first, so that
+// the search is almost always avoided.
+//
+sPerfModel *
+sPerfStats::find_model(const sGENmodel *m)
+{
+    if (pf_modcur < pf_nummodels && pf_models[pf_modcur].pm_model == m)
+        return (&pf_models[pf_modcur++]);
+    for (int i = 0; i < pf_nummodels; i++) {
+        if (pf_models[i].pm_model == m) {
+            pf_modcur = i + 1;
+            return (&pf_models[i]);
+        }
+    }
+    if (pf_nummodels >= pf_modsize) {
+        int sz = pf_modsize ? 2*pf_modsize : 16;
+        sPerfModel *tmp = new sPerfModel[sz];
+        if (pf_nummodels)
+            memcpy(tmp, pf_models, pf_nummodels*sizeof(sPerfModel));
+        delete [] pf_models;
+        pf_models = tmp;
+        pf_modsize = sz;
+    }
+    sPerfModel *pm = &pf_models[pf_nummodels++];
+    pm->pm_model = m;
+    pm->pm_name = lstring::copy((const char*)m->GENmodName);
+    pm->pm_type = m->GENmodType;
+    pm->pm_loads = 0;
+    pm->pm_calls = 0;
+    pm->pm_ns = 0;
+    pf_modcur = pf_nummodels;
+    return (pm);
+}
+
+
+// Allocate the per-thread busy time accumulators.  The count
+// includes the main thread, which is always index 0.
+//
+void
+sPerfStats::set_threads(int n)
+{
+    if (n == pf_numthreads)
+        return;
+    delete [] pf_thread_ns;
+    pf_thread_ns = 0;
+    pf_numthreads = n;
+    if (n > 0) {
+        pf_thread_ns = new unsigned long long[n];
+        memset(pf_thread_ns, 0, n*sizeof(unsigned long long));
+    }
+}
+
+
+// Add a transient time point to the trace.  The start argument is
+// the time stamp taken before iterating.
+//
+void
+sPerfStats::add_step(double time, double delta, int iters, bool conv,
+    unsigned long long start)
+{
+    if (pf_numsteps >= PF_MAXSTEPS)
+        return;
+    if (pf_numsteps >= pf_stepsize) {
+        int sz = pf_stepsize ? 2*pf_stepsize : 1024;
+        if (sz > PF_MAXSTEPS)
+            sz = PF_MAXSTEPS;
+        sPerfStep *tmp = new sPerfStep[sz];
+        if (pf_numsteps)
+            memcpy(tmp, pf_steps, pf_numsteps*sizeof(sPerfStep));
+        delete [] pf_steps;
+        pf_steps = tmp;
+        pf_stepsize = sz;
+    }
+    sPerfStep *ps = &pf_steps[pf_numsteps++];
+    unsigned long long now = ticks();
+    ps->ps_start = start > pf_start ? start - pf_start : 0;
+    ps->ps_dur = now > start ? now - start : 0;
+    ps->ps_time = time;
+    ps->ps_delta = delta;
+    ps->ps_iters = iters;
+    ps->ps_status = conv ? PS_CONVERGED : 0;
+}
+
+
+// Mark the most recent time point as accepted.
+//
+void
+sPerfStats::accept_step()
+{
+    if (pf_numsteps > 0)
+        pf_steps[pf_numsteps-1].ps_status |= PS_ACCEPTED;
+}
+
+
+namespace {
+    // Print a string in JSON quoted form.
+    //
+    void json_str(FILE *fp, const char *s)
+    {
+        putc('"', fp);
+        if (s) {
+            for ( ; *s; s++) {
+                if (*s == '"' || *s == '\\')
+                    putc('\\', fp);
+                if ((unsigned char)*s < ' ')
+                    fprintf(fp, "\\u%04x", *s);
+                else
+                    putc(*s, fp);
+            }
+        }
+        putc('"', fp);
+    }
+
+
+    inline double ns2s(unsigned long long ns)
+    {
+        return (ns*1e-9);
+    }
+
+
+    inline double ns2us(unsigned long long ns)
+    {
+        return (ns*1e-3);
+    }
+}
+
+
+// Dump everything in JSON format.  The aggregate statistics from the
+// sSTATS are included.
+//
+void
+sPerfStats::print_json(FILE *fp, const sSTATS *st) const
+{
+    fprintf(fp, "{\n");
+    fprintf(fp, "\"summary\": {");
+    fprintf(fp, "\"totaltime\": %.6e, ", st->STATtotAnalTime);
+    fprintf(fp, "\"trantime\": %.6e, ", st->STATtranTime);
+    fprintf(fp, "\"loadtime\": %.6e, ", st->STATloadTime);
+    fprintf(fp, "\"decomptime\": %.6e, ", st->STATdecompTime);
+    fprintf(fp, "\"solvetime\": %.6e, ", st->STATsolveTime);
+    fprintf(fp, "\"reordertime\": %.6e, ", st->STATreorderTime);
+    fprintf(fp, "\"cvchktime\": %.6e, ", st->STATcvChkTime);
+    fprintf(fp, "\"tranouttime\": %.6e, ", st->STATtranOutTime);
+    fprintf(fp, "\"trantstime\": %.6e, ", st->STATtranTsTime);
+    fprintf(fp, "\"iterations\": %d, ", st->STATnumIter);
+    fprintf(fp, "\"traniter\": %d, ", st->STATtranIter);
+    fprintf(fp, "\"timepoints\": %d, ", st->STATtimePts);
+    fprintf(fp, "\"accepted\": %d, ", st->STATaccepted);
+    fprintf(fp, "\"rejected\": %d, ", st->STATrejected);
+    fprintf(fp, "\"traniterlim\": %d, ", st->STATtranIterCut);
+    fprintf(fp, "\"trantrapcut\": %d, ", st->STATtranTrapCut);
+    fprintf(fp, "\"pagefaults\": %d, ", st->STATpageFaults);
+    fprintf(fp, "\"volcxswitch\": %d, ", st->STATvolCxSwitch);
+    fprintf(fp, "\"involcxswitch\": %d, ", st->STATinvolCxSwitch);
+    fprintf(fp, "\"walltime\": %.6e},\n", ns2s(pf_wall));
+
+    fprintf(fp, "\"matrix\": {");
+    fprintf(fp, "\"size\": %d, ", st->STATmatSize);
+    fprintf(fp, "\"nonzero\": %d, ", st->STATnonZero);
+    fprintf(fp, "\"fillin\": %d, ", st->STATfillIn);
+    fprintf(fp, "\"reorders\": %d, ", pf_reorders);
+    fprintf(fp, "\"factors\": %d, ", pf_factors);
+    fprintf(fp, "\"singular\": %d, ", pf_singular);
+    fprintf(fp, "\"solves\": %d, ", pf_solves);
+    fprintf(fp, "\"reordertime\": %.6e, ", ns2s(pf_reorder_ns));
+    fprintf(fp, "\"factortime\": %.6e, ", ns2s(pf_factor_ns));
+    fprintf(fp, "\"solvetime\": %.6e},\n", ns2s(pf_solve_ns));
+
+    // Per-type totals, summed from the model records.
+    fprintf(fp, "\"devices\": [");
+    int ndev = DEV.numdevs();
+    bool first = true;
+    for (int t = 0; t < ndev; t++) {
+        int nm = 0, loads = 0;
+        unsigned long calls = 0;
+        unsigned long long ns = 0;
+        for (int i = 0; i < pf_nummodels; i++) {
+            const sPerfModel *pm = &pf_models[i];
+            if (pm->pm_type != t)
+                continue;
+            nm++;
+            loads += pm->pm_loads;
+            calls += pm->pm_calls;
+            ns += pm->pm_ns;
+        }
+        if (!nm)
+            continue;
+        fprintf(fp, "%s\n  {\"type\": ", first ? "" : ",");
+        json_str(fp, DEV.device(t) ? DEV.device(t)->name() : 0);
+        fprintf(fp, ", \"models\": %d, \"loads\": %d, \"calls\": %lu, "
+            "\"time\": %.6e}", nm, loads, calls, ns2s(ns));
+        first = false;
+    }
+    fprintf(fp, "],\n");
+
+    fprintf(fp, "\"models\": [");
+    for (int i = 0; i < pf_nummodels; i++) {
+        const sPerfModel *pm = &pf_models[i];
+        fprintf(fp, "%s\n  {\"name\": ", i ? "," : "");
+        json_str(fp, pm->pm_name);
+        fprintf(fp, ", \"type\": ");
+        json_str(fp, DEV.device(pm->pm_type) ?
+            DEV.device(pm->pm_type)->name() : 0);
+        fprintf(fp, ", \"loads\": %d, \"calls\": %lu, \"time\": %.6e}",
+            pm->pm_loads, pm->pm_calls, ns2s(pm->pm_ns));
+    }
+    fprintf(fp, "],\n");
+
+    // Idle time is the load wall time not spent in the thread's jobs,
+    // i.e., time waiting for other threads to finish.
+    fprintf(fp, "\"loads\": %lu, \"loadwalltime\": %.6e,\n", pf_loads,
+        ns2s(pf_load_ns));
+    fprintf(fp, "\"threads\": [");
+    for (int i = 0; i < pf_numthreads; i++) {
+        unsigned long long busy = pf_thread_ns[i];
+        unsigned long long idle = pf_load_ns > busy ? pf_load_ns - busy : 0;
+        fprintf(fp, "%s\n  {\"thread\": %d, \"busy\": %.6e, \"idle\": %.6e}",
+            i ? "," : "", i, ns2s(busy), ns2s(idle));
+    }
+    fprintf(fp, "],\n");
+
+    fprintf(fp, "\"steps\": %d, \"stepsdropped\": %s,\n", pf_numsteps,
+        pf_numsteps >= PF_MAXSTEPS ? "true" : "false");
+    fprintf(fp, "\"displayTimeUnit\": \"ns\",\n");
+    fprintf(fp, "\"traceEvents\": [");
+    fprintf(fp, "\n  {\"name\": \"analysis\", \"ph\": \"X\", \"pid\": 1, "
+        "\"tid\": 1, \"ts\": 0, \"dur\": %.3f}", ns2us(pf_wall));
+    for (int i = 0; i < pf_numsteps; i++) {
+        const sPerfStep *ps = &pf_steps[i];
+        fprintf(fp, ",\n  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, "
+            "\"tid\": 1, \"ts\": %.3f, \"dur\": %.3f, \"args\": "
+            "{\"time\": %.9e, \"delta\": %.9e, \"iters\": %d, "
+            "\"converged\": %s, \"accepted\": %s}}",
+            (ps->ps_status & PS_ACCEPTED) ? "step" : "rejected",
+            ns2us(ps->ps_start), ns2us(ps->ps_dur), ps->ps_time,
+            ps->ps_delta, ps->ps_iters,
+            (ps->ps_status & PS_CONVERGED) ? "true" : "false",
+            (ps->ps_status & PS_ACCEPTED) ? "true" : "false");
+    }
+    fprintf(fp, "]\n}\n");
+}
+
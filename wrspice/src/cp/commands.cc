@@ -289,8 +289,8 @@ sCommand CommandTab::ct_list[] = {
       Bplot, Bplot, Bplot, Bplot, E_DEFHMASK, 1, LOTS, 0,
       "expr ... [vs expr] : Produce ascii plots." ) ,
     sCommand( cmd_aspice, com_aspice, false, false, false,
-      Bfile, Bfile, Bfile, Bfile, E_DEFHMASK, 1, 2, 0,
-      "file [outfile] : Run a spice job asynchronously." ) ,
+      Bfile, Bfile, Bfile, Bfile, E_DEFHMASK, 1, 4, 0,
+      "[-p priority] file [outfile] : Run a spice job asynchronously." ) ,
     sCommand( cmd_bug, com_bug, false, false, true,
       Bnone, Bnone, Bnone, Bnone, E_DEFHMASK, 0, 0, 0,
       ": Report a %s bug." ) ,
@@ -485,7 +485,7 @@ sCommand CommandTab::ct_list[] = {
       "[rawfile] : Run the simulation as specified in the input file." ) ,
     sCommand( cmd_rusage, com_rusage, false, false, false,
       Brus, Brus, Brus, Brus, E_DEFHMASK, 0, LOTS, 0,
-      "[resource ...] : Print current resource usage." ) ,
+      "[-json [file]] [resource ...] : Print current resource usage." ) ,
     sCommand( cmd_save, com_save, false, true, false,
       Bnode, Bnode, Bnode, Bnode, E_DEFHMASK, 0, LOTS, 0,
       "[all] [node ...] : Save a circuit output." ) ,
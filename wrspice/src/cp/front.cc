@@ -62,9 +62,11 @@ Authors: 1985 Wayne A. Christopher
 // cshpar history, for now at least) of commands and their event numbers, 
 // with a block considered as a statement. In a goto, the first word in
 // co_text is where to go, likewise for label. For conditional controls, 
-// we have to call ft_getpnames and ft_evaluate each time, since the
-// dvec pointers will change... Also we should do variable and backquote
-// substitution each time...
+// we have to do variable and backquote substitution each time, but the
+// parse tree is saved and reused while the substituted text is
+// unchanged.  Vectors are resolved by name when the tree is evaluated. 
+// Statement text that contains no substitution or glob characters is
+// passed to the command processor without these passes.
 
 enum RItype
 {
@@ -139,7 +141,11 @@ struct sControl
             co_elseblock = 0;
             co_next = 0;
             co_prev = 0;
+            co_tree = 0;
+            co_treestr = 0;
             co_numtimes = 0;
+            co_plainchk = false;
+            co_plain = false;
         }
 
     sControl *newblock()
@@ -158,6 +164,8 @@ struct sControl
                 wordlist::destroy(cx->co_cond);
                 wordlist::destroy(cx->co_text);
                 delete [] cx->co_foreachvar;
+                delete cx->co_tree;
+                delete [] cx->co_treestr;
                 destroy(cx->co_children);
                 destroy(cx->co_elseblock);
             }
@@ -169,6 +177,8 @@ struct sControl
     static sControl *find_label(sControl*, const char*);
     void doblock(retinfo *info);
     void dodump(FILE* = 0);
+    pnode *get_tree(const wordlist*, bool);
+    bool is_true();
 
     sControl *next()                { return (co_next); }
     sControl *parent()              { return (co_parent); }
@@ -185,7 +195,12 @@ private:
     sControl *co_elseblock;         // For if-then-else.
     sControl *co_next;
     sControl *co_prev;
+    pnode *co_tree;                 // Saved parse tree for if, while,
+                                    // dowhile, return.
+    char *co_treestr;               // Text of saved tree.
     int co_numtimes;                // Repeat, break & continue levels.
+    bool co_plainchk;               // Statement text has been checked.
+    bool co_plain;                  // Statement needs no substitution.
 
     static int co_indent;           // For printing.
 };
@@ -770,11 +785,13 @@ CshPar::GetCommand(const char *string)
 
 
 // Note that we only do io redirection when we get to here - we also
-// postpone some other things until now.
+// postpone some other things until now.  If plain is set, the caller
+// has determined that the text needs no variable, backquote, or glob
+// substitution (see IsPlain), and these passes are skipped.
 // NOTE! wlist is freed.
 //
 void
-CshPar::DoCommand(wordlist *wlist)
+CshPar::DoCommand(wordlist *wlist, bool plain)
 {
     if (cp_flags[CP_DEBUG]) {
         GRpkgIf()->ErrPrintf(ET_MSGS, "DoCommand: ");
@@ -793,14 +810,16 @@ CshPar::DoCommand(wordlist *wlist)
     // Do all the things that used to be done by cshpar when the line
     // was read...
     //
-    VarSubst(&wlist);
-    pwlist(wlist, "After variable substitution");
+    if (!plain) {
+        VarSubst(&wlist);
+        pwlist(wlist, "After variable substitution");
 
-    BackQuote(&wlist);
-    pwlist(wlist, "After backquote substitution");
+        BackQuote(&wlist);
+        pwlist(wlist, "After backquote substitution");
 
-    DoGlob(&wlist);
-    pwlist(wlist, "After globbing");
+        DoGlob(&wlist);
+        pwlist(wlist, "After globbing");
+    }
 
     if (!wlist || !wlist->wl_word)
         return;
@@ -921,6 +940,23 @@ CshPar::DoCommand(wordlist *wlist)
 }
 
 
+// Return true if none of the words contain characters that would be
+// changed by variable or backquote substitution or globbing.  Quoted
+// characters have the eighth bit set, and don't match.
+//
+bool
+CshPar::IsPlain(const wordlist *wlist)
+{
+    const char spec[] = { cp_dol, cp_back, cp_ocurl, cp_til, cp_star,
+        cp_huh, cp_obrac, 0 };
+    for (const wordlist *wl = wlist; wl; wl = wl->wl_next) {
+        if (strpbrk(wl->wl_word, spec))
+            return (false);
+    }
+    return (true);
+}
+
+
 // Reset the shell after an interrupt in interactive mode.
 //
 void
@@ -1234,6 +1270,64 @@ sControl::find_label(sControl *ct, const char *s)
 }
 
 
+// Return a parse tree for the text, which is variable and backquote
+// substituted if subst is set.  The tree is saved, and reused while
+// the text is unchanged, so that loop conditions are not reparsed on
+// each iteration.  The saved tree is not collapsed, as constant
+// folding would freeze the values of random functions such as rnd.
+// Return null on error.
+//
+pnode *
+sControl::get_tree(const wordlist *wl, bool subst)
+{
+    char *str = 0;
+    if (subst || !co_treestr) {
+        wordlist *w = wordlist::copy(wl);
+        if (subst) {
+            CP.VarSubst(&w);
+            CP.BackQuote(&w);
+            CP.StripList(w);
+        }
+        str = wordlist::flatten(w);
+        wordlist::destroy(w);
+    }
+    if (co_tree && (!str || lstring::eq(str, co_treestr))) {
+        delete [] str;
+        // The vectors referenced may have gone away.
+        if (!co_tree->checkvalid())
+            return (0);
+        return (co_tree);
+    }
+    delete co_tree;
+    delete [] co_treestr;
+    co_treestr = str;
+    const char *s = str;
+    co_tree = Sp.GetPnode(&s, false);
+    if (co_tree && !co_tree->checkvalid()) {
+        delete co_tree;
+        co_tree = 0;
+    }
+    if (!co_tree) {
+        // Try again next time.
+        delete [] co_treestr;
+        co_treestr = 0;
+    }
+    return (co_tree);
+}
+
+
+// Evaluate the condition.
+//
+bool
+sControl::is_true()
+{
+    if (!co_cond)
+        return (false);
+    pnode *pn = get_tree(co_cond, true);
+    return (pn && Sp.IsTrue(pn));
+}
+
+
 // Execute a block.  There can be a number of return values from this
 // function.
 //
@@ -1266,7 +1360,7 @@ sControl::doblock(retinfo *info)
     retinfo ri;
     switch (co_type) {
     case CO_WHILE:
-        while (co_cond && Sp.IsTrue(co_cond)) {
+        while (is_true()) {
             for (ch = co_children; ch; ch = cn) {
                 cn = ch->co_next;
                 if (CP.GetFlag(CP_INTRPT)) {
@@ -1364,7 +1458,7 @@ sControl::doblock(retinfo *info)
                     return;
                 }
             }
-        } while (co_cond && Sp.IsTrue(co_cond));
+        } while (is_true());
         break;
 
     case CO_REPEAT:
@@ -1422,7 +1516,7 @@ sControl::doblock(retinfo *info)
         break;
 
     case CO_IF:
-        if (co_cond && Sp.IsTrue(co_cond)) {
+        if (is_true()) {
             for (ch = co_children; ch; ch = cn) {
                 cn = ch->co_next;
                 ch->doblock(&ri);
@@ -1564,24 +1658,23 @@ sControl::doblock(retinfo *info)
         break;
 
     case CO_STATEMENT:
-        CP.DoCommand(wordlist::copy(co_text));
+        if (!co_plainchk) {
+            co_plain = CP.IsPlain(co_text);
+            co_plainchk = true;
+        }
+        CP.DoCommand(wordlist::copy(co_text), co_plain);
         break;
 
     case CO_RETURN:
         info->set_type(RETURN);
         if (co_text) {
-            wordlist *w = wordlist::copy(co_text);
-            char *str = wordlist::flatten(w);
-            const char *wp = str;
-            pnode *nn = Sp.GetPnode(&wp, true);
-            if (!nn) {
+            pnode *nn = get_tree(co_text, false);
+            sDataVec *t = nn ? Sp.Evaluate(nn) : 0;
+            if (!t) {
+                char *str = wordlist::flatten(co_text);
                 GRpkgIf()->ErrPrintf(ET_ERROR, "evaluation failed: %s.\n", str);
-                return;
+                delete [] str;
             }
-            sDataVec *t = Sp.Evaluate(nn);
-            delete nn;
-            if (!t)
-                GRpkgIf()->ErrPrintf(ET_ERROR, "evaluation failed: %s.\n", str);
             else
                 CP.SetReturnVal(t->realval(0));
         }
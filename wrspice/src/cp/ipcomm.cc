@@ -63,6 +63,7 @@
 #include "output.h"
 #include "toolbar.h"
 #include "miscutil/childproc.h"
+#include "ginterf/shmctl.h"
 
 
 #ifdef WIN32
@@ -83,6 +84,78 @@ namespace {
         }
         return (set);
     }
+
+
+    // Shared memory for bulk data returned to Xic.  This is used when
+    // Xic is on the same host, and has enabled it through the ping
+    // message.  The segment is reused for subsequent transfers.
+    //
+    struct sShmData
+    {
+        sShmData()
+            {
+                sd_buf = 0;
+                sd_id = 0;
+                sd_size = 0;
+                sd_enabled = false;
+            }
+
+        char *get_buf(unsigned int);
+        void reset();
+
+        char *sd_buf;           // Segment address.
+        int sd_id;              // Segment id.
+        unsigned int sd_size;   // Segment size.
+        bool sd_enabled;        // Xic will accept segments.
+    };
+
+    sShmData ShmData;
+
+
+    // Return a shared memory buffer of at least sz bytes, or null if
+    // shared memory is not available.
+    //
+    char *
+    sShmData::get_buf(unsigned int sz)
+    {
+        if (!sd_enabled)
+            return (0);
+        if (sd_buf && sd_size >= sz)
+            return (sd_buf);
+        ShmCtl::deallocate(sd_buf);
+        sd_buf = 0;
+        sd_size = 0;
+
+        // Round up, to reduce reallocation.
+        unsigned int nsz = 4096;
+        while (nsz < sz)
+            nsz <<= 1;
+        int id;
+        char *buf = (char*)ShmCtl::allocate(&id, nsz, true);
+        if (id <= 0) {
+            // Allocated from the heap, shared memory not available.
+            delete [] buf;
+            sd_enabled = false;
+            return (0);
+        }
+        sd_buf = buf;
+        sd_id = id;
+        sd_size = nsz;
+        return (sd_buf);
+    }
+
+
+    // Free the segment, called when the connection is closed.
+    //
+    void
+    sShmData::reset()
+    {
+        ShmCtl::deallocate(sd_buf);
+        sd_buf = 0;
+        sd_id = 0;
+        sd_size = 0;
+        sd_enabled = false;
+    }
 }
 
 
@@ -137,6 +210,7 @@ CshPar::InitIPCmessage()
     fcntl(msg, F_SETOWN, getpid());
 #endif
     cp_mesg_sock = msg;
+    ShmData.reset();
     return (false);
 }
 
@@ -357,6 +431,7 @@ CshPar::MessageHandler(int fc)
         // no response to close
         lstring::advtok(&s);
         pid_t pid = isdigit(*s) ? atoi(s) : 0;
+        ShmData.reset();
         if (pid > 0) {
             // Spice is parent of graphical editor.
             CLOSESOCKET(cp_mesg_sock);
@@ -418,10 +493,19 @@ CshPar::MessageHandler(int fc)
                 // Header: "okdr" or "okdc", 4B len in network byte order.
                 datalen += 8;
 
-                sprintf(buf, "data %d", datalen);
-                write_msg(buf);
-
-                char *dbuf = new char[datalen];
+                // If Xic is local and has enabled shared memory, the
+                // data are written to a shared segment, and only the
+                // "shm id numbytes" message is sent.  Xic will attach
+                // the segment read-only and copy out the data.  The
+                // format of the data block is the same in either case.
+
+                char *dbuf = ShmData.get_buf(datalen);
+                if (dbuf)
+                    sprintf(buf, "shm %d %d", ShmData.sd_id, datalen);
+                else {
+                    sprintf(buf, "data %d", datalen);
+                    dbuf = new char[datalen];
+                }
                 unsigned int *uip = (unsigned int*)dbuf;
                 double *dp = (double*)(dbuf + 8);
                 dbuf[0] = 'o';
@@ -437,8 +521,11 @@ CshPar::MessageHandler(int fc)
                     else
                         *dp++ = net_byte_reorder(dv->realval(i));
                 }
-                write_data(dbuf, datalen);
-                delete [] dbuf;
+                write_msg(buf);
+                if (dbuf != ShmData.sd_buf) {
+                    write_data(dbuf, datalen);
+                    delete [] dbuf;
+                }
                 wrote = true;
             }
             sDvList::destroy(dl0);
@@ -478,11 +565,18 @@ CshPar::MessageHandler(int fc)
         // catchar is set to ":" and mode to SPICE3.
 
         // The argument(s) to ping have the following syntax:
-        //   [-sc<catchar>][ ][-sm<mode>]
+        //   [-sc<catchar>][ ][-sm<mode>][ ][-shm]
         // where <mode> is a digit character ('0' plus the enum value).
+        //
+        // The -shm option is sent by Xic (4.3.10 and later) when on
+        // the same host, and indicates that bulk data returned from
+        // the eval command can be passed in shared memory.  If we
+        // can do this, " shm" is appended to the return.  Earlier
+        // releases ignore this option.
 
         lstring::advtok(&s);
         bool modeset = false;
+        bool shmset = false;
         for (;;) {
             if (isspace(*s)) {
                 s++;
@@ -491,6 +585,12 @@ CshPar::MessageHandler(int fc)
             if (*s != '-')
                 break;
             s++;
+            if (s[0] == 's' && s[1] == 'h' && s[2] == 'm') {
+                s += 3;
+                shmset = ShmCtl::available();
+                ShmData.sd_enabled = shmset;
+                continue;
+            }
             if (s[0] == 's' && s[1] == 'c') {
                 s += 2;
                 if (*s && !isspace(*s))
@@ -513,6 +613,8 @@ CshPar::MessageHandler(int fc)
             sprintf(buf, "ok%c%c", Sp.SubcCatchar(), '0' + Sp.SubcCatmode());
         else
             sprintf(buf, "ok%c", Sp.SubcCatchar());
+        if (shmset)
+            strcat(buf, " shm");
         write_msg(buf);
     }
     else {
@@ -738,6 +840,7 @@ CommandTab::com_sced(wordlist *wl)
         }
         if (FD_ISSET(CP.AcctSocket(), &ready)) {
             int msg = accept(CP.AcctSocket(), 0, 0);
+            ShmData.reset();
             if (msg >= 0)
                 CP.SetMesgSocket(msg);
             else {
@@ -58,6 +58,7 @@ Authors: 1987 Wayne A. Christopher
 #include "graph.h"
 #include "output.h"
 #include "aspice.h"
+#include "toolbar.h"
 #include "miscutil/services.h"
 #include "miscutil/pathlist.h"
 #include "miscutil/filestat.h"
@@ -72,6 +73,7 @@ Authors: 1987 Wayne A. Christopher
 #include <sys/wait.h>
 #include <netinet/in.h>
 #include <netdb.h>
+#include <poll.h>
 #endif
 
 
@@ -101,6 +103,15 @@ CommandTab::com_aspice(wordlist *wl)
         }
     }
 
+    int priority = 0;
+    if (wl && lstring::eq(wl->wl_word, "-p")) {
+        wl = wl->wl_next;
+        if (!wl || sscanf(wl->wl_word, "%d", &priority) != 1) {
+            GRpkgIf()->ErrPrintf(ET_ERROR, "bad or missing priority.\n");
+            return;
+        }
+        wl = wl->wl_next;
+    }
     char *deck = 0;
     if (wl) {
         deck = wl->wl_word;
@@ -109,7 +120,8 @@ CommandTab::com_aspice(wordlist *wl)
     char *output = 0;
     if (wl)
         output = wl->wl_word;
-    OP.jobc()->submit_local(spicepath, 0, deck, Sp.CurCircuit(), 0, output);
+    OP.jobc()->submit_local(spicepath, 0, deck, Sp.CurCircuit(), 0, output,
+        priority);
 }
 
 
@@ -288,6 +300,21 @@ sJobc::jobs()
         for (proc_t *p = s->joblist(); p; p = p->next())
             TTY.printf("%d\t%.70s\n", p->pid(), p->name());
     }
+#ifndef WIN32
+    if (jc_pool || jc_pool_queue) {
+        int nw = 0, nb = 0, nq = 0;
+        for (pwork_t *w = jc_pool; w; w = w->next()) {
+            if (w->fd() < 0)
+                continue;
+            nw++;
+            if (w->jobid())
+                nb++;
+        }
+        for (pjob_t *pj = jc_pool_queue; pj; pj = pj->next())
+            nq++;
+        TTY.printf("pool: %d workers, %d busy, %d queued\n", nw, nb, nq);
+    }
+#endif
 }
 
 
@@ -298,6 +325,9 @@ sJobc::check_jobs()
     if (here)
         return;
     here = true;
+#ifndef WIN32
+    pool_check();
+#endif
 
     char buf[BSIZE_SP];
     bool dopr = false;
@@ -389,8 +419,9 @@ sJobc::check_jobs()
                     int cnt = 0;
                     while (fgets(buf, BSIZE_SP, fp)) {
                         cnt++;
-                        // strip the copyright, etc
-                        if (cnt <= 3)
+                        // strip the copyright, etc, pool workers
+                        // don't print this
+                        if (cnt <= 3 && !p->pooled())
                             continue;
                         // strip some other crap
                         if (lstring::eq(buf, "async\n"))
@@ -833,7 +864,8 @@ struct thdata
 
 bool
 sJobc::submit_local(const char *program, const char *analysis,
-    const char *filename, sFtCirc *cir, rjob_t *rj, const char *outfile)
+    const char *filename, sFtCirc *cir, rjob_t *rj, const char *outfile,
+    int priority)
 {
     bool saveout;
     if (outfile)
@@ -919,8 +951,10 @@ sJobc::submit_local(const char *program, const char *analysis,
     char *raw = filestat::make_temp("raw");
     // So there isn't a race condition
     fclose(fopen(raw, "w"));
+    bool pooled = false;
 
 #ifdef WIN32
+    (void)priority;
 
     SECURITY_ATTRIBUTES sa;
     memset(&sa, 0, sizeof(SECURITY_ATTRIBUTES));
@@ -964,23 +998,33 @@ sJobc::submit_local(const char *program, const char *analysis,
 
 #else
 
-    int pid = fork();
-    if (pid == 0) {
-        if (!(freopen(filename, "r", stdin))) {
-            perror(filename);
-            _exit(EXIT_BAD);
-        }
-        if (!(freopen(outfile, "w", stdout))) {
-            perror(outfile);
-            _exit(EXIT_BAD);
-        }
-        dup2(fileno(stdout), fileno(stderr));
+    // If the aspool variable is set, the job is run by a persistent
+    // worker, and the "pid" is a (negative) job id.  Otherwise, or if
+    // the pool can't be started, fork off a new process.
+
+    int pid;
+    if (pool_size() > 0 &&
+            !pool_submit(filename, raw, outfile, priority, &pid))
+        pooled = true;
+    else {
+        pid = fork();
+        if (pid == 0) {
+            if (!(freopen(filename, "r", stdin))) {
+                perror(filename);
+                _exit(EXIT_BAD);
+            }
+            if (!(freopen(outfile, "w", stdout))) {
+                perror(outfile);
+                _exit(EXIT_BAD);
+            }
+            dup2(fileno(stdout), fileno(stderr));
 
-        execl(program, program, "-S", "-r", raw, (char*)0);
+            execl(program, program, "-S", "-r", raw, (char*)0);
 
-        // Screwed up
-        perror(program);
-        _exit(EXIT_BAD);
+            // Screwed up
+            perror(program);
+            _exit(EXIT_BAD);
+        }
     }
 
 #endif
@@ -990,6 +1034,7 @@ sJobc::submit_local(const char *program, const char *analysis,
     delete [] raw;
     p->set_saveout(saveout);
     p->set_tempinp(tempinp);
+    p->set_pooled(pooled);
     rserv_t *s;
     for (s = jc_servers; s; s = s->next())
         if (lstring::eq(s->host(), "local"))
@@ -1006,7 +1051,8 @@ sJobc::submit_local(const char *program, const char *analysis,
     }
     s->set_numjobs(s->numjobs() + 1);
 #ifndef WIN32
-    Proc()->RegisterChildHandler(pid, sigchild, 0);
+    if (!pooled)
+        Proc()->RegisterChildHandler(pid, sigchild, 0);
 #endif
     return (false);
 }
@@ -1154,6 +1200,410 @@ sJobc::sigchild(int pid, int status, void*)
     }
 }
 
+
+//
+// Persistent worker pool.
+//
+// When the aspool variable is set to a positive integer, local
+// asynchronous jobs are run by a pool of that many worker processes
+// instead of a new WRspice process per job.  The workers are forked
+// from this process, so that device modules, libraries, .options and
+// other state loaded at the time the pool is started are inherited,
+// saving the per-job startup cost.  Each worker is connected by a
+// Unix socket pair.  A job is passed as four lines:  the job id,
+// input file, rawfile, and output file.  The worker runs the job as
+// in server mode, and replies with a line containing the job id and
+// exit status.  Jobs are queued in priority order when all workers
+// are busy.  Unsetting aspool retires idle workers.
+//
+
+#ifdef MSG_NOSIGNAL
+#define POOL_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define POOL_SEND_FLAGS 0
+#endif
+
+
+// Return the requested pool size, from the aspool variable.
+//
+int
+sJobc::pool_size()
+{
+    VTvalue vv;
+    if (Sp.GetVar(kw_aspool, VTYP_NUM, &vv))
+        return (vv.get_int());
+    return (0);
+}
+
+
+// Queue a job for the pool, starting workers if necessary.  The
+// assigned job id is returned in id.  True is returned on error, in
+// which case the caller should run the job the traditional way.
+//
+bool
+sJobc::pool_submit(const char *deck, const char *raw, const char *out,
+    int priority, int *id)
+{
+    int nlive = 0;
+    for (pwork_t *w = jc_pool; w; w = w->next()) {
+        if (w->fd() >= 0)
+            nlive++;
+    }
+    int nreq = pool_size();
+    while (nlive < nreq) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+            GRpkgIf()->Perror("socketpair");
+            break;
+        }
+        // Don't let the child inherit unflushed output.
+        fflush(stdout);
+        fflush(stderr);
+        int pid = fork();
+        if (pid < 0) {
+            GRpkgIf()->Perror("fork");
+            close(sv[0]);
+            close(sv[1]);
+            break;
+        }
+        if (pid == 0) {
+            close(sv[0]);
+            for (pwork_t *w = jc_pool; w; w = w->next()) {
+                if (w->fd() >= 0)
+                    close(w->fd());
+            }
+            pool_worker(sv[1]);
+            // not reached
+        }
+        close(sv[1]);
+        jc_pool = new pwork_t(pid, sv[0], jc_pool);
+        Proc()->RegisterChildHandler(pid, pool_sigchild, 0);
+        nlive++;
+    }
+    if (!nlive)
+        return (true);
+
+    pjob_t *pj = new pjob_t(--jc_pool_lastid, priority, deck, raw, out);
+    pjob_t *pp = 0;
+    for (pjob_t *p = jc_pool_queue; p; p = p->next()) {
+        if (p->priority() < priority)
+            break;
+        pp = p;
+    }
+    if (pp) {
+        pj->set_next(pp->next());
+        pp->set_next(pj);
+    }
+    else {
+        pj->set_next(jc_pool_queue);
+        jc_pool_queue = pj;
+    }
+    *id = pj->id();
+    pool_dispatch();
+    return (false);
+}
+
+
+// Pass queued jobs to idle workers.
+//
+void
+sJobc::pool_dispatch()
+{
+    for (pwork_t *w = jc_pool; w && jc_pool_queue; w = w->next()) {
+        if (w->fd() < 0 || w->jobid())
+            continue;
+        pjob_t *pj = jc_pool_queue;
+        jc_pool_queue = pj->next();
+
+        sLstr lstr;
+        lstr.add_i(pj->id());
+        lstr.add_c('\n');
+        lstr.add(pj->deck());
+        lstr.add_c('\n');
+        lstr.add(pj->raw());
+        lstr.add_c('\n');
+        lstr.add(pj->out());
+        lstr.add_c('\n');
+        if (send(w->fd(), lstr.string(), lstr.length(), POOL_SEND_FLAGS) !=
+                (int)lstr.length()) {
+            // Worker is gone, requeue the job and retire the worker.
+            pj->set_next(jc_pool_queue);
+            jc_pool_queue = pj;
+            close(w->fd());
+            w->set_fd(-1);
+            continue;
+        }
+        w->set_jobid(pj->id());
+        delete pj;
+    }
+}
+
+
+// Called from check_jobs, collect the results from the workers,
+// retire dead and excess workers, and dispatch waiting jobs.
+//
+void
+sJobc::pool_check()
+{
+    if (!jc_pool && !jc_pool_queue)
+        return;
+
+    for (pwork_t *w = jc_pool; w; w = w->next()) {
+        if (w->fd() < 0)
+            continue;
+        pollfd pfd;
+        pfd.fd = w->fd();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 0) <= 0)
+            continue;
+
+        char buf[64];
+        int n = recv(w->fd(), buf, sizeof(buf) - 1, 0);
+        int id = 0, status = -1;
+        if (n > 0) {
+            buf[n] = 0;
+            if (sscanf(buf, "%d %d", &id, &status) != 2 ||
+                    id != w->jobid())
+                status = -1;
+        }
+        else {
+            // The worker exited, fail any job in progress.
+            close(w->fd());
+            w->set_fd(-1);
+        }
+        if (w->jobid()) {
+            add_done(w->jobid(), status);
+            jc_numchanged++;
+            w->set_jobid(0);
+            if (Sp.GetFlag(FT_ASYNCDB)) {
+                GRpkgIf()->ErrPrintf(ET_MSG,
+                    "pool worker %d finished job with status %d.\n",
+                    w->pid(), status);
+            }
+        }
+    }
+
+    // Retire idle workers in excess of the requested pool size,
+    // closing the socket causes the worker to exit.  Free the dead.
+    int nlive = 0;
+    for (pwork_t *w = jc_pool; w; w = w->next()) {
+        if (w->fd() >= 0)
+            nlive++;
+    }
+    int nreq = pool_size();
+    pwork_t *wp = 0, *wn;
+    for (pwork_t *w = jc_pool; w; w = wn) {
+        wn = w->next();
+        if (w->fd() >= 0 && !w->jobid() && nlive > nreq &&
+                !jc_pool_queue) {
+            close(w->fd());
+            w->set_fd(-1);
+            nlive--;
+        }
+        if (w->fd() < 0) {
+            if (wp)
+                wp->set_next(wn);
+            else
+                jc_pool = wn;
+            delete w;
+            continue;
+        }
+        wp = w;
+    }
+
+    if (jc_pool_queue) {
+        if (!jc_pool) {
+            // All workers have died, fail the queued jobs.
+            while (jc_pool_queue) {
+                pjob_t *pj = jc_pool_queue;
+                jc_pool_queue = pj->next();
+                add_done(pj->id(), -1);
+                jc_numchanged++;
+                delete pj;
+            }
+            GRpkgIf()->ErrPrintf(ET_ERROR,
+                "aspice worker pool exited, queued jobs aborted.\n");
+        }
+        else
+            pool_dispatch();
+    }
+}
+
+
+namespace {
+    // Reset the shell variables to those in the list, which was saved
+    // when the pool worker started.
+    //
+    void reset_vars(variable *vars)
+    {
+        Sp.ClearVariables();
+        for (variable *v = vars; v; v = v->next()) {
+            switch (v->type()) {
+            case VTYP_BOOL:
+                Sp.SetVar(v->name());
+                break;
+            case VTYP_NUM:
+                Sp.SetVar(v->name(), v->integer());
+                break;
+            case VTYP_REAL:
+                Sp.SetVar(v->name(), v->real());
+                break;
+            case VTYP_STRING:
+                Sp.SetVar(v->name(), v->string());
+                break;
+            case VTYP_LIST:
+                Sp.SetVar(v->name(), variable::copy(v->list()));
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+
+// Static function.
+// This is the main loop of a worker process, which never returns. 
+// The setup mimics a "wrspice -S -r rawfile" process, so that jobs
+// produce the same output as when run in a new process.
+//
+void
+sJobc::pool_worker(int fd)
+{
+    ToolBar()->CloseGraphicsConnection();
+
+    // This is a copy of the parent, forget the parent's jobs.
+    sJobc *jc = OP.jobc();
+    jc->jc_jobs = 0;
+    jc->jc_servers = 0;
+    jc->jc_complete_list = 0;
+    jc->jc_numchanged = 0;
+    jc->jc_pool = 0;
+    jc->jc_pool_queue = 0;
+
+    Sp.SetFlag(FT_SERVERMODE, true);
+    Sp.SetFlag(FT_BATCHMODE, true);
+    CP.SetFlag(CP_INTERACTIVE, false);
+    TTY.setmore(false);
+    if (!freopen("/dev/null", "r", stdin))
+        _exit(EXIT_BAD);
+
+    FILE *fp = fdopen(fd, "r");
+    if (!fp)
+        _exit(EXIT_BAD);
+
+    // Save the shell variables and output settings.  These are
+    // restored before each job, so that a job is not affected by
+    // anything set by earlier jobs run in this worker.
+    variable *vars = 0, *ve = 0;
+    wordlist *wl0 = CP.VarList();
+    for (wordlist *wl = wl0; wl; wl = wl->wl_next) {
+        variable *v = CP.RawVarGet(wl->wl_word);
+        if (!v)
+            continue;
+        v = variable::copy(v);
+        if (!vars)
+            vars = ve = v;
+        else {
+            ve->set_next(v);
+            ve = v;
+        }
+    }
+    wordlist::destroy(wl0);
+    IFoutfile *od = OP.getOutDesc();
+    OutFtype ftype = od->outFtype();
+    int ndgts = od->outNdgts();
+    bool binary = od->outBinary();
+
+    char idbuf[64], deck[BSIZE_SP], raw[BSIZE_SP], out[BSIZE_SP];
+    for (;;) {
+        if (!fgets(idbuf, sizeof(idbuf), fp) ||
+                !fgets(deck, BSIZE_SP, fp) ||
+                !fgets(raw, BSIZE_SP, fp) ||
+                !fgets(out, BSIZE_SP, fp)) {
+            // Parent closed the connection.
+            _exit(EXIT_NORMAL);
+        }
+        int id = atoi(idbuf);
+        char *t;
+        if ((t = strchr(deck, '\n')) != 0)
+            *t = 0;
+        if ((t = strchr(raw, '\n')) != 0)
+            *t = 0;
+        if ((t = strchr(out, '\n')) != 0)
+            *t = 0;
+
+        int status = EXIT_NORMAL;
+        if (!freopen(out, "w", stdout))
+            status = EXIT_BAD;
+        else {
+            dup2(fileno(stdout), fileno(stderr));
+            reset_vars(vars);
+            od->set_outFtype(ftype);
+            od->set_outNdgts(ndgts);
+            od->set_outBinary(binary);
+            od->set_outFile(raw);
+            Sp.SetVar(kw_rawfile, raw);
+
+            FILE *dfp = fopen(deck, "r");
+            if (!dfp) {
+                perror(deck);
+                status = EXIT_BAD;
+            }
+            else {
+                try {
+                    Sp.SpSource(dfp, false, false, deck);
+                    sFtCirc *cir = Sp.CurCircuit();
+                    if (cir) {
+                        if (!cir->runonce())
+                            Sp.Run(OP.getOutDesc()->outFile());
+                        delete cir;
+                    }
+                }
+                catch (int) {
+                    status = EXIT_BAD;
+                }
+                fclose(dfp);
+            }
+            // Free the plots from the job.
+            OP.removePlot("all");
+            OP.vecGc();
+            fflush(stdout);
+            fflush(stderr);
+        }
+
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%d %d\n", id, status);
+        int len = strlen(buf);
+        if (send(fd, buf, len, POOL_SEND_FLAGS) != len)
+            _exit(EXIT_BAD);
+    }
+}
+
+
+// Static function.
+// Worker process state change.  The job status is returned through
+// the socket, or the socket is closed if the worker dies, which is
+// handled in pool_check.
+//
+void
+sJobc::pool_sigchild(int pid, int status, void*)
+{
+    if (Sp.GetFlag(FT_ASYNCDB)) {
+        if (WIFEXITED(status)) {
+            GRpkgIf()->ErrPrintf(ET_MSG,
+                "pool worker %d exited with status %d.\n",
+                pid, WEXITSTATUS(status));
+        }
+        else if (WIFSIGNALED(status)) {
+            GRpkgIf()->ErrPrintf(ET_MSG,
+                "pool worker %d terminated by signal %d.\n",
+                pid, WTERMSIG(status));
+        }
+    }
+}
+
 #endif
 // End of sJobc functions.
 
@@ -66,6 +66,7 @@ Authors: 1986 Wayne A. Christopher
 #include <fcntl.h>
 #include <signal.h>
 #include <dirent.h>
+#include <sys/stat.h>
 #ifdef WIN32
 #include <windows.h>
 #include <libiberty.h>  // provides vasprintf
@@ -108,7 +109,52 @@ namespace {
             const IFdevice *device;
         };
 
-        sMdb() { m_tab = 0; }
+        // A module listed in a module directory index file.  These
+        // are registered at startup without loading, the module is
+        // loaded when a .model line first references it.
+        //
+        struct dmdb_t
+        {
+            dmdb_t()
+                {
+                    next = 0;
+                    path = 0;
+                    line = 0;
+                    module = 0;
+                    modkeys = 0;
+                    keys = 0;
+                    mtime = 0;
+                    size = 0;
+                    memset(levels, 0, NUM_DEV_LEVELS);
+                }
+
+            ~dmdb_t()
+                {
+                    delete [] path;
+                    delete [] line;
+                    delete [] module;
+                    delete [] keys;
+                    wordlist::destroy(modkeys);
+                }
+
+            bool match(const char*, const char*) const;
+
+            dmdb_t *next;
+            char *path;         // full path to module
+            char *line;         // the index file line
+            char *module;       // module name, if any
+            wordlist *modkeys;  // model type names
+            char *keys;         // key:mintrm:maxtrm:ndevs,...
+            long mtime;         // file modification time
+            long size;          // file size
+            unsigned char levels[NUM_DEV_LEVELS];
+        };
+
+        sMdb()
+            {
+                m_tab = 0;
+                m_deferred = 0;
+            }
 
         bool add_module(const char*, void*, NewDevFunc);
         bool rem_module(const char*);
@@ -116,9 +162,16 @@ namespace {
         void list_modules();
         void check();
 
+        void add_deferred(dmdb_t*);
+        bool load_deferred(const char*, const char*);
+        void load_deferred_all();
+        void deferred_refs(int, int*, int*, int*, bool*);
+        void write_index(const char*, const char*);
+
     private:
 
         sHtab *m_tab;
+        dmdb_t *m_deferred;
     };
     sMdb DevmodDB;
 
@@ -202,7 +255,7 @@ namespace {
     sMdb::list_modules()
     {
         wordlist *wl = sHtab::wl(m_tab);
-        if (!wl) {
+        if (!wl && !m_deferred) {
             TTY.printf("No device modules loaded.\n");
             return;
         }
@@ -220,6 +273,27 @@ namespace {
         for (wordlist *w = wl; w; w = w->wl_next)
             TTY.printf("    %s\n", w->wl_word);
         TTY.printf("\n");
+        wordlist::destroy(wl);
+
+        if (m_deferred) {
+            wl = 0;
+            wordlist *we = 0;
+            for (dmdb_t *d = m_deferred; d; d = d->next) {
+                if (!we)
+                    we = wl = new wordlist(lstring::strip_path(d->path), 0);
+                else {
+                    we->wl_next = new wordlist(lstring::strip_path(d->path),
+                        we);
+                    we = we->wl_next;
+                }
+            }
+            wordlist::sort(wl);
+            TTY.printf("Device modules available, loaded when referenced:\n");
+            for (wordlist *w = wl; w; w = w->wl_next)
+                TTY.printf("    %s\n", w->wl_word);
+            TTY.printf("\n");
+            wordlist::destroy(wl);
+        }
     }
 
 
@@ -278,6 +352,220 @@ start_again:
             }
         }
     }
+
+
+    // Add a module from an index file to the deferred list.  If a
+    // module from the same path is already loaded or listed, the new
+    // entry is ignored.
+    //
+    void
+    sMdb::add_deferred(dmdb_t *dm)
+    {
+        if (!dm)
+            return;
+        if (sHtab::get(m_tab, dm->path)) {
+            delete dm;
+            return;
+        }
+        for (dmdb_t *d = m_deferred; d; d = d->next) {
+            if (!strcmp(d->path, dm->path)) {
+                delete dm;
+                return;
+            }
+        }
+        dm->next = m_deferred;
+        m_deferred = dm;
+    }
+
+
+    // Load the deferred modules that provide the model type name mkey. 
+    // The .model line is passed to find the level, if the line is
+    // null, the level is ignored.  Return true if a module was loaded.
+    //
+    bool
+    sMdb::load_deferred(const char *mkey, const char *line)
+    {
+        if (!mkey || !m_deferred)
+            return (false);
+        bool found = false;
+        dmdb_t *dp = 0, *dn;
+        for (dmdb_t *d = m_deferred; d; d = dn) {
+            dn = d->next;
+            if (!d->match(mkey, line)) {
+                dp = d;
+                continue;
+            }
+            if (dp)
+                dp->next = dn;
+            else
+                m_deferred = dn;
+            Sp.LoadModules(d->path);
+            delete d;
+            found = true;
+        }
+        return (found);
+    }
+
+
+    // Load all deferred modules.
+    //
+    void
+    sMdb::load_deferred_all()
+    {
+        while (m_deferred) {
+            dmdb_t *d = m_deferred;
+            m_deferred = d->next;
+            Sp.LoadModules(d->path);
+            delete d;
+        }
+    }
+
+
+    // Merge the terminal counts of deferred devices with key c into
+    // the values passed, as in SPinput::numRefs.
+    //
+    void
+    sMdb::deferred_refs(int c, int *nmin, int *nmax, int *ndevs, bool *mod)
+    {
+        if (isupper(c))
+            c = tolower(c);
+        for (dmdb_t *d = m_deferred; d; d = d->next) {
+            const char *s = d->keys;
+            while (s && *s) {
+                char k;
+                int mn, mx, nd;
+                if (sscanf(s, "%c:%d:%d:%d", &k, &mn, &mx, &nd) == 4) {
+                    if (isupper(k))
+                        k = tolower(k);
+                    if (k == c) {
+                        if (mn < *nmin)
+                            *nmin = mn;
+                        if (mx > *nmax)
+                            *nmax = mx;
+                        if (nd > *ndevs)
+                            *ndevs = nd;
+                        if (d->modkeys)
+                            *mod = true;
+                    }
+                }
+                s = strchr(s, ',');
+                if (s)
+                    s++;
+            }
+        }
+    }
+
+
+    // Write an index file for the modules in directory dir.  This
+    // lists the loaded and deferred modules from the directory, and is
+    // read on the next startup.  Failure is silent, the directory may
+    // not be writable.  The index is written to a temporary file which
+    // then replaces the index, so that another process never reads a
+    // partial index.
+    //
+    void
+    sMdb::write_index(const char *dir, const char *fname)
+    {
+        char *ipath = pathlist::mk_path(dir, fname);
+        char *tpath = new char[strlen(ipath) + 16];
+        sprintf(tpath, "%s.%d", ipath, (int)getpid());
+        FILE *fp = fopen(tpath, "w");
+        if (!fp) {
+            delete [] tpath;
+            delete [] ipath;
+            return;
+        }
+        char *dpath = new char[strlen(dir) + 2];
+        char *t = lstring::stpcpy(dpath, dir);
+        if (t > dpath && !lstring::is_dirsep(*(t-1)))
+            *t++ = '/';
+        *t = 0;
+        int dlen = t - dpath;
+        fprintf(fp, "# WRspice device module index %s\n",
+            Global.DevlibVersion());
+
+        for (dmdb_t *d = m_deferred; d; d = d->next) {
+            if (!strncmp(d->path, dpath, dlen) &&
+                    !lstring::strdirsep(d->path + dlen))
+                fprintf(fp, "%s\n", d->line);
+        }
+
+        sHgen gen(m_tab);
+        sHent *h;
+        while ((h = gen.next()) != 0) {
+            mdb_t *m = (mdb_t*)h->data();
+            if (strncmp(m->path, dpath, dlen) ||
+                    lstring::strdirsep(m->path + dlen))
+                continue;
+            struct stat st;
+            if (stat(m->path, &st) < 0)
+                continue;
+            const IFdevice *dv = m->device;
+            fprintf(fp, "%s %ld %ld ", m->path + dlen, (long)st.st_mtime,
+                (long)st.st_size);
+            for (int i = 0; dv->key(i); i++) {
+                const IFkeys *k = dv->key(i);
+                fprintf(fp, "%s%c:%d:%d:%d", i ? "," : "", k->key,
+                    k->minTerms, k->maxTerms, k->numDevs);
+            }
+            if (!dv->key(0))
+                fputs("-", fp);
+            fputs(" ", fp);
+            for (int i = 0; dv->modelKey(i); i++)
+                fprintf(fp, "%s%s", i ? "," : "", dv->modelKey(i));
+            if (!dv->modelKey(0))
+                fputs("-", fp);
+            fputs(" ", fp);
+            for (int i = 0; dv->level(i); i++)
+                fprintf(fp, "%s%d", i ? "," : "", dv->level(i));
+            if (!dv->level(0))
+                fputs("-", fp);
+            fprintf(fp, " %s\n", dv->module() ? dv->module() : "-");
+        }
+        bool ok = !ferror(fp);
+        if (fclose(fp))
+            ok = false;
+        if (ok) {
+#ifdef WIN32
+            ok = filestat::move_file_local(ipath, tpath);
+#else
+            ok = !rename(tpath, ipath);
+#endif
+        }
+        if (!ok)
+            unlink(tpath);
+        delete [] tpath;
+        delete [] ipath;
+        delete [] dpath;
+    }
+
+
+    // Return true if the model type name matches, and the level given
+    // on the .model line matches, if line is not null.
+    //
+    bool
+    sMdb::dmdb_t::match(const char *mkey, const char *ln) const
+    {
+        if (module && !strcasecmp(module, mkey))
+            return (true);
+        for (wordlist *w = modkeys; w; w = w->wl_next) {
+            if (strcasecmp(w->wl_word, mkey))
+                continue;
+            if (!ln)
+                return (true);
+            bool ismos = (keys && (*keys == 'm' || *keys == 'M'));
+            int lev;
+            IP.findLev(ln, &lev, ismos);
+            if (levels[0] <= 1 && lev <= 1)
+                return (true);
+            for (int k = 0; k < NUM_DEV_LEVELS && levels[k]; k++) {
+                if (levels[k] == lev)
+                    return (true);
+            }
+            return (false);
+        }
+        return (false);
+    }
 }
 
 
@@ -286,7 +574,8 @@ start_again:
 //
 // The argument can be a directory path, in which case all modules
 // found in the directory will be loaded.  It can also be "all" in
-// which case known modules are loaded, as at program startup.
+// which case known modules are loaded, as at program startup, and
+// modules registered from an index file are loaded as well.
 //
 void
 CommandTab::com_devload(wordlist *wl)
@@ -831,7 +1120,113 @@ IFsimulator::CheckDevlib()
 
 namespace {
 
-    // Load modules found in the passed directory path.
+    // Name of the index file in module directories.
+    const char *mod_index = "modules.idx";
+
+
+    // Read the index file in the module directory, if any.  Return a
+    // table of the entries, keyed by the module file name.  An index
+    // file from a different release is ignored.
+    //
+    sHtab *read_index(const char *mpath)
+    {
+        char *ipath = pathlist::mk_path(mpath, mod_index);
+        FILE *fp = fopen(ipath, "r");
+        delete [] ipath;
+        if (!fp)
+            return (0);
+
+        sHtab *tab = 0;
+        char buf[1024];
+        bool first = true;
+        while (fgets(buf, 1024, fp) != 0) {
+            char *e = buf + strlen(buf) - 1;
+            while (e >= buf && isspace(*e))
+                *e-- = 0;
+            if (first) {
+                first = false;
+                const char *v = strrchr(buf, ' ');
+                if (*buf != '#' || !v ||
+                        !lstring::eq(v+1, Global.DevlibVersion()))
+                    break;
+                continue;
+            }
+            if (*buf == '#' || !*buf)
+                continue;
+
+            const char *s = buf;
+            char *name = lstring::gettok(&s);
+            char *tmt = lstring::gettok(&s);
+            char *tsz = lstring::gettok(&s);
+            char *keys = lstring::gettok(&s);
+            char *mkeys = lstring::gettok(&s);
+            char *levs = lstring::gettok(&s);
+            char *mname = lstring::gettok(&s);
+            if (mname) {
+                sMdb::dmdb_t *dm = new sMdb::dmdb_t;
+                dm->line = lstring::copy(buf);
+                dm->mtime = atol(tmt);
+                dm->size = atol(tsz);
+                if (strcmp(keys, "-")) {
+                    dm->keys = keys;
+                    keys = 0;
+                }
+                if (strcmp(mkeys, "-")) {
+                    const char *t = mkeys;
+                    wordlist *we = 0;
+                    char *tok;
+                    while ((tok = lstring::gettok(&t, ",")) != 0) {
+                        if (!we)
+                            we = dm->modkeys = new wordlist(tok, 0);
+                        else {
+                            we->wl_next = new wordlist(tok, we);
+                            we = we->wl_next;
+                        }
+                        delete [] tok;
+                    }
+                }
+                if (strcmp(levs, "-")) {
+                    const char *t = levs;
+                    char *tok;
+                    int i = 0;
+                    while ((tok = lstring::gettok(&t, ",")) != 0) {
+                        if (i < NUM_DEV_LEVELS)
+                            dm->levels[i++] = atoi(tok);
+                        delete [] tok;
+                    }
+                }
+                if (strcmp(mname, "-"))
+                    dm->module = lstring::copy(mname);
+                if (!tab)
+                    tab = new sHtab(false);
+                sMdb::dmdb_t *dx = (sMdb::dmdb_t*)tab->remove(name);
+                delete dx;
+                tab->add(name, dm);
+            }
+            delete [] name;
+            delete [] tmt;
+            delete [] tsz;
+            delete [] keys;
+            delete [] mkeys;
+            delete [] levs;
+            delete [] mname;
+        }
+        fclose(fp);
+        return (tab);
+    }
+
+
+    void free_index_ent(void *data, void*)
+    {
+        delete (sMdb::dmdb_t*)data;
+    }
+
+
+    // Load modules found in the passed directory path.  If the
+    // directory contains an up to date index file, the modules listed
+    // there are registered, but not loaded until referenced from a
+    // .model line.  The index file is (re)written if possible when
+    // modules are loaded, so that this is the usual case.
     //
     void load_modules(const char *mpath)
     {
@@ -855,6 +1250,9 @@ namespace {
 #endif
 #endif
 
+        sHtab *itab = read_index(mpath);
+        bool stale = false;
+
         struct dirent *de;
         while ((de = readdir(wdir)) != 0) {
             char *name = de->d_name;
@@ -866,10 +1264,38 @@ namespace {
             if (!dsfx || !lstring::cieq(dsfx+1, sfx))
                 continue;
             strcpy(t, de->d_name);
+
+            sMdb::dmdb_t *dm =
+                itab ? (sMdb::dmdb_t*)itab->remove(de->d_name) : 0;
+            if (dm) {
+                struct stat st;
+                // A module must have a model or module name to be
+                // referenced from a .model line, load it now if not.
+                if ((dm->modkeys || dm->module) &&
+                        stat(filepath, &st) == 0 &&
+                        (long)st.st_mtime == dm->mtime &&
+                        (long)st.st_size == dm->size) {
+                    dm->path = lstring::copy(filepath);
+                    DevmodDB.add_deferred(dm);
+                    continue;
+                }
+                delete dm;
+            }
             Sp.LoadModules(filepath);
+            stale = true;
         }
         delete [] filepath;
         closedir(wdir);
+
+        if (itab) {
+            // Entries remaining are for modules that no longer exist.
+            if (!sHtab::empty(itab))
+                stale = true;
+            itab->clear_data(free_index_ent, 0);
+            delete itab;
+        }
+        if (stale)
+            DevmodDB.write_index(mpath, mod_index);
     }
 }
 
@@ -884,6 +1310,7 @@ IFsimulator::LoadModules(const char *str)
     // This is normally done on program startup.
     if (lstring::cieq(str, "all")) {
         LoadModules(0);
+        DevmodDB.load_deferred_all();
         return;
     }
     char *path = lstring::getqtok(&str);
@@ -1055,6 +1482,29 @@ IFsimulator::LoadModules(const char *str)
 }
 
 
+// Load any modules, registered but not yet loaded, that provide the
+// model type name mkey.  The line is the .model line, used to find
+// the level.  If null, levels are ignored.
+//
+void
+IFsimulator::LoadDeferredModules(const char *mkey, const char *line)
+{
+    DevmodDB.load_deferred(mkey, line);
+}
+
+
+// Merge the terminal counts for not yet loaded modules with device
+// key c into the passed values.  The device parser needs these before
+// the models are known.
+//
+void
+IFsimulator::DeferredModuleRefs(int c, int *nmin, int *nmax, int *ndevs,
+    bool *hasmod)
+{
+    DevmodDB.deferred_refs(c, nmin, nmax, ndevs, hasmod);
+}
+
+
 // Display various device parameters.  The input syntax is
 //   [devicelist] [, parmlist]
 // where devicelist can be "all", device names, or glob-matched subnames
@@ -57,9 +57,15 @@ Authors: 1985 Wayne A. Christopher
 #include "ttyio.h"
 #include "circuit.h"
 #include "ginterf/graphics.h"
+#include "kwords_analysis.h"
+#ifdef WITH_THREADS
+#include "miscutil/threadpool.h"
+#endif
 
 
 namespace {
+    bool fx_fusable(const pnode*);
+    sDataVec *fx_evaluate(pnode*);
     sDataVec *op_range(pnode*, pnode*);
     sDataVec *op_ind(pnode*, pnode*);
     sDataVec *evfunc(sDataVec**, sFunc*);
@@ -141,6 +147,8 @@ IFsimulator::Evaluate(pnode *node)
             }
         }
     }
+    else if (fx_fusable(node))
+        d = fx_evaluate(node);
     else if (node->func())
         d = node->apply_func();
     else if (node->oper())
@@ -972,3 +980,729 @@ namespace {
     }
 }
 
+
+
+//
+// Fused evaluation of element-wise expressions.
+//
+// An expression such as db(v(out)/v(in)) would ordinarily allocate a
+// full-length temporary vector for each operator and function.  When
+// the tree contains a chain of the simple element-wise operations
+// below, the chain is instead evaluated in a single pass over blocks
+// of the data, only the result vector is allocated, and vector
+// references are read in place rather than copied.  Large vectors
+// are split among threads when loadthrds is set.
+//
+// The result, including the name, units, dimensions, and scale, is
+// the same as the operator-by-operator evaluation.  If anything
+// unusual happens (wildcard vectors, out-of-range arguments) we fall
+// back to the normal evaluation so that the diagnostics are
+// unchanged.
+//
+
+namespace {
+    // Block size for the fused evaluation.  The per-node block
+    // buffers should remain cache-resident.
+#define FX_BLOCK 512
+
+    // Vector length above which the evaluation is multi-threaded.
+#define FX_THREADLEN 65536
+
+    // As in cmath1.cc.
+#define FX_HUGENUM  1.0e+300
+
+    enum FXop
+    {
+        FX_LEAF,
+        FX_PLUS,
+        FX_MINUS,
+        FX_TIMES,
+        FX_DIVIDE,
+        FX_UMINUS,
+        FX_MAG,
+        FX_DB,
+        FX_REAL,
+        FX_IMAG
+    };
+
+
+    // Return the fused operation code for the node, or FX_LEAF if
+    // the node is not fusable.
+    //
+    FXop fx_opcode(const pnode *node)
+    {
+        if (node->value() || node->token_string())
+            return (FX_LEAF);
+        if (node->func()) {
+            sFunc *f = node->func();
+            if (!f->func() || f->argc() != 1 || !node->left())
+                return (FX_LEAF);
+            if (f->func() == &sDataVec::v_uminus)
+                return (FX_UMINUS);
+            if (f->func() == &sDataVec::v_mag)
+                return (FX_MAG);
+            if (f->func() == &sDataVec::v_db)
+                return (FX_DB);
+            if (f->func() == &sDataVec::v_real)
+                return (FX_REAL);
+            if (f->func() == &sDataVec::v_imag)
+                return (FX_IMAG);
+            return (FX_LEAF);
+        }
+        if (node->oper() && node->left() && node->right()) {
+            switch (node->optype()) {
+            case TT_PLUS:
+                return (FX_PLUS);
+            case TT_MINUS:
+                return (FX_MINUS);
+            case TT_TIMES:
+                return (FX_TIMES);
+            case TT_DIVIDE:
+                return (FX_DIVIDE);
+            default:
+                break;
+            }
+        }
+        return (FX_LEAF);
+    }
+
+
+    // Return the number of fusable nodes in the subtree, stop
+    // counting at two.
+    //
+    int fx_count(const pnode *node, int cnt)
+    {
+        FXop op = fx_opcode(node);
+        if (op == FX_LEAF)
+            return (cnt);
+        cnt++;
+        if (cnt < 2)
+            cnt = fx_count(node->left(), cnt);
+        if (cnt < 2 && op <= FX_DIVIDE)
+            cnt = fx_count(node->right(), cnt);
+        return (cnt);
+    }
+
+
+    // Fusion is only worthwhile if at least one temporary would be
+    // saved.
+    //
+    bool fx_fusable(const pnode *node)
+    {
+        return (fx_opcode(node) != FX_LEAF && fx_count(node, 0) >= 2);
+    }
+
+
+    // A node of the fused expression.  These carry the attributes
+    // that the normal evaluation would have given the intermediate
+    // vectors.
+    //
+    struct fx_node
+    {
+        fx_node(pnode *p, FXop o, int i)
+            {
+                pn = p;
+                op = o;
+                id = i;
+                lft = 0;
+                rgt = 0;
+                vec = 0;
+                name = 0;
+                flags = 0;
+                length = 0;
+                numdims = 0;
+                memset(dims, 0, sizeof(dims));
+                scale = 0;
+                plot = 0;
+                defcolor = 0;
+                gridtype = GRID_LIN;
+                plottype = PLOT_LIN;
+            }
+
+        ~fx_node()
+            {
+                delete lft;
+                delete rgt;
+                delete [] name;
+            }
+
+        bool iscomplex()    const { return (flags & VF_COMPLEX); }
+
+        pnode *pn;              // Parse node.
+        FXop op;                // Operation.
+        int id;                 // Index into workspace.
+        fx_node *lft;           // Left operand or function argument.
+        fx_node *rgt;           // Right operand.
+        sDataVec *vec;          // Data, leaf nodes only.
+        char *name;             // Vector name.
+        sUnits units;           // Vector units.
+        int flags;              // Vector flags, VF_COPYMASK only.
+        int length;             // Vector length.
+        int numdims;            // Dimensions.
+        int dims[MAXDIMS];
+        sDataVec *scale;        // Scale vector.
+        sPlot *plot;            // Plot.
+        const char *defcolor;   // Misc. attributes from vector.
+        GridType gridtype;
+        PlotType plottype;
+    };
+
+
+    // Per-thread block storage.
+    //
+    struct fx_ws
+    {
+        fx_ws(int n)
+            {
+                rbuf = new double[n*FX_BLOCK];
+                cbuf = new complex[n*FX_BLOCK];
+                rp = new const double*[n];
+                cp = new const complex*[n];
+            }
+
+        ~fx_ws()
+            {
+                delete [] rbuf;
+                delete [] cbuf;
+                delete [] rp;
+                delete [] cp;
+            }
+
+        double *rbuf;           // Real block buffers, per node.
+        complex *cbuf;          // Complex block buffers, per node.
+        const double **rp;      // Current real block, per node.
+        const complex **cp;     // Current complex block, per node.
+    };
+
+
+    // Return values from fx_build.
+    enum FXret { FX_OK, FX_FAIL, FX_RETRY };
+
+
+    // Recursively build the fused tree, evaluating the leaves.  Error
+    // messages are those that the normal evaluation would produce.
+    //
+    FXret fx_build(pnode *node, int *cnt, fx_node **pfx)
+    {
+        *pfx = 0;
+        FXop op = fx_opcode(node);
+        fx_node *fx = new fx_node(node, op, (*cnt)++);
+        *pfx = fx;
+
+        if (op == FX_LEAF) {
+            sDataVec *d = 0;
+            if (node->token_string() && !node->value() &&
+                    node->type() != PN_TRAN) {
+                // A plain vector reference, use the data in place.
+                d = OP.vecGet(node->token_string(),
+                    Sp.CurCircuit() ? Sp.CurCircuit()->runckt() : 0);
+                if (!d) {
+                    if (!node->name() || !lstring::cieq(node->name(), "vs"))
+                        Sp.Error(E_NOVEC, 0, node->token_string());
+                    return (FX_FAIL);
+                }
+                if (d->link())
+                    return (FX_RETRY);
+                if (!d->length()) {
+                    Sp.Error(E_NOVEC, 0, (node->name() &&
+                        !Sp.GetFlag(FT_EVDB)) ? node->name() : d->name());
+                    return (FX_FAIL);
+                }
+                fx->vec = d;
+                fx->name = lstring::copy(d->name());
+                fx->flags = d->flags() & VF_COPYMASK;
+            }
+            else {
+                d = Sp.Evaluate(node);
+                if (!d)
+                    return (FX_FAIL);
+                if (d->link())
+                    return (FX_RETRY);
+                fx->vec = d;
+                fx->name = lstring::copy(d->name());
+                fx->flags = d->flags() & VF_COPYMASK;
+            }
+            fx->units = *d->units();
+            fx->length = d->length();
+            fx->numdims = d->numdims();
+            for (int i = 0; i < fx->numdims; i++)
+                fx->dims[i] = d->dims(i);
+            fx->scale = d->scale();
+            fx->plot = d->plot() ? d->plot() : OP.curPlot();
+            fx->defcolor = d->defcolor();
+            fx->gridtype = d->gridtype();
+            fx->plottype = d->plottype();
+        }
+        else if (op <= FX_DIVIDE) {
+            FXret ret = fx_build(node->left(), cnt, &fx->lft);
+            if (ret == FX_FAIL) {
+                char *s = node->left()->get_string();
+                GRpkgIf()->ErrPrintf(ET_ERROR, "\"%s\"  evaluation failed.\n",
+                    s);
+                delete [] s;
+            }
+            if (ret != FX_OK)
+                return (ret);
+            ret = fx_build(node->right(), cnt, &fx->rgt);
+            if (ret == FX_FAIL) {
+                char *s = node->right()->get_string();
+                GRpkgIf()->ErrPrintf(ET_ERROR, "\"%s\", evaluation failed.\n",
+                    s);
+                delete [] s;
+            }
+            if (ret != FX_OK)
+                return (ret);
+
+            // As in pnode::apply_bop.
+            fx_node *v1 = fx->lft;
+            fx_node *v2 = fx->rgt;
+            fx->length = v1->length > v2->length ? v1->length : v2->length;
+            fx->flags = v1->flags | v2->flags;
+            fx->units = v1->units;
+            if (op == FX_PLUS || op == FX_MINUS) {
+                if (!(fx->units == v2->units))
+                    fx->units.set(UU_NOTYPE);
+            }
+            else if (op == FX_TIMES)
+                fx->units*v2->units;
+            else
+                fx->units/v2->units;
+
+            const char *opname = node->oper()->name();
+            fx->name = new char[strlen(v1->name) + strlen(v2->name) +
+                strlen(opname) + 5];
+            sprintf(fx->name, "(%s)%s(%s)", v1->name, opname, v2->name);
+
+            fx_node *vd = v1->numdims >= v2->numdims ? v1 : v2;
+            fx->numdims = vd->numdims;
+            for (int i = 0; i < fx->numdims; i++)
+                fx->dims[i] = vd->dims[i];
+            if (fx->length > 1) {
+                sDataVec *sc = v1->scale;
+                if (!sc && vd->plot && vd->plot != OP.curPlot())
+                    sc = vd->plot->scale();
+                if (sc && sc->length() == fx->length && sc->isreal())
+                    fx->scale = sc;
+            }
+            fx->plot = OP.curPlot();
+            fx->defcolor = v1->defcolor;
+            fx->gridtype = v1->gridtype;
+            fx->plottype = v1->plottype;
+        }
+        else {
+            FXret ret = fx_build(node->left(), cnt, &fx->lft);
+            if (ret == FX_FAIL) {
+                GRpkgIf()->ErrPrintf(ET_ERROR, "bad argument to %s.\n",
+                    node->func()->name());
+            }
+            if (ret != FX_OK)
+                return (ret);
+
+            // As in pnode::apply_func and evfunc.
+            fx_node *v0 = fx->lft;
+            fx->length = v0->length;
+            if (op == FX_UMINUS)
+                fx->flags = v0->flags & VF_COMPLEX;
+            if (op != FX_DB)
+                fx->units = v0->units;
+
+            const char *fname = node->func()->name();
+            fx->name = new char[strlen(fname) + strlen(v0->name) + 3];
+            sprintf(fx->name, "%s(%s)", fname, v0->name);
+
+            fx->numdims = v0->numdims;
+            for (int i = 0; i < fx->numdims; i++)
+                fx->dims[i] = v0->dims[i];
+            fx->scale = v0->scale;
+            if (!fx->scale && fx->length > 1) {
+                sDataVec *sc = 0;
+                if (v0->plot && v0->plot != OP.curPlot())
+                    sc = v0->plot->scale();
+                if (sc && sc->length() == fx->length && sc->isreal())
+                    fx->scale = sc;
+            }
+            fx->plot = OP.curPlot();
+            fx->defcolor = v0->defcolor;
+            fx->gridtype = v0->gridtype;
+            fx->plottype = v0->plottype;
+        }
+
+        // As in IFsimulator::Evaluate.
+        if (node->name() && !Sp.GetFlag(FT_EVDB)) {
+            delete [] fx->name;
+            fx->name = lstring::copy(node->name());
+        }
+        return (FX_OK);
+    }
+
+
+    // Evaluate cnt values of the node starting at offset i0, leaving
+    // the result pointer in the workspace.  Short vectors are padded
+    // with the last value, as in sDataVec::pad.  Return false if an
+    // argument is out of range.
+    //
+    bool fx_block(const fx_node *fx, fx_ws *ws, int i0, int cnt)
+    {
+        int id = fx->id;
+        double *outr = ws->rbuf + id*FX_BLOCK;
+        complex *outc = ws->cbuf + id*FX_BLOCK;
+
+        if (fx->op == FX_LEAF) {
+            sDataVec *d = fx->vec;
+            int len = fx->length;
+            if (i0 + cnt <= len) {
+                if (fx->iscomplex())
+                    ws->cp[id] = d->compvec() + i0;
+                else
+                    ws->rp[id] = d->realvec() + i0;
+                return (true);
+            }
+            if (fx->iscomplex()) {
+                const complex *src = d->compvec();
+                for (int i = 0; i < cnt; i++) {
+                    int j = i0 + i;
+                    outc[i] = src[j < len ? j : len - 1];
+                }
+                ws->cp[id] = outc;
+            }
+            else {
+                const double *src = d->realvec();
+                for (int i = 0; i < cnt; i++) {
+                    int j = i0 + i;
+                    outr[i] = src[j < len ? j : len - 1];
+                }
+                ws->rp[id] = outr;
+            }
+            return (true);
+        }
+
+        if (!fx_block(fx->lft, ws, i0, cnt))
+            return (false);
+        if (fx->rgt && !fx_block(fx->rgt, ws, i0, cnt))
+            return (false);
+
+        bool cx1 = fx->lft->iscomplex();
+        const double *d1 = ws->rp[fx->lft->id];
+        const complex *c1 = ws->cp[fx->lft->id];
+        bool cx2 = false;
+        const double *d2 = 0;
+        const complex *c2 = 0;
+        if (fx->rgt) {
+            cx2 = fx->rgt->iscomplex();
+            d2 = ws->rp[fx->rgt->id];
+            c2 = ws->cp[fx->rgt->id];
+        }
+        if (fx->iscomplex())
+            ws->cp[id] = outc;
+        else
+            ws->rp[id] = outr;
+
+        // The arithmetic below matches the cmath1.cc and cmath2.cc
+        // functions exactly.
+
+        switch (fx->op) {
+        case FX_PLUS:
+            if (cx1 && cx2) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = c1[i].real + c2[i].real;
+                    outc[i].imag = c1[i].imag + c2[i].imag;
+                }
+            }
+            else if (cx1) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = c1[i].real + d2[i];
+                    outc[i].imag = c1[i].imag;
+                }
+            }
+            else if (cx2) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = d1[i] + c2[i].real;
+                    outc[i].imag = c2[i].imag;
+                }
+            }
+            else {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = d1[i] + d2[i];
+            }
+            break;
+        case FX_MINUS:
+            if (cx1 && cx2) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = c1[i].real - c2[i].real;
+                    outc[i].imag = c1[i].imag - c2[i].imag;
+                }
+            }
+            else if (cx1) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = c1[i].real - d2[i];
+                    outc[i].imag = c1[i].imag;
+                }
+            }
+            else if (cx2) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = d1[i] - c2[i].real;
+                    outc[i].imag = -c2[i].imag;
+                }
+            }
+            else {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = d1[i] - d2[i];
+            }
+            break;
+        case FX_TIMES:
+            if (cx1 && cx2) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = c1[i].real*c2[i].real -
+                        c1[i].imag*c2[i].imag;
+                    outc[i].imag = c1[i].imag*c2[i].real +
+                        c1[i].real*c2[i].imag;
+                }
+            }
+            else if (cx1) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = c1[i].real*d2[i];
+                    outc[i].imag = c1[i].imag*d2[i];
+                }
+            }
+            else if (cx2) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = d1[i]*c2[i].real;
+                    outc[i].imag = d1[i]*c2[i].imag;
+                }
+            }
+            else {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = d1[i]*d2[i];
+            }
+            break;
+        case FX_DIVIDE:
+            if (cx1 && cx2) {
+                for (int i = 0; i < cnt; i++) {
+                    double d = c2[i].real*c2[i].real + c2[i].imag*c2[i].imag;
+                    if (d == 0.0)
+                        return (false);
+                    outc[i].real = (c1[i].real*c2[i].real +
+                        c1[i].imag*c2[i].imag)/d;
+                    outc[i].imag = (c1[i].imag*c2[i].real -
+                        c2[i].imag*c1[i].real)/d;
+                }
+            }
+            else if (cx1) {
+                for (int i = 0; i < cnt; i++) {
+                    if (d2[i] == 0.0)
+                        return (false);
+                    outc[i].real = c1[i].real/d2[i];
+                    outc[i].imag = c1[i].imag/d2[i];
+                }
+            }
+            else if (cx2) {
+                for (int i = 0; i < cnt; i++) {
+                    double d = c2[i].real*c2[i].real + c2[i].imag*c2[i].imag;
+                    if (d == 0.0)
+                        return (false);
+                    d = d1[i]/d;
+                    outc[i].real = c2[i].real*d;
+                    outc[i].imag = -c2[i].imag*d;
+                }
+            }
+            else {
+                for (int i = 0; i < cnt; i++) {
+                    if (d2[i] == 0.0)
+                        return (false);
+                    outr[i] = d1[i]/d2[i];
+                }
+            }
+            break;
+        case FX_UMINUS:
+            if (cx1) {
+                for (int i = 0; i < cnt; i++) {
+                    outc[i].real = -c1[i].real;
+                    outc[i].imag = -c1[i].imag;
+                }
+            }
+            else {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = -d1[i];
+            }
+            break;
+        case FX_MAG:
+            if (cx1) {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = sqrt(c1[i].real*c1[i].real +
+                        c1[i].imag*c1[i].imag);
+            }
+            else {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = d1[i] < 0.0 ? -d1[i] : d1[i];
+            }
+            break;
+        case FX_DB:
+            for (int i = 0; i < cnt; i++) {
+                double tt;
+                if (cx1)
+                    tt = sqrt(c1[i].real*c1[i].real + c1[i].imag*c1[i].imag);
+                else
+                    tt = d1[i];
+                if (!(tt >= 0))
+                    return (false);
+                if (tt == 0.0)
+                    outr[i] = 20.0 * -log(FX_HUGENUM);
+                else
+                    outr[i] = 20.0 * log10(tt);
+            }
+            break;
+        case FX_REAL:
+            if (cx1) {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = c1[i].real;
+            }
+            else {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = d1[i];
+            }
+            break;
+        case FX_IMAG:
+            if (cx1) {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = c1[i].imag;
+            }
+            else {
+                for (int i = 0; i < cnt; i++)
+                    outr[i] = 0.0;
+            }
+            break;
+        default:
+            break;
+        }
+        return (true);
+    }
+
+
+    // Evaluate the range [start, end) of the result.
+    //
+    bool fx_range(const fx_node *fx, int nnodes, sDataVec *res, int start,
+        int end)
+    {
+        fx_ws ws(nnodes);
+        for (int i0 = start; i0 < end; i0 += FX_BLOCK) {
+            int cnt = end - i0;
+            if (cnt > FX_BLOCK)
+                cnt = FX_BLOCK;
+            if (!fx_block(fx, &ws, i0, cnt))
+                return (false);
+            if (fx->iscomplex())
+                memcpy(res->compvec() + i0, ws.cp[fx->id],
+                    cnt*sizeof(complex));
+            else
+                memcpy(res->realvec() + i0, ws.rp[fx->id],
+                    cnt*sizeof(double));
+        }
+        return (true);
+    }
+
+
+#ifdef WITH_THREADS
+    // Job for multi-threaded evaluation, one contiguous range.
+    //
+    struct sFxJob
+    {
+        sFxJob(const fx_node *f, int n, sDataVec *r, int s, int e)
+            {
+                fj_fx = f;
+                fj_nnodes = n;
+                fj_res = r;
+                fj_start = s;
+                fj_end = e;
+            }
+
+        const fx_node *fj_fx;
+        int fj_nnodes;
+        sDataVec *fj_res;
+        int fj_start;
+        int fj_end;
+    };
+
+
+    int fx_thread_proc(sTPthreadData*, void *arg)
+    {
+        sFxJob *j = (sFxJob*)arg;
+        return (!fx_range(j->fj_fx, j->fj_nnodes, j->fj_res, j->fj_start,
+            j->fj_end));
+    }
+
+
+    void fx_destroy_proc(void *arg)
+    {
+        delete (sFxJob*)arg;
+    }
+#endif
+
+
+    // Evaluate a fusable expression, the node should pass fx_fusable.
+    //
+    sDataVec *fx_evaluate(pnode *node)
+    {
+        int nnodes = 0;
+        fx_node *fx;
+        FXret ret = fx_build(node, &nnodes, &fx);
+        if (ret == FX_FAIL) {
+            delete fx;
+            return (0);
+        }
+        if (ret == FX_RETRY) {
+            delete fx;
+            return (node->func() ? node->apply_func() : node->apply_bop());
+        }
+
+        sDataVec *res = new sDataVec(0, fx->flags, fx->length, &fx->units);
+        bool ok = true;
+#ifdef WITH_THREADS
+        int nthreads = 0;
+        if (fx->length > FX_THREADLEN) {
+            VTvalue vv;
+            if (Sp.GetVar(spkw_loadthrds, VTYP_NUM, &vv))
+                nthreads = vv.get_int();
+            int maxthr = fx->length/FX_THREADLEN - 1;
+            if (nthreads > maxthr)
+                nthreads = maxthr;
+        }
+        if (nthreads > 0) {
+            cThreadPool pool(nthreads);
+            int njobs = nthreads + 1;
+            int chunk = (fx->length/njobs + FX_BLOCK - 1)/FX_BLOCK;
+            chunk *= FX_BLOCK;
+            for (int start = 0; start < fx->length; start += chunk) {
+                int end = start + chunk;
+                if (end > fx->length)
+                    end = fx->length;
+                pool.submit(fx_thread_proc,
+                    new sFxJob(fx, nnodes, res, start, end), fx_destroy_proc);
+            }
+            ok = !pool.run(0);
+        }
+        else
+#endif
+            ok = fx_range(fx, nnodes, res, 0, fx->length);
+
+        if (!ok) {
+            // An argument was out of range.  Let the normal evaluation
+            // find it and issue the usual messages.
+            delete res;
+            delete fx;
+            return (node->func() ? node->apply_func() : node->apply_bop());
+        }
+
+        res->set_name(fx->name);
+        res->set_numdims(fx->numdims);
+        for (int i = 0; i < fx->numdims; i++)
+            res->set_dims(i, fx->dims[i]);
+        res->set_scale(fx->scale);
+        res->set_defcolor(fx->defcolor);
+        res->set_gridtype(fx->gridtype);
+        res->set_plottype(fx->plottype);
+        res->newtemp();
+        delete fx;
+        return (res);
+    }
+}
+
@@ -389,8 +389,21 @@ IFsimulator::IsTrue(wordlist *wl)
     delete [] str;
     if (pn == 0)
         return (false);
-    sDataVec *v = Evaluate(pn);
+    bool ret = IsTrue(pn);
     delete pn;
+    return (ret);
+}
+
+
+// Evaluate the parse tree, and return true if nonzero.  The tree is
+// not freed.
+//
+bool
+IFsimulator::IsTrue(pnode *pn)
+{
+    sDataVec *v = Evaluate(pn);
+    if (!v)
+        return (false);
 
     if (v->link()) {
         // It makes no sense to say while (all), but what the heck...
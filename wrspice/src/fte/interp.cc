@@ -47,9 +47,15 @@ Authors: 1985 Wayne A. Christopher
 
 #include <math.h>
 #include <string.h>
+#include "simulator.h"
 #include "datavec.h"
 #include "ttyio.h"
+#include "circuit.h"
+#include "kwords_analysis.h"
 #include "ginterf/graphics.h"
+#ifdef WITH_THREADS
+#include "miscutil/threadpool.h"
+#endif
 
 //#define INTERP_DEBUG
 
@@ -66,6 +72,70 @@ Authors: 1985 Wayne A. Christopher
 bool
 sPoly::interp(double *data, double *ndata, double *oscale, int olen,
     double *nscale, int nlen)
+{
+    return (interp_vecs(&data, &ndata, 1, oscale, olen, nscale, nlen));
+}
+
+
+namespace {
+    // New scale points per job in multi-threaded interpolation.
+#define INTERP_CHUNK 262144
+
+#ifdef WITH_THREADS
+    // Job for multi-threaded interpolation, a range of the new scale
+    // for one vector.
+    //
+    struct sInterpJob
+    {
+        sInterpJob(const sPoly *p, const double *d, double *nd,
+            const double *os, int ol, const double *ns, int s, int e)
+            {
+                ij_poly = p;
+                ij_data = d;
+                ij_ndata = nd;
+                ij_oscale = os;
+                ij_olen = ol;
+                ij_nscale = ns;
+                ij_start = s;
+                ij_end = e;
+            }
+
+        const sPoly *ij_poly;
+        const double *ij_data;
+        double *ij_ndata;
+        const double *ij_oscale;
+        int ij_olen;
+        const double *ij_nscale;
+        int ij_start;
+        int ij_end;
+    };
+
+
+    int interp_thread_proc(sTPthreadData*, void *arg)
+    {
+        sInterpJob *j = (sInterpJob*)arg;
+        j->ij_poly->interp_range(j->ij_data, j->ij_ndata, j->ij_oscale,
+            j->ij_olen, j->ij_nscale, j->ij_start, j->ij_end);
+        return (0);
+    }
+
+
+    void interp_destroy_proc(void *arg)
+    {
+        delete (sInterpJob*)arg;
+    }
+#endif
+}
+
+
+// Interpolate nvecs data vectors, each olen long, from oscale into
+// the corresponding ndata arrays on nscale.  The vectors, and long
+// vectors in sections, are processed in parallel if the loadthrds
+// variable is set.
+//
+bool
+sPoly::interp_vecs(double **data, double **ndata, int nvecs, double *oscale,
+    int olen, double *nscale, int nlen)
 {
     if (olen < 2 || nlen < 2) {
         GRpkgIf()->ErrPrintf(ET_ERROR, "lengths too small to interpolate.\n");
@@ -76,93 +146,136 @@ sPoly::interp(double *data, double *ndata, double *oscale, int olen,
             pc_degree);
         return (false);
     }
+    // Need degree+1 points.
+    if (pc_degree >= olen)
+        pc_degree = olen - 1;
 
-    int sz = pc_degree + 1;
-    double *result = new double[sz + sz + sz];
-    double *xdata = result + sz;
-    double *ydata = xdata + sz;
-    memcpy(ydata, data, sz*sizeof(double));
-    memcpy(xdata, oscale, sz*sizeof(double));
-
-    // Deal with the first degree pieces
-    while (!polyfit(xdata, ydata, result)) {
-        // If it doesn't work this time, bump the interpolation.
-        // degree down by one.
-        if (--pc_degree == 0) {
-            GRpkgIf()->ErrPrintf(ET_INTERR, "sPoly::interp: #1.\n");
-            delete [] result;
-            return (false);
+#ifdef WITH_THREADS
+    int nthreads = 0;
+    double npts = (double)nvecs*nlen;
+    if (npts > INTERP_CHUNK) {
+        VTvalue vv;
+        if (Sp.GetVar(spkw_loadthrds, VTYP_NUM, &vv))
+            nthreads = vv.get_int();
+    }
+    if (nthreads > 0) {
+        cThreadPool pool(nthreads);
+        for (int i = 0; i < nvecs; i++) {
+            for (int j = 0; j < nlen; j += INTERP_CHUNK) {
+                int end = j + INTERP_CHUNK;
+                if (end > nlen)
+                    end = nlen;
+                pool.submit(interp_thread_proc, new sInterpJob(this, data[i],
+                    ndata[i], oscale, olen, nscale, j, end),
+                    interp_destroy_proc);
+            }
         }
+        pool.run(0);
+        return (true);
     }
+#endif
 
-    // Add this part of the curve.  What we do is evaluate the
-    // polynomial at those points between the last one and the one
-    // that is greatest, without being greater than the leftmost old
-    // scale point, or least if the scale is decreasing at the end of
-    // the interval we are looking at.
-    //
-    int sign = (oscale[1] < oscale[0] ? -1 : 1);
-    int lastone = -1;
-    for (int i = 0; i < pc_degree; i++) {
-        int end;
-        // See how far we have to go
-        for (end = lastone + 1; end < nlen; end++)
-            if (nscale[end]*sign > xdata[i]*sign)
-                break;
-        end--;
-
-        for (int j = lastone + 1; j <= end; j++) {
-            if (nscale[j]*sign < oscale[0]*sign)
-                ndata[j] = data[0];
+    for (int i = 0; i < nvecs; i++)
+        interp_range(data[i], ndata[i], oscale, olen, nscale, 0, nlen);
+    return (true);
+}
+
+
+// Fill in ndata[start] through ndata[end-1].  This is a single merge
+// pass over the two scales.  Degree one is linear interpolation
+// between neighboring points.  Otherwise, the value is found from the
+// polynomial through the degree+1 points centered on the interval
+// containing the new scale point, evaluated in Lagrange form.  Points
+// outside of the old scale take the nearest end value.  This does not
+// modify the object and can be called from multiple threads.
+//
+void
+sPoly::interp_range(const double *data, double *ndata, const double *oscale,
+    int olen, const double *nscale, int start, int end) const
+{
+    if (start >= end)
+        return;
+    double sign = (oscale[1] < oscale[0] ? -1.0 : 1.0);
+    double xfirst = sign*oscale[0];
+    double xlast = sign*oscale[olen-1];
+    int deg = pc_degree;
+    int offs = (deg - 1)/2;
+
+    // Binary search for the interval containing the first point, so
+    // that sections can be done independently.
+    int k = 0;
+    {
+        double x = sign*nscale[start];
+        int lo = 0, hi = olen - 1;
+        while (hi - lo > 1) {
+            int mid = (lo + hi)/2;
+            if (x > sign*oscale[mid])
+                lo = mid;
             else
-                ndata[j] = peval(nscale[j], result);
+                hi = mid;
         }
-        lastone = end;
+        k = lo;
     }
 
-    // Now plot the rest, piece by piece.  l is the last element under
-    // consideration.
-    //
-    for (int l = pc_degree + 1; l < olen; l++) {
+    for (int j = start; j < end; j++) {
+        double x = sign*nscale[j];
+        if (x <= xfirst) {
+            ndata[j] = data[0];
+            continue;
+        }
+        if (x >= xlast) {
+            ndata[j] = data[olen-1];
+            continue;
+        }
+
+        // Find k such that oscale[k] < x <= oscale[k+1].  The new scale
+        // is monotonic so this normally only advances.
+        while (x > sign*oscale[k+1])
+            k++;
+        while (k > 0 && x <= sign*oscale[k])
+            k--;
 
-        // Shift the old stuff by one and get another value
-        int i;
-        for (i = 0; i < pc_degree; i++) {
-            xdata[i] = xdata[i + 1];
-            ydata[i] = ydata[i + 1];
+        if (deg == 1) {
+            double x0 = oscale[k];
+            double y0 = data[k];
+            ndata[j] = y0 + (data[k+1] - y0)*(nscale[j] - x0)/
+                (oscale[k+1] - x0);
+            continue;
         }
-        ydata[i] = data[l];
-        xdata[i] = oscale[l];
-
-        while (!polyfit(xdata, ydata, result)) {
-            if (--pc_degree == 0) {
-                GRpkgIf()->ErrPrintf(ET_INTERR, "sPoly::interp: #2.\n");
-                delete [] result;
-                return (false);
+
+        int s = k - offs;
+        if (s < 0)
+            s = 0;
+        else if (s + deg >= olen)
+            s = olen - 1 - deg;
+        const double *xs = oscale + s;
+        const double *ys = data + s;
+        double xn = nscale[j];
+        double y = 0.0;
+        bool rpt = false;
+        for (int m = 0; m <= deg && !rpt; m++) {
+            double w = ys[m];
+            for (int n = 0; n <= deg; n++) {
+                if (n != m) {
+                    double dx = xs[m] - xs[n];
+                    if (dx == 0.0) {
+                        rpt = true;
+                        break;
+                    }
+                    w *= (xn - xs[n])/dx;
+                }
             }
+            y += w;
         }
-        int end;
-        // See how far we have to go.
-        for (end = lastone + 1; end < nlen; end++)
-            if (nscale[end]*sign > xdata[i]*sign)
-                break;
-        end--;
-
-        for (int j = lastone + 1; j <= end; j++) {
-            if (nscale[j]*sign < oscale[0]*sign)
-                ndata[j] = data[0];
-            else
-                ndata[j] = peval(nscale[j], result);
+        if (rpt) {
+            // The window contains a repeated abscissa, use linear
+            // interpolation in the interval, whose end points differ.
+            double x0 = oscale[k];
+            double y0 = data[k];
+            y = y0 + (data[k+1] - y0)*(xn - x0)/(oscale[k+1] - x0);
         }
-        lastone = end;
+        ndata[j] = y;
     }
-
-    // Extend last value if necessary.
-    for (int j = lastone + 1; j < nlen; j++)
-        ndata[j] = ndata[lastone];
-
-    delete [] result;
-    return (true);
 }
 
 
@@ -2253,6 +2253,7 @@ sKW *cKeyWords::KWunits[] = {
 
 // the command configuration keywords
 const char *kw_appendwrite      = "appendwrite";
+const char *kw_aspool           = "aspool";
 const char *kw_checkiterate     = "checkiterate";
 const char *kw_diff_abstol      = "diff_abstol";
 const char *kw_diff_reltol      = "diff_reltol";
@@ -2282,11 +2283,16 @@ const char *kw_printnoheader    = "printnoheader";
 const char *kw_printnoindex     = "printnoindex";
 const char *kw_printnopageheader= "printnopageheader";
 const char *kw_printnoscale     = "printnoscale";
+const char *kw_profile          = "profile";
 const char *kw_random           = "random";
 const char *kw_rawfile          = "rawfile";
 const char *kw_rawfileprec      = "rawfileprec";
 const char *kw_rhost            = "rhost";
 const char *kw_rprogram         = "rprogram";
+const char *kw_savecomp         = "savecomp";
+const char *kw_savemindt        = "savemindt";
+const char *kw_savetol          = "savetol";
+const char *kw_savewin          = "savewin";
 const char *kw_spectrace        = "spectrace";
 const char *kw_specwindow       = "specwindow";
 const char *kw_specwindoworder  = "specwindoworder";
@@ -2311,6 +2317,32 @@ struct KWent_appendwrite : public KWent
     }
 };
 
+struct KWent_aspool : public KWent
+{
+    KWent_aspool() { set(
+        kw_aspool,
+        VTYP_NUM, 0.0, 64.0,
+        "Number of persistent workers for local aspice jobs."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() == VTYP_REAL && v->real() >= min &&
+                    v->real() <= max) {
+                int val = (int)v->real();
+                v->set_integer(val);
+            }
+            else if (!(v->type() == VTYP_NUM && v->integer() >= min &&
+                    v->integer() <= max)) {
+                error_pr(word, 0, pr_integer((int)min, (int)max));
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
 struct KWent_checkiterate : public KWent
 {
     KWent_checkiterate() { set(
@@ -2959,6 +2991,22 @@ struct KWent_printnoscale : public KWent
     }
 };
 
+struct KWent_profile : public KWent
+{
+    KWent_profile() { set(
+        kw_profile,
+        VTYP_BOOL, 0.0, 0.0,
+        "Collect detailed performance data during analysis."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset)
+            v->set_boolean(true);
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
 struct KWent_random : public KWent
 {
     KWent_random() { set(
@@ -3068,6 +3116,98 @@ struct KWent_rprogram : public KWent
     }
 };
 
+struct KWent_savecomp : public KWent
+{
+    KWent_savecomp() { set(
+        kw_savecomp,
+        VTYP_STRING, 0.0, 0.0,
+        "Vectors to compress in transient analysis, or all."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() != VTYP_STRING) {
+                error_pr(word, 0, "a string");
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
+struct KWent_savemindt : public KWent
+{
+    KWent_savemindt() { set(
+        kw_savemindt,
+        VTYP_REAL, 0.0, 1e38,
+        "Minimum scale spacing of compressed points."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() == VTYP_NUM && v->integer() >= min &&
+                    v->integer() <= max) {
+                double dval = v->integer();
+                v->set_real(dval);
+            }
+            else if (!(v->type() == VTYP_REAL && v->real() >= min &&
+                    v->real() <= max)) {
+                error_pr(word, 0, pr_real(min, max));
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
+struct KWent_savetol : public KWent
+{
+    KWent_savetol() { set(
+        kw_savetol,
+        VTYP_REAL, 0.0, 1.0,
+        "Relative error tolerance of compressed vectors."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() == VTYP_NUM && v->integer() >= min &&
+                    v->integer() <= max) {
+                double dval = v->integer();
+                v->set_real(dval);
+            }
+            else if (!(v->type() == VTYP_REAL && v->real() >= min &&
+                    v->real() <= max)) {
+                error_pr(word, 0, pr_real(min, max));
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
+struct KWent_savewin : public KWent
+{
+    KWent_savewin() { set(
+        kw_savewin,
+        VTYP_STRING, 0.0, 0.0,
+        "Scale ranges saved in compressed vectors."); }
+
+    void callback(bool isset, variable *v)
+    {
+        if (isset) {
+            if (v->type() != VTYP_STRING) {
+                error_pr(word, 0, "a string");
+                return;
+            }
+        }
+        CP.RawVarSet(word, isset, v);
+        KWent::callback(isset, v);
+    }
+};
+
 struct KWent_spectrace : public KWent
 {
     KWent_spectrace() { set(
@@ -3241,6 +3381,7 @@ struct KWent_xicpath : public KWent
 
 sKW *cKeyWords::KWcmds[] = {
     new KWent_appendwrite(),
+    new KWent_aspool(),
     new KWent_checkiterate(),
     new KWent_diff_abstol(),
     new KWent_diff_reltol(),
@@ -3270,11 +3411,16 @@ sKW *cKeyWords::KWcmds[] = {
     new KWent_printnoindex(),
     new KWent_printnopageheader(),
     new KWent_printnoscale(),
+    new KWent_profile(),
     new KWent_random(),
     new KWent_rawfile(),
     new KWent_rawfileprec(),
     new KWent_rhost(),
     new KWent_rprogram(),
+    new KWent_savecomp(),
+    new KWent_savemindt(),
+    new KWent_savetol(),
+    new KWent_savewin(),
     new KWent_spectrace(),
     new KWent_specwindow(),
     new KWent_specwindoworder(),
@@ -127,15 +127,34 @@ sPlot::linearize(wordlist *wl)
         newtime->set_realval(i, d);
     newtime->newperm(newp); // set to scale
 
+    // The vectors to interpolate are collected, and interpolated
+    // together so that this can be done in parallel.
+    int nv = 0;
     if (wl && !lstring::cieq(wl->wl_word, "all")) {
-        while (wl) {
+        for (wordlist *w = wl; w; w = w->wl_next)
+            nv++;
+    }
+    else {
+        sHgen gen(pl_hashtab);
+        while (gen.next() != 0)
+            nv++;
+    }
+    sDataVec **ovecs = new sDataVec*[nv + 1];
+    sDataVec **nvecs = new sDataVec*[nv + 1];
+    nv = 0;
+
+    if (wl && !lstring::cieq(wl->wl_word, "all")) {
+        for ( ; wl; wl = wl->wl_next) {
             sDataVec *v = find_vec(wl->wl_word);
             if (!v) {
                 Sp.Error(E_NOVEC, 0, wl->wl_word);
                 continue;
             }
-            newp->lincopy(v, newtime->realvec(), len, this);
-            wl = wl->wl_next;
+            sDataVec *nvec = newp->lincopy(v, len, this);
+            if (nvec) {
+                ovecs[nv] = v;
+                nvecs[nv++] = nvec;
+            }
         }
     }
     else {
@@ -145,35 +164,57 @@ sPlot::linearize(wordlist *wl)
             sDataVec *v = (sDataVec*)h->data();
             if (v == scale())
                 continue;
-            newp->lincopy(v, newtime->realvec(), len, this);
+            sDataVec *nvec = newp->lincopy(v, len, this);
+            if (nvec) {
+                ovecs[nv] = v;
+                nvecs[nv++] = nvec;
+            }
         }
     }
+
+    if (nv) {
+        double **odata = new double*[nv];
+        double **ndata = new double*[nv];
+        for (int j = 0; j < nv; j++) {
+            odata[j] = ovecs[j]->realvec();
+            ndata[j] = nvecs[j]->realvec();
+        }
+        sPoly po(1);
+        bool ok = po.interp_vecs(odata, ndata, nv, oldtime->realvec(),
+            oldtime->length(), newtime->realvec(), len);
+        for (int j = 0; j < nv; j++) {
+            if (ok)
+                nvecs[j]->newperm(newp);
+            else {
+                GRpkgIf()->ErrPrintf(ET_WARN, "can't interpolate %s.\n",
+                    ovecs[j]->name());
+                delete nvecs[j];
+            }
+        }
+        delete [] odata;
+        delete [] ndata;
+    }
+    delete [] ovecs;
+    delete [] nvecs;
 }
 
 
-void
-sPlot::lincopy(sDataVec *ov, double *newscale, int newlen, sPlot *oldplot)
+// If ov is to be interpolated, return a new vector of length newlen
+// for the result, which the caller will fill in and add to this plot. 
+// Otherwise, copy ov into this plot if necessary and return 0.
+//
+sDataVec *
+sPlot::lincopy(sDataVec *ov, int newlen, sPlot *oldplot)
 {
     sDataVec *oldscale = oldplot->scale();
     if ((!ov->scale() || ov->scale() == oldscale) &&
             ov->length() == oldscale->length()) {
         if (!ov->isreal()) {
             GRpkgIf()->ErrPrintf(ET_WARN, "%s is not real.\n", ov->name());
-            return;
-        }
-        sDataVec *v = new sDataVec(
-            lstring::copy(ov->name()), ov->flags(), newlen, ov->units());
-        double *nd = v->realvec();
-        sPoly po(1);
-        if (!po.interp(ov->realvec(), nd, oldscale->realvec(), 
-                oldscale->length(), newscale, newlen)) {
-            GRpkgIf()->ErrPrintf(ET_WARN, "can't interpolate %s.\n",
-                ov->name());
-            delete v;
-            return;
+            return (0);
         }
-        v->newperm(this);
-        return;
+        return (new sDataVec(
+            lstring::copy(ov->name()), ov->flags(), newlen, ov->units()));
     }
     // Otherwise, copy as-is, these are (we hope) not related to
     // the scale being linearized, but may contain, e.g., .measure
@@ -182,7 +223,7 @@ sPlot::lincopy(sDataVec *ov, double *newscale, int newlen, sPlot *oldplot)
     // If a scale for another vector, it might have already been
     // copied.
     if (find_vec(ov->name()))
-        return;
+        return (0);
 
     sDataVec *v = new sDataVec(
         lstring::copy(ov->name()), ov->flags(), ov->length(), ov->units());
@@ -215,5 +256,6 @@ sPlot::lincopy(sDataVec *ov, double *newscale, int newlen, sPlot *oldplot)
         v->set_scale(vs);
     }
     v->newperm(this);
+    return (0);
 }
 
@@ -585,6 +585,20 @@ IFoutput::beginPlot(sOUTdata *outd, int multip,
     if (outd->refName && run->runPlot())
         run->runPlot()->set_num_dimensions(1);
 
+    // Waveform compression gives vectors their own scales, which is
+    // not supported by iplots and measurements during the run.
+    if (!run->rd() && !hasIplot()) {
+        sRunopDb *db = &run->circuit()->runops();
+        ROgen<sRunopMeas> mgen(o_runops->measures(), db->measures());
+        sRunopMeas *m;
+        while ((m = mgen.next()) != 0) {
+            if (run->job()->JOBtype == m->analysis())
+                break;
+        }
+        if (!m)
+            run->setupCompress();
+    }
+
     run->circuit()->set_runplot(OP.curPlot());
     OP.curPlot()->set_active(true);
     initRunops(run);
@@ -138,11 +138,43 @@ const char *kw_faults       = "faults";
 const char *kw_stats        = "stats";
 
 
-// The rusage command.
+// The rusage command.  If the first argument is "-json", dump the
+// detailed profile data from the last analysis of the current circuit
+// in JSON format, to the file named in the next argument if given, or
+// to the standard output.  The profile data are collected only if the
+// "profile" variable was set when the analysis was run.
 //
 void
 CommandTab::com_rusage(wordlist *wl)
 {
+    if (wl && lstring::eq(wl->wl_word, "-json")) {
+        sCKT *ckt = Sp.CurCircuit() ? Sp.CurCircuit()->runckt() : 0;
+        if (!ckt || !ckt->CKTstat || !ckt->CKTstat->STATperf) {
+            GRpkgIf()->ErrPrintf(ET_ERROR,
+                "no profile data, set \"%s\" and run an analysis.\n",
+                kw_profile);
+            return;
+        }
+        wl = wl->wl_next;
+        if (wl) {
+            char *fname = lstring::copy(wl->wl_word);
+            CP.Unquote(fname);
+            FILE *fp = fopen(fname, "w");
+            if (!fp) {
+                GRpkgIf()->Perror(fname);
+                delete [] fname;
+                return;
+            }
+            ckt->CKTstat->STATperf->print_json(fp, ckt->CKTstat);
+            fclose(fp);
+            delete [] fname;
+        }
+        else {
+            ckt->CKTstat->STATperf->print_json(TTY.outfile(), ckt->CKTstat);
+            fflush(TTY.outfile());
+        }
+        return;
+    }
     Sp.ShowResource(wl, 0);
 }
 
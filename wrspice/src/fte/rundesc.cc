@@ -60,6 +60,8 @@ Authors: 1988 Wayne A. Christopher
 #include "noisdefs.h"
 #include "tfdefs.h"
 #include "sensdefs.h"
+#include "kwords_fte.h"
+#include "spnumber/spnumber.h"
 #include <limits.h>
 
 //
@@ -320,6 +322,10 @@ sRunDesc::addPointToPlot(IFvalue *refValue, IFvalue *valuePtr, bool inc)
                 else if (rd_data[i].type == IF_COMPLEX)
                     rd_data[i].addComplexValue(refValue->cValue, inc);
             }
+            else if (rd_data[i].cscale && inc) {
+                rd_data[i].addCompressedValue(refValue->rValue,
+                    valuePtr->v.vec.rVec[rd_data[i].outIndex], this);
+            }
             else {
                 if (rd_data[i].type == IF_REAL)
                     rd_data[i].addRealValue(
@@ -431,6 +437,99 @@ sRunDesc::dumpSegment()
 }
 
 
+// Set up waveform compression, if requested.  The vectors listed in
+// the savecomp variable, or all vectors if "all", save only the points
+// that are needed to reconstruct the waveform by linear interpolation
+// to within savetol times the largest magnitude seen.  Points closer
+// than savemindt to the previous saved point are not saved, and if
+// savewin is given, only points within the listed scale ranges are
+// saved.  Each compressed vector is given its own scale.
+//
+// This is available only in a simple transient analysis saving to
+// memory.
+//
+void
+sRunDesc::setupCompress()
+{
+    if (!rd_runPlot || rd_refIndex < 0 || rd_rd || rd_segfilebase)
+        return;
+    if (rd_check || rd_sweep || rd_scrolling || rd_cycles > 1)
+        return;
+    if (!rd_job || !lstring::cieq((const char*)rd_job->JOBname, "tran"))
+        return;
+    VTvalue vv;
+    if (!Sp.GetVar(kw_savecomp, VTYP_STRING, &vv, rd_circ))
+        return;
+    char *names = lstring::copy(vv.get_string());
+    bool all = false;
+    const char *s = names;
+    char *tok;
+    while ((tok = lstring::gettok(&s)) != 0) {
+        if (lstring::cieq(tok, "all"))
+            all = true;
+        delete [] tok;
+    }
+
+    rd_comptol = 0.0;
+    if (Sp.GetVar(kw_savetol, VTYP_REAL, &vv, rd_circ))
+        rd_comptol = vv.get_real();
+    rd_compmindt = 0.0;
+    if (Sp.GetVar(kw_savemindt, VTYP_REAL, &vv, rd_circ))
+        rd_compmindt = vv.get_real();
+    delete [] rd_compwins;
+    rd_compwins = 0;
+    rd_numcompwins = 0;
+    if (Sp.GetVar(kw_savewin, VTYP_STRING, &vv, rd_circ)) {
+        const char *str = vv.get_string();
+        rd_compwins = new double[(strlen(str) + 1)/2 + 1];
+        const char *t = str;
+        double *d;
+        while ((d = SPnum.parse(&t, false)) != 0) {
+            rd_compwins[rd_numcompwins++] = *d;
+            while (isspace(*t) || *t == ',')
+                t++;
+        }
+        if (*t || (rd_numcompwins & 1)) {
+            GRpkgIf()->ErrPrintf(ET_WARN,
+                "bad savewin syntax, ignored.\n");
+            rd_numcompwins = 0;
+        }
+        rd_numcompwins /= 2;
+    }
+
+    sDataVec *ref = rd_data[rd_refIndex].vec;
+    for (int i = 0; i < rd_numData; i++) {
+        dataDesc *dd = rd_data + i;
+        if (i == rd_refIndex || !dd->regular || dd->type != IF_REAL ||
+                !dd->vec)
+            continue;
+        if (!all) {
+            bool found = false;
+            s = names;
+            while ((tok = lstring::gettok(&s)) != 0) {
+                if (lstring::cieq(tok, dd->name) ||
+                        lstring::cieq(tok, dd->vec->name()))
+                    found = true;
+                delete [] tok;
+                if (found)
+                    break;
+            }
+            if (!found)
+                continue;
+        }
+        char *nm = new char[strlen(dd->vec->name()) + 10];
+        sprintf(nm, "%s_scale", dd->vec->name());
+        sDataVec *v = new sDataVec(nm, 0, 0, ref->units());
+        v->alloc(true, dd->vec->allocated());
+        v->newperm(rd_runPlot);
+        dd->vec->set_scale(v);
+        dd->cscale = v;
+        dd->c_peak = 0.0;
+    }
+    delete [] names;
+}
+
+
 // Reset the length of the data vectors to 0.
 //
 void
@@ -726,6 +825,78 @@ dataDesc::pushRealValue(double value, unsigned int indx)
 }
 
 
+// Add a point to a compressed vector.  The last element of the vector
+// is always the most recent point, so that the runops see the present
+// value.  The earlier elements are the saved points.  When a new point
+// arrives, the previous point is dropped, i.e., overwritten, if a line
+// from the last saved point to the new point passes within tolerance
+// of all points since the last saved point.  This is the "swinging
+// door" test, the running slope limits provide the test in constant
+// time.
+//
+void
+dataDesc::addCompressedValue(double x, double value, const sRunDesc *run)
+{
+    double ay = fabs(value);
+    if (ay > c_peak)
+        c_peak = ay;
+    double tol = run->comptol()*c_peak;
+
+    int len = vec->length();
+    if (len >= 2) {
+        double x0 = cscale->realval(len - 2);
+        double y0 = vec->realval(len - 2);
+        double xp = cscale->realval(len - 1);
+        double dx = x - x0;
+        bool drop;
+        if (xp - x0 < run->compmindt() || !run->in_compwin(xp))
+            drop = true;
+        else if (dx != 0.0) {
+            double slope = (value - y0)/dx;
+            drop = (slope >= c_slo && slope <= c_shi);
+        }
+        else
+            drop = false;
+
+        if (drop) {
+            if (dx != 0.0) {
+                double slo = (value - tol - y0)/dx;
+                double shi = (value + tol - y0)/dx;
+                if (slo > c_slo)
+                    c_slo = slo;
+                if (shi < c_shi)
+                    c_shi = shi;
+            }
+            vec->set_realval(len - 1, value);
+            cscale->set_realval(len - 1, x);
+            return;
+        }
+
+        // Keep the previous point, it becomes the reference.
+        dx = x - xp;
+        if (dx != 0.0) {
+            c_slo = (value - tol - vec->realval(len - 1))/dx;
+            c_shi = (value + tol - vec->realval(len - 1))/dx;
+        }
+    }
+    else if (len == 1) {
+        double dx = x - cscale->realval(0);
+        if (dx != 0.0) {
+            c_slo = (value - tol - vec->realval(0))/dx;
+            c_shi = (value + tol - vec->realval(0))/dx;
+        }
+    }
+    if (len >= vec->allocated())
+        vec->resize(len + SIZE_INCR);
+    if (len >= cscale->allocated())
+        cscale->resize(len + SIZE_INCR);
+    vec->set_length(len + 1);
+    cscale->set_length(len + 1);
+    vec->set_realval(len, value);
+    cscale->set_realval(len, x);
+}
+
+
 void
 dataDesc::addComplexValue(IFcomplex value, bool inc)
 {
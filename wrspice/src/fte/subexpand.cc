@@ -352,6 +352,7 @@ sScGlobal::init(sFtCirc *circ)
 {
     SPcx.kwMatchInit();
     SPcx.init(circ);
+    sParamTab::clear_eval_cache();
 
     sg_stack_ptr = 0;
     sg_stack[0].clear();
@@ -251,6 +251,8 @@ SPinput::numRefs(const char *str, int *minterms, int *maxterms, int *devs,
                     mod = true;
             }
         }
+        // Account for devices in modules not yet loaded.
+        Sp.DeferredModuleRefs(c, &nmin, &nmax, &ndevs, &mod);
     }
     if (minterms)
         *minterms = (nmin <= nmax ? nmin : 0);
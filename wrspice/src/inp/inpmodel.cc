@@ -235,6 +235,10 @@ SPinput::parseMod(sLine *curline)
         return;
     }
 
+    // If the model is provided by a module not yet loaded, load it
+    // now.
+    Sp.LoadDeferredModules(token, line);
+
     int lev = 0;
     bool gotlev = false;
     for (int i = 0; i < DEV.numdevs(); i++) {
@@ -414,11 +418,17 @@ SPinput::parseDefMod(sLine *curline, sCKT *ckt)
 
     int type = -1;
     IFdevice *dev = 0;
-    for (int i = 0; i < DEV.numdevs(); i++) {
-        dev = DEV.device(i);
-        if (dev->modkeyMatch(mname)) {
-            type = i;
-            break;
+    for (int pass = 0; pass < 2 && type < 0; pass++) {
+        if (pass) {
+            // Try again after loading modules that provide the type.
+            Sp.LoadDeferredModules(mname, 0);
+        }
+        for (int i = 0; i < DEV.numdevs(); i++) {
+            dev = DEV.device(i);
+            if (dev->modkeyMatch(mname)) {
+                type = i;
+                break;
+            }
         }
     }
     if (type < 0) {
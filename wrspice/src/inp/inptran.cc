@@ -1884,6 +1884,80 @@ IFgpulseData::get_param(int ix)
 
 // PWL
 //
+
+namespace {
+    // Breakpoint generator for PWL functions, returns the corner
+    // times in order, including repetitions.
+    //
+    struct sPWLbreaks : public sCKTbreakSource
+    {
+        sPWLbreaks(const double*, int, bool, int, double);
+        ~sPWLbreaks() { delete [] pb_times; }
+
+        double next_break(double);
+
+    private:
+        double *pb_times;       // corner times
+        int pb_num;             // number of times
+        int pb_rstart;          // first index of repeated part
+        double pb_per;          // repetition period, 0 if none
+        double pb_tfinal;       // no breakpoints past this
+    };
+
+
+    sPWLbreaks::sPWLbreaks(const double *coeffs, int n, bool rgiven,
+        int rix, double tfinal)
+    {
+        pb_times = new double[n];
+        for (int i = 0; i < n; i++)
+            pb_times[i] = coeffs[2*i];
+        pb_num = n;
+        pb_rstart = rix + 1;
+        pb_per = 0.0;
+        if (rgiven && pb_rstart < n) {
+            double ts = rix >= 0 ? pb_times[rix] : 0.0;
+            pb_per = pb_times[n-1] - ts;
+        }
+        pb_tfinal = tfinal;
+    }
+
+
+    double
+    sPWLbreaks::next_break(double t)
+    {
+        double ta = 0.0;
+        int istart = 0;
+        if (t >= pb_times[pb_num-1]) {
+            if (pb_per <= 0.0)
+                return (-1.0);
+            // Skip to the repetition that contains t.
+            ta = pb_per*(floor((t - pb_times[pb_num-1])/pb_per) + 1.0);
+            istart = pb_rstart;
+        }
+        for (;;) {
+            // Binary search for the first time later than t.
+            int lo = istart, hi = pb_num;
+            while (lo < hi) {
+                int mid = (lo + hi)/2;
+                if (pb_times[mid] + ta > t)
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            if (lo < pb_num) {
+                double tn = pb_times[lo] + ta;
+                return (tn > pb_tfinal ? -1.0 : tn);
+            }
+            // Only from roundoff.
+            if (pb_per <= 0.0)
+                return (-1.0);
+            ta += pb_per;
+            istart = pb_rstart;
+        }
+    }
+}
+
+
 IFpwlData::IFpwlData(double *list, int num, bool hasR , int Rix, double TDval) :
 IFtranData(PTF_tPWL)
 {
@@ -2213,25 +2287,14 @@ IFpwlData::setup(sCKT *ckt, double step, double finaltime, bool skipbr)
 
     td_pwlindex = 0;
     if (td_enable_tran && !skipbr && ckt) {
-        // Only call this when time is independent variable.
+        // Only call this when time is independent variable.  The
+        // breakpoints are generated as needed, rather than entered
+        // into the table here.
 
         int n = td_numcoeffs/2;
-        double ta = 0.0;
-        int istart = 0;
-        for (;;) {
-            for (int i = istart; i < n; i++) {
-                double t = td_coeffs[2*i] + ta;
-                if (t > finaltime)
-                    return;
-                ckt->breakSet(t);
-#ifdef DEBUG
-                printf("B %g\n", t);
-#endif
-            }
-            if (!td_pwlRgiven)
-                break;
-            ta += td_coeffs[2*(n-1)] - td_coeffs[2*td_pwlRstart];
-            istart = td_pwlRstart + 1;
+        if (n > 0) {
+            ckt->breakSetSource(new sPWLbreaks(td_coeffs, n, td_pwlRgiven,
+                td_pwlRstart, finaltime));
         }
     }
 }
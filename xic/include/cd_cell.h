@@ -912,6 +912,7 @@ struct CDs : public CDdb
     bool computeBB();
     bool fixBBs(ptrtab_t* = 0);
     bool checkInstances();
+    bool endBulkLoad();
     bool findNode(int, int, int* = 0);
     bool checkVertex(int, int, CDw*);
     bool checkVertex(int*, int*, int, bool);
@@ -1002,6 +1003,7 @@ struct CDs : public CDdb
     bool mergeBoxOrPoly(CDo*, bool);
     bool mergeBox(CDo*, bool);
     bool mergeWire(CDw*, bool, CDw** = 0);
+    bool endDeferredMerge();
 
     // cd_scriptout.cc
     bool writeScript(FILE*, const char*) const;
@@ -80,6 +80,8 @@ struct CDdb
             db_layer_heads = 0;
             db_layers_used = 0;
             db_mod_count = 0;
+            db_bulk = false;
+            db_merge_deferred = false;
         }
 
     // Explicitly call subclass destroy function, subclass has no
@@ -127,6 +129,12 @@ struct CDdb
     int num_layers_used()           const { return (db_layers_used); }
 
     bool db_insert_deferred_instances();
+    void db_begin_bulk()                  { db_bulk = true; }
+    bool db_end_bulk();
+    bool db_is_bulk()               const { return (db_bulk); }
+    void db_begin_deferred_merge()        { db_merge_deferred = true; }
+    void db_cancel_deferred_merge()       { db_merge_deferred = false; }
+    bool db_is_merge_deferred()     const { return (db_merge_deferred); }
     bool db_insert(CDo*);
     bool db_remove(CDo*);
     bool db_is_empty(const CDl*) const;
@@ -146,6 +154,8 @@ protected:
     unsigned short db_layers_used;  // length of array
     unsigned short db_mod_count;    // used in derived class for
                                     //  modification count
+    bool db_bulk;                   // new layer databases are bulk loaded
+    bool db_merge_deferred;         // box merging is deferred
 };
 
 
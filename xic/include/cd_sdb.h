@@ -46,6 +46,8 @@
 
 
 class cSDB;
+struct Poly;
+struct Wire;
 
 inline class cCDsdbDB *CDsdb();
 
@@ -76,7 +78,7 @@ private:
     static cCDsdbDB *instancePtr;
 };
 
-enum sdbType { sdbBdb, sdbOdb, sdbZdb, sdbZldb, sdbZbdb };
+enum sdbType { sdbBdb, sdbOdb, sdbZdb, sdbZldb, sdbZbdb, sdbPdb };
 
 // Polymorphic database saved by name in cCDsdbDB.
 //
@@ -414,6 +416,161 @@ private:
 };
 
 
+// Fan-out of the pdb_t spatial index.
+#define PDB_FANOUT 16
+
+// Maximum pdb_t index depth, enough for 2^32 objects.
+#define PDB_MAXLEV 8
+
+// Packed record for a polygon or wire in pdb_t.  The vertices are
+// kept in a separate array shared by all records.
+//
+struct pdb_path_t
+{
+    BBox BB;                    // bounding box, must be first
+    unsigned int offset;        // offset of first vertex
+    unsigned int numpts;        // number of vertices
+    unsigned int attributes;    // wire width and end style
+    char type;                  // CDPOLYGON or CDWIRE
+};
+
+// Implicit static spatial index for an array of records which begin
+// with a BBox.  The records are grouped into nodes of PDB_FANOUT in
+// array order, and each level is an array of node bounding boxes,
+// with the children of node n at indices n*PDB_FANOUT... of the level
+// below.  There are no pointers, the overhead is about one byte per
+// record.
+//
+struct pdb_index_t
+{
+    pdb_index_t()
+        {
+            ix_BBs = 0;
+            ix_nlevels = 0;
+        }
+
+    ~pdb_index_t()
+        {
+            delete [] ix_BBs;
+        }
+
+    void build(const char*, unsigned int, unsigned int);
+
+    BBox *ix_BBs;                       // node boxes, all levels
+    unsigned int ix_off[PDB_MAXLEV];    // offset of each level
+    unsigned int ix_cnt[PDB_MAXLEV];    // node count of each level
+    unsigned int ix_nlevels;            // level count, 0 if no index
+};
+
+// A compact flat read-only database for boxes, polygons, and wires.
+// Unlike odb_t, which holds full database objects, the boxes and
+// the polygon/wire records are packed into arrays, with the vertices
+// in a single shared array.  When all objects have been added, freeze
+// is called to spatially sort the arrays (Sort-Tile-Recursive) and
+// build the index.  The objects are accessed with pdb_gen.
+//
+struct pdb_t : public base_db_t
+{
+    pdb_t()
+        {
+            pdb_boxes = 0;
+            pdb_paths = 0;
+            pdb_points = 0;
+            pdb_nboxes = 0;
+            pdb_npaths = 0;
+            pdb_npoints = 0;
+            pdb_boxsz = 0;
+            pdb_pathsz = 0;
+            pdb_ptsz = 0;
+            pdb_frozen = false;
+        }
+
+    ~pdb_t();
+
+    unsigned int num_boxes()        const { return (pdb_nboxes); }
+    unsigned int num_paths()        const { return (pdb_npaths); }
+    bool is_frozen()                const { return (pdb_frozen); }
+
+    // The returned structs reference the database, they are not
+    // copies.
+    //
+    void get_poly(const pdb_path_t *p, Poly *po) const;
+    void get_wire(const pdb_path_t *p, Wire *w) const;
+
+    void add(const BBox*);
+    void add(const Poly*);
+    void add(const Wire*);
+    void freeze();
+    Zlist *getZlist(const Zlist*, XIrt*);
+
+private:
+    void add_path(const Point*, unsigned int, unsigned int, char,
+        const BBox*);
+
+    BBox *pdb_boxes;                    // packed boxes
+    pdb_path_t *pdb_paths;              // packed polygons and wires
+    Point *pdb_points;                  // vertices of pdb_paths
+    unsigned int pdb_nboxes;            // box count
+    unsigned int pdb_npaths;            // path count
+    unsigned int pdb_npoints;           // vertex count
+    unsigned int pdb_boxsz;             // pdb_boxes allocated size
+    unsigned int pdb_pathsz;            // pdb_paths allocated size
+    unsigned int pdb_ptsz;              // pdb_points allocated size
+    bool pdb_frozen;                    // sorted, index valid
+    pdb_index_t pdb_boxidx;             // spatial index for boxes
+    pdb_index_t pdb_pathidx;            // spatial index for paths
+
+    friend struct pdb_gen;
+};
+
+// Generator for the boxes and polygons/wires in a pdb_t that overlap
+// (not just touch) a region.  Call next_box until it returns 0, then
+// next_path until it returns 0.  Once next_path has been called,
+// next_box returns 0.
+//
+struct pdb_gen
+{
+    pdb_gen(const pdb_t*, const BBox*);
+
+    const BBox *next_box()
+        {
+            if (!g_db || !g_boxes)
+                return (0);
+            return ((const BBox*)next_rec(&g_db->pdb_boxidx,
+                (const char*)g_db->pdb_boxes, sizeof(BBox),
+                g_db->pdb_nboxes));
+        }
+
+    const pdb_path_t *next_path()
+        {
+            if (!g_db)
+                return (0);
+            if (g_boxes) {
+                // Start the path walk.
+                g_boxes = false;
+                init_walk(&g_db->pdb_pathidx, g_db->pdb_npaths);
+            }
+            return ((const pdb_path_t*)next_rec(&g_db->pdb_pathidx,
+                (const char*)g_db->pdb_paths, sizeof(pdb_path_t),
+                g_db->pdb_npaths));
+        }
+
+private:
+    void init_walk(const pdb_index_t*, unsigned int);
+    const char *next_rec(const pdb_index_t*, const char*, unsigned int,
+        unsigned int);
+
+    const pdb_t *g_db;
+    BBox g_AOI;
+    unsigned int g_cur;                 // current record
+    unsigned int g_end;                 // end of current record range
+    int g_sp;                           // stack pointer
+    bool g_boxes;                       // walking boxes
+    unsigned char g_stk[PDB_MAXLEV*PDB_FANOUT];     // level stack
+    unsigned int g_stn[PDB_MAXLEV*PDB_FANOUT];      // node stack
+};
+
+
 // A spatially-binned database for trapezoids.  Each grid cell contains
 // a Zlist clipped to that cell plus boundary.
 //
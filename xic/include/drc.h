@@ -675,6 +675,7 @@ struct DRCtestDesc
         bool, Point*);
     XIrt cornerTest(DRCedgeEval*);
     XIrt cornerOverlapTest(DRCedgeEval*, int);
+    int sweepDimen() const;
 
     void treeError();
     void seterr(const Zoid*, int);
@@ -831,6 +832,16 @@ struct DRCtestDesc
     bool inhibited()                const { return (td_inhibit); }
     void setInhibited(bool b)             { td_inhibit = b; }
 
+    // Temporary inhibit used in batch mode, when the layer sweep has
+    // shown that the rule can't fail for the object being checked.
+    void setSwept(bool b)
+        {
+            if (b)
+                td_inhibit |= 4;
+            else
+                td_inhibit &= ~4;
+        }
+
     bool oppTest()                  const { return (td_opptest); }
     bool noTestCorners()            const { return (td_no_test_corners); }
     void setNoCot(bool b)                 { td_no_cot = b; }
@@ -1082,6 +1093,11 @@ private:
 };
 
 
+// Function to check a single partition of the coarse grid, used by
+// the gridded batch tests.
+//
+typedef XIrt(*DRCtileFunc)(const BBox*, FILE*, const char*, void*);
+
 // Run initializing flags.
 #define DRC_INIT_SKIP_CNT 0x1
 #define DRC_INIT_PRGSIV   0x2
@@ -1133,6 +1149,9 @@ public:
     XIrt batchTest(const BBox*, FILE*, sLstr*, BBox*, const char* = 0);
     XIrt gridBatchTest(const BBox*, FILE*);
     XIrt chdGridBatchTest(cCHD*, const char*, const BBox*, FILE*, bool);
+    XIrt chdIncrBatchTest(cCHD*, const char*, cCHD*, const char*,
+        const char*, FILE*, bool);
+    XIrt hierBatchTest(FILE*, sLstr*);
     void batchListTest(const CDol*, FILE*, sLstr*, BBox*);
     XIrt layerRules(const CDl*, const BBox*, DRCerrRet**);
     XIrt objectRules(const CDo*, const BBox*, DRCerrRet**, CDl* = 0);
@@ -1323,6 +1342,10 @@ private:
     void close_drc(Blist*);
     bool skip_layer(const CDl*);
     bool update_rule_disable();
+    XIrt grid_batch_mp(const BBox*, int, int, DRCtileFunc, void*, FILE*,
+        unsigned int*, unsigned int*);
+    bool rules_use_derived();
+    XIrt hier_cell_test(CDs*, int, bool, FILE*, sLstr*, DRCerrList**);
 
     // drc_results.cc
     bool altShowError(WindowDesc*, bool);
@@ -395,6 +395,7 @@ public:
     XIrt createLayer(CDs*, const BBox*, CDl*, const char*, int, int);
     XIrt createLayer_notree(CDs*, const BBox*, CDl*, const char*, int, int);
     XIrt evalDerivedLayers(CDll**, CDs*, const BBox*);
+    XIrt createDerivedLayers(CDs*, const BBox*, CDl**, int);
     bool parseNewLayerSpec(const char**, int*, int*);
 
     // modify_menu.cc
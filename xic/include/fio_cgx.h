@@ -273,6 +273,7 @@ struct cgx_in : public cv_in
 private:
     bool read_header(bool);
     bool end_struct();
+    void cancel_merge();
 
     bool a_struct(int, int);
     bool a_cprpty(int, int);
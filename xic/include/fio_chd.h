@@ -143,6 +143,7 @@ public:
     OItype readFlat(const char*, const FIOcvtPrms*,
         cv_backend* = 0, int = -1, int = 0, bool = false);
     OItype readFlat_odb(SymTab**, const char*, const FIOcvtPrms*);
+    OItype readFlat_pdb(SymTab**, const char*, const FIOcvtPrms*);
     OItype readFlat_zdb(SymTab**, const char*, const FIOcvtPrms*);
     OItype readFlat_zl(SymTab**, const char*, const FIOcvtPrms*);
     OItype readFlat_zbdb(SymTab**, const char*, const FIOcvtPrms*,
@@ -181,6 +182,8 @@ public:
     static XIrt compareCHDs_sd(cCHD*, const char*, cCHD*, const char*,
         const BBox*, const char*, bool, Sdiff**, unsigned int, unsigned int*,
         int, int);
+    static XIrt compareCHDs_bb(cCHD*, const char*, cCHD*, const char*,
+        const BBox*, const char*, bool, Blist**, unsigned int*, int, int);
 
     // fio_chd_split.cc
     OItype writeMulti(const char*, const FIOcvtPrms*, const Blist*,
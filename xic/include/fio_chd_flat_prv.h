@@ -182,6 +182,65 @@ private:
     odb_t *entry;       // output object list for current layer
 };
 
+// Back end for cCHD::readFlat_pdb.
+//
+struct cv_backend_pdb : cv_backend
+{
+    cv_backend_pdb()
+        {
+            table = 0;
+            ldesc = 0;
+            entry = 0;
+        }
+
+    bool queue_layer(const Layer *layer, bool*)
+        {
+            ldesc = CDldb()->findLayer(layer->name, Physical);
+            if (!ldesc)
+                ldesc = CDldb()->newLayer(layer->name, Physical);
+
+            if (!table)
+                table = new SymTab(false, false);
+            pdb_t *db = (pdb_t*)SymTab::get(table, (unsigned long)ldesc);
+            if (db == (pdb_t*)ST_NIL) {
+                db = new pdb_t;
+                table->add((unsigned long)ldesc, db, false);
+            }
+            entry = db;
+            return (true);
+        }
+
+    bool write_box(const BBox *BB)
+        {
+            if (entry && ldesc)
+                entry->add(BB);
+            return (true);
+        }
+
+    bool write_poly(const Poly *po)
+        {
+            if (entry && ldesc)
+                entry->add(po);
+            return (true);
+        }
+
+    bool write_wire(const Wire *w)
+        {
+            if (entry && ldesc)
+                entry->add(w);
+            return (true);
+        }
+
+    bool write_text(const Text*) { return (true); }
+
+    void print_report() { }
+
+    SymTab *table;      // output table
+private:
+    CDl *ldesc;         // target layer desc
+    pdb_t *entry;       // output object list for current layer
+};
+
 // Back end for cCHD::readFlat_zdb.
 //
 struct cv_backend_zdb : cv_backend
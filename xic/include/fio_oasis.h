@@ -623,6 +623,7 @@ private:
     OItype has_geom_core(const BBox*);
     bool read_header(bool);
     bool end_cell();
+    void cancel_merge();
 
     bool a_cell(const char*);
     bool a_placement(int, int, unsigned int, unsigned int);
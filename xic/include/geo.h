@@ -46,6 +46,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <limits.h>
+#include <pthread.h>
 
 
 #define VA_RoundFlashSides      "RoundFlashSides"
@@ -225,6 +226,15 @@ public:
     bool useSclFuncs()                  { return (geoUseSclFuncs); }
     void setUseSclFuncs(bool b)         { geoUseSclFuncs = b; }
 
+    // Helper thread count for band-parallel geometry operations, and
+    // a test for the main thread, helpers don't spawn helpers.
+    int numThreads()                    { return (geoThreads); }
+    void setNumThreads(int n)           { geoThreads = n; }
+    bool inMainThread()
+        {
+            return (pthread_equal(pthread_self(), geoMainThread));
+        }
+
     const sCurTx *curTx()               { return (&geoCurTform); }
     void setCurTx(sCurTx &t)            { geoCurTform = t; }
 
@@ -232,6 +242,8 @@ private:
     int geoSpotSize;        // Implicit grid
     int geoElecRoundSides;  // Sides per 360 degrees for elec round objects
     int geoPhysRoundSides;  // Sides per 360 degrees for phys round objects
+    int geoThreads;         // Helper threads for band operations.
+    pthread_t geoMainThread; // Thread that created this.
     bool geoUseSclFuncs;    // Use new scanline geometry functions.
     sCurTx geoCurTform;     // "Current Transform" parameters
 
@@ -552,6 +552,7 @@ struct RTree
 
     bool set_deferred();
     bool unset_deferred();
+    bool bulk_load(RTelem**, unsigned int);
     bool remove(RTelem*);
     RTelem *to_list();
     void test(RTelem* = 0) const;
@@ -559,6 +560,7 @@ struct RTree
 
 private:
     bool insert_prv(RTelem*);
+    void pack_prv(RTelem**, unsigned int);
 
     RTelem *rt_root;            // Tree root element.
     unsigned int rt_allocated;  // Element count.
@@ -0,0 +1,109 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#ifndef GEO_YARRAY_H
+#define GEO_YARRAY_H
+
+#include "geo_ylist.h"
+
+
+// Minimum zoid count for which clipping functions will pack a
+// reference Ylist into a Yarray.
+#define YA_MIN_ZOIDS 32
+
+// A packed, read-only form of a Ylist.  The zoids are stored in
+// separate integer arrays (columns) in Ylist order, i.e., rows in
+// descending yu, and ascending xul within each row, with an offset
+// array giving the start of each row.  This is used as the reference
+// operand when clipping, where the same list is searched for each
+// zoid of the other operand.  The search screens the zoids of a row
+// several at a time using SIMD comparisons on the columns, with no
+// pointer chasing.
+//
+// Conversion from a Ylist or Zlist, and back to a Zlist or Ylist, is
+// provided for callers that use the linked forms.
+//
+struct Yarray
+{
+    Yarray(const Ylist*);
+    Yarray(const Zlist*);
+    ~Yarray();
+
+    Zlist *to_zlist() const;
+    Ylist *to_ylist() const;
+
+    void reset();
+    const int *find(int, int, int, int, int*);
+
+    // Return the zoid at index i.
+    Zoid zoid(int i) const
+        {
+            return (Zoid(ya_xll[i], ya_xlr[i], ya_yl[i], ya_xul[i],
+                ya_xur[i], ya_yu[i]));
+        }
+
+    int num_zoids()             const { return (ya_nzoids); }
+    int num_rows()              const { return (ya_nrows); }
+
+private:
+    void init(const Ylist*);
+    int screen_row(int, int, int, int, int*) const;
+
+    int *ya_xll;            // Zoid coordinates.
+    int *ya_xlr;
+    int *ya_yl;
+    int *ya_xul;
+    int *ya_xur;
+    int *ya_yu;
+    int *ya_minl;           // Zoid minleft().
+    int *ya_maxr;           // Zoid maxright().
+    int *ya_rowoff;         // Row start offsets, num_rows + 1.
+    int *ya_rowyu;          // Row yu.
+    int *ya_rowyl;          // Row minimum yl.
+    int *ya_live;           // Rows not yet passed over.
+    int *ya_ibuf;           // Return buffer for find.
+    int *ya_block;          // Storage for all of the above.
+    int ya_nzoids;
+    int ya_nrows;
+    int ya_nlive;
+};
+
+#endif
+
@@ -147,6 +147,7 @@ private:
     bool ipc_stdout_async;  // in win32. stdout is async
 #endif
     bool ipc_in_spice;      // set when simulating
+    bool ipc_use_shm;       // bulk data returned in shared memory
     bool ipc_startup;       // connection was just established
     char ipc_level;         // initialization level: 0-2
 
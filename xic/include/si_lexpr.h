@@ -53,6 +53,10 @@
 #define SI_DBCHAR '@'
 
 struct sLspec;
+struct ParseNode;
+struct siVariable;
+struct SymTab;
+struct SIlexprCache;
 
 // This supports a handle table for layer expressions.  The lspec passed
 // to add() is already inited, so we keep a pointer to the source string
@@ -96,6 +100,7 @@ struct SIlexprCx
             cx_refZlist = 0;
             cx_zlSaved = 0;
             cx_gridCx = 0;
+            cx_cache = 0;
             cx_depth = CDMAXCALLDEPTH;
             cx_throw = false;
             cx_verbose = false;
@@ -109,6 +114,7 @@ struct SIlexprCx
             cx_refZlist = zl;
             cx_zlSaved = 0;
             cx_gridCx = 0;
+            cx_cache = 0;
             cx_depth = depth;
             cx_throw = false;
             cx_verbose = false;
@@ -122,6 +128,7 @@ struct SIlexprCx
             cx_refZlist = 0;
             cx_zlSaved = 0;
             cx_gridCx = 0;
+            cx_cache = 0;
             cx_depth = depth;
             cx_throw = false;
             cx_verbose = false;
@@ -136,6 +143,7 @@ struct SIlexprCx
             cx_refZlist = 0;
             cx_zlSaved = 0;
             cx_gridCx = 0;
+            cx_cache = 0;
             cx_depth = depth;
             cx_throw = false;
             cx_verbose = false;
@@ -150,6 +158,7 @@ struct SIlexprCx
             cx_refZlist = zl;
             cx_zlSaved = 0;
             cx_gridCx = 0;
+            cx_cache = 0;
             cx_depth = 0;
             cx_throw = false;
             cx_verbose = false;
@@ -210,6 +219,9 @@ struct SIlexprCx
             cx_depth = d;
         }
 
+    SIlexprCache *lexprCache()  const { return (cx_cache); }
+    void setLexprCache(SIlexprCache *c) { cx_cache = c; }
+
     void enableExceptions(bool b)     { cx_throw = b; }
     bool verbose()              const { return (cx_verbose); }
     bool setSourceSelQueue(bool b)
@@ -238,6 +250,9 @@ private:
 
     grd_t *cx_gridCx;           // Cell area partitioning context.
 
+    SIlexprCache *cx_cache;     // Shared subexpression results, if
+                                // evaluating an SIlexprDag.
+
     int cx_depth;               // Hierarchy depth under sdesc to consider
                                 // if using a cell.
 
@@ -249,6 +264,87 @@ private:
 };
 
 
+typedef bool(*SIevfunc)(ParseNode*, siVariable*, void*);
+
+// Support for evaluating a group of layer expressions together, as
+// for derived layers.  The parse trees are added to an SIlexprDag,
+// which identifies subexpressions (including layer references) that
+// appear more than once, by comparing the unique string forms.  These
+// nodes share a slot, and are evaluated once per evaluation area,
+// with the result kept in an SIlexprCache until the last reference
+// has been evaluated.  The evaluation functions of the shared nodes
+// are replaced while the SIlexprDag exists, so the trees should be
+// private to the group.
+//
+struct SIlexprDag
+{
+    struct node_t
+    {
+        node_t(int s, SIevfunc f) : slot(s), evfunc(f) { }
+
+        int slot;               // Index of result slot.
+        SIevfunc evfunc;        // Original evaluation function.
+    };
+
+    SIlexprDag()
+        {
+            ld_keytab = 0;
+            ld_nodetab = 0;
+            ld_refs = 0;
+            ld_nslots = 0;
+        }
+
+    ~SIlexprDag();
+
+    void addTree(ParseNode*);
+    int compile();
+    const node_t *findNode(const ParseNode*) const;
+
+    int numSlots()              const { return (ld_nslots); }
+    int refs(int i)             const { return (ld_refs[i]); }
+
+private:
+    void add_node(ParseNode*);
+
+    SymTab *ld_keytab;          // Unique string to occurrences.
+    SymTab *ld_nodetab;         // Shared nodes to node_t.
+    int *ld_refs;               // Reference count for each slot.
+    int ld_nslots;              // Number of slots.
+};
+
+// Storage for the shared results while evaluating in one area.  This
+// is attached to the context by the constructor.  Results are
+// reused only if the reference area and depth are those in effect
+// when attached, otherwise the nodes are evaluated normally.
+//
+struct SIlexprCache
+{
+    SIlexprCache(const SIlexprDag*, SIlexprCx*);
+    ~SIlexprCache();
+
+    static bool eval(ParseNode*, siVariable*, void*);
+
+private:
+    struct slot_t
+    {
+        Zlist *zlist;
+        double value;
+        int refs;
+        int type;
+        bool set;
+    };
+
+    bool in_context(const SIlexprCx*) const;
+
+    const SIlexprDag *lc_dag;
+    SIlexprCx *lc_cx;
+    const Zlist *lc_ref;
+    slot_t *lc_slots;
+    Zoid lc_refZ;
+    int lc_depth;
+};
+
+
 namespace zlist_funcs {
     // Zlist evaluation functions (funcs_math.cc)
     bool PTminusZ(Variable*, Variable*, void*);
@@ -925,6 +925,78 @@ CDs::checkInstances()
 }
 
 
+// End bulk mode (see CDdb::db_end_bulk) and create the layer
+// databases.  When reading, the test for coincident objects, which is
+// skipped while objects are being added in bulk mode, is done here.
+//
+bool
+CDs::endBulkLoad()
+{
+    if (!db_is_bulk())
+        return (true);
+    bool chk = CD()->IsReading() && CD()->DupCheckMode() != cCD::DupNoTest;
+    CDl **lds = 0;
+    unsigned int nl = 0;
+    if (chk) {
+        lds = new CDl*[db_layers_used];
+        for (unsigned int i = 0; i < db_layers_used; i++) {
+            CDtree *l = db_layer_heads + i;
+            if (l->is_deferred() && l->ldesc() != CellLayer())
+                lds[nl++] = l->ldesc();
+        }
+    }
+    bool ok = db_end_bulk();
+
+    const char *what = "kept";
+    if (CD()->DupCheckMode() == cCD::DupRemove)
+        what = "removed";
+    CDol *dups = 0;
+    for (unsigned int i = 0; i < nl; i++) {
+        CDtree *l = db_find_layer_head(lds[i]);
+        if (!l)
+            continue;
+        for (CDo *od = (CDo*)l->first_element(); od; od = od->db_next()) {
+            if (!db_check_coinc(od))
+                continue;
+            const char *nm = "object";
+            if (od->type() == CDBOX)
+                nm = "box";
+            else if (od->type() == CDPOLYGON)
+                nm = "polygon";
+            else if (od->type() == CDWIRE)
+                nm = "wire";
+            else if (od->type() == CDLABEL)
+                nm = "label";
+
+            char tbf[64];
+            int c = CD()->CheckCoincErrs();
+            if (c < 0) {
+                snprintf(tbf, 64, "coincident %s (%s)", nm, what);
+                CD()->ifPrintCvLog(IFLOG_WARN, "%s [%s %d,%d %s].", tbf,
+                    Tstring(cellname()), od->oBB().left, od->oBB().top,
+                    od->ldesc()->name());
+            }
+            else if (c == 0) {
+                snprintf(tbf, 64, "more coincident objects (%s)", what);
+                CD()->ifPrintCvLog(IFLOG_WARN, "%s [%s].", tbf,
+                    Tstring(cellname()));
+            }
+            if (CD()->DupCheckMode() == cCD::DupRemove)
+                dups = new CDol(od, dups);
+        }
+    }
+    delete [] lds;
+    while (dups) {
+        CDol *ox = dups;
+        dups = dups->next;
+        if (!unlink(ox->odesc, false))
+            CD()->ifPrintCvLog(IFLOG_WARN, "%s", Errs()->get_error());
+        delete ox;
+    }
+    return (ok);
+}
+
+
 // Return true if there is an underlying connection point.
 //
 bool
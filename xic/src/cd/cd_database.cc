@@ -139,6 +139,40 @@ CDdb::db_insert_deferred_instances()
 }
 
 
+// In bulk mode, initiated with db_begin_bulk, the databases for
+// layers that are created in this while the mode is active are set to
+// deferred mode, so that objects are simply linked as they are added.
+// Instances are excluded.  Calling db_end_bulk sorts the objects and
+// packs them into the databases (see RTree::bulk_load), which is much
+// faster than adding the objects one at a time.  This is used when
+// reading a cell from a file or flattening into an empty cell.  While
+// in bulk mode, the database can't be searched for objects on these
+// layers.
+
+// End bulk mode, and create the databases for the layers that were
+// populated in bulk mode.
+//
+bool
+CDdb::db_end_bulk()
+{
+    if (!db_bulk)
+        return (true);
+    db_bulk = false;
+    bool ok = true;
+    for (unsigned int i = 0; i < db_layers_used; i++) {
+        CDtree *l = db_layer_heads + i;
+        if (!l->is_deferred())
+            continue;
+        if (l->ldesc()->index(Physical) == 0 ||
+                l->ldesc()->index(Electrical) == 0)
+            continue;
+        if (!l->unset_deferred())
+            ok = false;
+    }
+    return (ok);
+}
+
+
 namespace {
     // Lock the insert/remove functions, as they are used in layer
     // expression evaluation which is where multi-threading is applied
@@ -199,6 +233,8 @@ CDdb::db_insert(CDo *odesc)
 
         if (CD()->IsDeferInst() && odesc->type() == CDINSTANCE)
             l->set_deferred();
+        else if (db_bulk && odesc->type() != CDINSTANCE)
+            l->set_deferred();
     }
     bool ret = l->insert(odesc);
     pthread_mutex_unlock(&db_mtx);
@@ -375,6 +411,13 @@ CDdb::db_clear()
 bool
 CDdb::db_check_coinc(CDo *od)
 {
+    if (db_bulk) {
+        // Objects are only linked, these are checked after the
+        // database is created.
+        CDtree *l = db_find_layer_head(od->ldesc());
+        if (l && l->is_deferred())
+            return (false);
+    }
     for (CDo *o = od->db_next(); o; o = o->db_next()) {
         if (od->oBB().top != o->oBB().top || od->oBB().left != o->oBB().left)
             break;
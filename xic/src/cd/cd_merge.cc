@@ -43,9 +43,16 @@
 #include "cd_hypertext.h"
 #include "cd_propnum.h"
 #include "geo_zlist.h"
+#include "geo_ylist.h"
+#include "miscutil/threadpool.h"
 #include <algorithm>
 
 
+// Minimum count of boxes to search, or of groups to merge, for
+// CDs::endDeferredMerge to use helper threads.
+#define MRG_PARALLEL_MIN 4096
+
+
 //
 // Functions for merging new objects with existing objects in the
 // database.
@@ -392,7 +399,9 @@ CDs::mergeBoxOrPoly(CDo *odesc, bool Undoable)
 
 // Merge the specifed box, which already exists in the database, with
 // neighboring boxes, if possible.  This is (optionally) called from
-// the I/O file readers when adding boxes to the database.
+// the I/O file readers when adding boxes to the database.  If merging
+// is deferred and the operation is not undoable, the box will be
+// merged in endDeferredMerge.
 //
 bool
 CDs::mergeBox(CDo *odesc, bool Undoable)
@@ -403,6 +412,8 @@ CDs::mergeBox(CDo *odesc, bool Undoable)
         return (true);
     if (odesc->ldesc()->isNoMerge())
         return (true);
+    if (db_merge_deferred && !Undoable)
+        return (true);
 
     BBox tBB = odesc->oBB();
     CDg gdesc;
@@ -647,6 +658,552 @@ CDs::mergeWire(CDw *wdesc, bool Undoable, CDw **pnew)
 
     return (ret);
 }
+
+
+namespace {
+    // Return true if ClipMerge would combine boxes with these
+    // bounding boxes:  they overlap, or they touch and have the same
+    // left and right, or the same bottom and top.
+    //
+    inline bool
+    mrg_partners(const BBox &b1, const BBox &b2)
+    {
+        if (b1.right < b2.left || b1.left > b2.right ||
+                b1.top < b2.bottom || b1.bottom > b2.top)
+            return (false);
+        if (b1.left == b2.left && b1.right == b2.right)
+            return (true);
+        if (b1.bottom == b2.bottom && b1.top == b2.top)
+            return (true);
+        return (b1.right > b2.left && b1.left < b2.right &&
+            b1.top > b2.bottom && b1.bottom < b2.top);
+    }
+
+
+    // Return true if the object is a box that can be merged.
+    //
+    inline bool
+    mrg_eligible(const CDo *od)
+    {
+        return (od->type() == CDBOX && od->is_normal() &&
+            !od->has_flag(CDnoMerge));
+    }
+
+
+    // Pair of boxes that would be merged.
+    //
+    struct mrg_pair_t
+    {
+        CDo *o1;
+        CDo *o2;
+    };
+
+
+    // A box created by merging, and its group.
+    //
+    struct mrg_tag_t
+    {
+        CDo *odesc;
+        unsigned int group;
+    };
+
+
+    inline bool
+    mrg_tag_cmp(const mrg_tag_t &t1, const mrg_tag_t &t2)
+    {
+        return (t1.odesc < t2.odesc);
+    }
+
+
+    // Return the group of od if it is in the sorted tags array, or
+    // -1.
+    //
+    inline int
+    mrg_group(const mrg_tag_t *tags, unsigned int ntags, CDo *od)
+    {
+        mrg_tag_t t;
+        t.odesc = od;
+        const mrg_tag_t *tp = std::lower_bound(tags, tags + ntags, t,
+            mrg_tag_cmp);
+        if (tp == tags + ntags || tp->odesc != od)
+            return (-1);
+        return (tp->group);
+    }
+
+
+    // Partner search for a tile of boxes.  The boxes are taken in
+    // database order, so a tile is a horizontal band of the layer. 
+    // The layer database is only read here.
+    //
+    struct mrg_find_job_t
+    {
+        mrg_find_job_t()
+            {
+                tree = 0;
+                boxes = 0;
+                nboxes = 0;
+                tags = 0;
+                ntags = 0;
+                pairs = 0;
+                npairs = 0;
+                pairsz = 0;
+            }
+
+        ~mrg_find_job_t()
+            {
+                delete [] pairs;
+            }
+
+        void find();
+
+        const RTree *tree;      // layer database
+        CDo **boxes;            // boxes to find partners for
+        unsigned int nboxes;    // boxes length
+        const mrg_tag_t *tags;  // groups of boxes from the last pass
+        unsigned int ntags;     // tags length
+        mrg_pair_t *pairs;      // partners found
+        unsigned int npairs;    // pairs length
+        unsigned int pairsz;    // pairs allocated size
+
+    private:
+        void add(CDo*, CDo*);
+    };
+
+
+    void
+    mrg_find_job_t::find()
+    {
+        for (unsigned int i = 0; i < nboxes; i++) {
+            CDo *od = boxes[i];
+            int grp = tags ? mrg_group(tags, ntags, od) : -1;
+            RTgen gen;
+            gen.init(tree, &od->oBB());
+            RTelem *rt;
+            while ((rt = gen.next_element()) != 0) {
+                CDo *pointer = (CDo*)rt;
+                if (pointer == od || !mrg_eligible(pointer))
+                    continue;
+                if (!mrg_partners(od->oBB(), pointer->oBB()))
+                    continue;
+                // Boxes from the same group are already merged.
+                if (grp >= 0 && mrg_group(tags, ntags, pointer) == grp)
+                    continue;
+                add(od, pointer);
+            }
+        }
+    }
+
+
+    void
+    mrg_find_job_t::add(CDo *o1, CDo *o2)
+    {
+        if (npairs >= pairsz) {
+            unsigned int sz = pairsz ? pairsz + pairsz : 256;
+            mrg_pair_t *t = new mrg_pair_t[sz];
+            if (npairs)
+                memcpy(t, pairs, npairs*sizeof(mrg_pair_t));
+            delete [] pairs;
+            pairs = t;
+            pairsz = sz;
+        }
+        pairs[npairs].o1 = o1;
+        pairs[npairs].o2 = o2;
+        npairs++;
+    }
+
+
+    int
+    mrg_find_proc(sTPthreadData*, void *arg)
+    {
+        ((mrg_find_job_t*)arg)->find();
+        return (0);
+    }
+
+
+    // A group of boxes that merge together, and the trapezoids of
+    // their union.
+    //
+    struct mrg_group_t
+    {
+        CDo **boxes;            // group members
+        unsigned int nboxes;    // boxes length
+        Zlist *zlist;           // merged result
+        bool failed;            // repartition threw
+    };
+
+
+    // Merge a range of groups.
+    //
+    struct mrg_join_job_t
+    {
+        mrg_group_t *groups;
+        unsigned int ngroups;
+    };
+
+
+    int
+    mrg_join_proc(sTPthreadData*, void *arg)
+    {
+        mrg_join_job_t *job = (mrg_join_job_t*)arg;
+        for (unsigned int i = 0; i < job->ngroups; i++) {
+            mrg_group_t *g = job->groups + i;
+            Zlist *z0 = 0;
+            for (unsigned int j = 0; j < g->nboxes; j++)
+                z0 = new Zlist(&g->boxes[j]->oBB(), z0);
+            try {
+                g->zlist = Zlist::repartition(z0);
+            }
+            catch (XIrt) {
+                g->zlist = 0;
+                g->failed = true;
+            }
+        }
+        return (0);
+    }
+
+
+    // Union-find root with path halving.
+    //
+    inline unsigned int
+    mrg_root(unsigned int *parent, unsigned int i)
+    {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return (i);
+    }
+
+
+    struct mrg_node_t
+    {
+        unsigned int root;
+        CDo *odesc;
+    };
+
+
+    inline bool
+    mrg_node_cmp(const mrg_node_t &n1, const mrg_node_t &n2)
+    {
+        return (n1.root < n2.root);
+    }
+
+
+    // Return group members taken out of the database to the
+    // database, after an error.
+    //
+    void
+    mrg_restore(CDs *sdesc, CDo **boxes, unsigned int n)
+    {
+        for (unsigned int i = 0; i < n; i++) {
+            boxes[i]->set_state(CDobjVanilla);
+            sdesc->insert(boxes[i]);
+        }
+    }
+
+
+    // Run the jobs, using helper threads if there are enough items.
+    //
+    void
+    mrg_run(TPthreadJob proc, void *jobs, size_t jsz, int njobs,
+        unsigned int nitems)
+    {
+        int nth = GEO()->numThreads();
+        if (njobs > 1 && nth > 0 && nitems >= MRG_PARALLEL_MIN &&
+                GEO()->inMainThread()) {
+            cThreadPool pool(nth);
+            for (int i = 0; i < njobs; i++)
+                pool.submit(proc, (char*)jobs + i*jsz);
+            pool.run(0);
+            return;
+        }
+        for (int i = 0; i < njobs; i++)
+            (*proc)(0, (char*)jobs + i*jsz);
+    }
+}
+
+
+// Merge the boxes on all layers, after merging was deferred with
+// db_begin_deferred_merge.  All mergeable boxes on the layers are
+// considered.  This gives the same geometry as merging the boxes one
+// at a time with mergeBox, but the work is done in a few passes over
+// each layer.  As with mergeBox, where the result depends on the
+// order, a merged region may be divided into boxes differently.
+//
+// In each pass, the layer is divided into horizontal tiles, and the
+// partners of each box are found, in parallel if Threads is set. 
+// Boxes that would be combined are collected into groups, and the
+// union of each group is decomposed into boxes with a scan-line
+// repartition, again in parallel.  The new boxes replace the group
+// members in the database, and are the subject of the next pass,
+// since they may now combine with other boxes, as when mergeBox
+// calls itself for a new box.  Boxes that have no partner are never
+// touched.
+//
+// The layer databases must be searchable, so if bulk mode is active,
+// endBulkLoad should be called first.
+//
+bool
+CDs::endDeferredMerge()
+{
+    if (!db_merge_deferred)
+        return (true);
+    db_merge_deferred = false;
+
+    unsigned int nl = 0;
+    CDl **lds = new CDl*[db_layers_used + 1];
+    for (unsigned int i = 0; i < db_layers_used; i++) {
+        CDl *ld = db_layer_heads[i].ldesc();
+        if (ld == CellLayer() || ld->isNoMerge())
+            continue;
+        lds[nl++] = ld;
+    }
+
+    bool ok = true;
+    int nth = GEO()->numThreads();
+    for (unsigned int il = 0; ok && il < nl; il++) {
+        CDl *ld = lds[il];
+        CDtree *tree = db_find_layer_head(ld);
+        if (!tree)
+            continue;
+
+        // To start, every mergeable box is searched.
+        unsigned int nb = 0;
+        for (CDo *od = (CDo*)tree->first_element(); od; od = od->db_next()) {
+            if (mrg_eligible(od))
+                nb++;
+        }
+        CDo **boxes = new CDo*[nb ? nb : 1];
+        nb = 0;
+        for (CDo *od = (CDo*)tree->first_element(); od; od = od->db_next()) {
+            if (mrg_eligible(od))
+                boxes[nb++] = od;
+        }
+
+        mrg_tag_t *tags = 0;
+        unsigned int ntgroups = 0;
+        while (nb) {
+            // Find the partners, by tiles.
+            int nj = nth + 1;
+            mrg_find_job_t *fjobs = new mrg_find_job_t[nj];
+            unsigned int tsz = (nb + nj - 1)/nj;
+            for (int i = 0; i < nj; i++) {
+                unsigned int b = i*tsz;
+                fjobs[i].tree = tree;
+                fjobs[i].boxes = boxes + b;
+                fjobs[i].nboxes = b < nb ? mmMin(tsz, nb - b) : 0;
+                fjobs[i].tags = tags;
+                fjobs[i].ntags = tags ? nb : 0;
+            }
+            mrg_run(mrg_find_proc, fjobs, sizeof(mrg_find_job_t), nj, nb);
+            delete [] boxes;
+            boxes = 0;
+
+            unsigned int np = 0;
+            for (int i = 0; i < nj; i++)
+                np += fjobs[i].npairs;
+            if (!np) {
+                delete [] fjobs;
+                break;
+            }
+
+            // The objects that have partners, and the boxes from the
+            // last pass, sorted for lookup.
+            unsigned int ntg = tags ? nb : 0;
+            CDo **objs = new CDo*[2*np + ntg];
+            unsigned int no = 0;
+            for (int i = 0; i < nj; i++) {
+                for (unsigned int j = 0; j < fjobs[i].npairs; j++) {
+                    objs[no++] = fjobs[i].pairs[j].o1;
+                    objs[no++] = fjobs[i].pairs[j].o2;
+                }
+            }
+            for (unsigned int i = 0; i < ntg; i++)
+                objs[no++] = tags[i].odesc;
+            std::sort(objs, objs + no);
+            no = std::unique(objs, objs + no) - objs;
+
+            // Group the objects.
+            unsigned int *parent = new unsigned int[no];
+            bool *paired = new bool[no];
+            for (unsigned int i = 0; i < no; i++) {
+                parent[i] = i;
+                paired[i] = false;
+            }
+            for (int i = 0; i < nj; i++) {
+                for (unsigned int j = 0; j < fjobs[i].npairs; j++) {
+                    unsigned int i1 = std::lower_bound(objs, objs + no,
+                        fjobs[i].pairs[j].o1) - objs;
+                    unsigned int i2 = std::lower_bound(objs, objs + no,
+                        fjobs[i].pairs[j].o2) - objs;
+                    paired[i1] = true;
+                    paired[i2] = true;
+                    i1 = mrg_root(parent, i1);
+                    i2 = mrg_root(parent, i2);
+                    if (i1 != i2)
+                        parent[i1 < i2 ? i2 : i1] = i1 < i2 ? i1 : i2;
+                }
+            }
+            delete [] fjobs;
+
+            // The boxes from a group of the last pass stay together,
+            // so that each group is the whole of a merged region.  This
+            // assures that every pass reduces the region count.
+            if (ntg) {
+                unsigned int *first = new unsigned int[ntgroups];
+                for (unsigned int i = 0; i < ntgroups; i++)
+                    first[i] = no;
+                for (unsigned int i = 0; i < ntg; i++) {
+                    unsigned int i1 = std::lower_bound(objs, objs + no,
+                        tags[i].odesc) - objs;
+                    unsigned int g = tags[i].group;
+                    if (first[g] == no) {
+                        first[g] = i1;
+                        continue;
+                    }
+                    unsigned int i2 = mrg_root(parent, first[g]);
+                    i1 = mrg_root(parent, i1);
+                    if (i1 != i2)
+                        parent[i1 < i2 ? i2 : i1] = i1 < i2 ? i1 : i2;
+                }
+                delete [] first;
+            }
+            delete [] tags;
+            tags = 0;
+
+            // Groups without a partner pair are left alone.
+            for (unsigned int i = 0; i < no; i++) {
+                if (paired[i])
+                    paired[mrg_root(parent, i)] = true;
+            }
+            mrg_node_t *nodes = new mrg_node_t[no];
+            unsigned int nn = 0;
+            for (unsigned int i = 0; i < no; i++) {
+                unsigned int r = mrg_root(parent, i);
+                if (!paired[r])
+                    continue;
+                nodes[nn].root = r;
+                nodes[nn].odesc = objs[i];
+                nn++;
+            }
+            delete [] parent;
+            delete [] paired;
+            no = nn;
+            std::sort(nodes, nodes + no, mrg_node_cmp);
+            for (unsigned int i = 0; i < no; i++)
+                objs[i] = nodes[i].odesc;
+
+            unsigned int ng = 0;
+            for (unsigned int i = 0; i < no; i++) {
+                if (!i || nodes[i].root != nodes[i-1].root)
+                    ng++;
+            }
+            mrg_group_t *groups = new mrg_group_t[ng];
+            ng = 0;
+            for (unsigned int i = 0; i < no; i++) {
+                if (!i || nodes[i].root != nodes[i-1].root) {
+                    groups[ng].boxes = objs + i;
+                    groups[ng].nboxes = 0;
+                    groups[ng].zlist = 0;
+                    groups[ng].failed = false;
+                    ng++;
+                }
+                groups[ng-1].nboxes++;
+            }
+            delete [] nodes;
+
+            // Merge the groups.
+            nj = nth + 1;
+            mrg_join_job_t *jjobs = new mrg_join_job_t[nj];
+            unsigned int gsz = (ng + nj - 1)/nj;
+            for (int i = 0; i < nj; i++) {
+                unsigned int g = i*gsz;
+                jjobs[i].groups = groups + g;
+                jjobs[i].ngroups = g < ng ? mmMin(gsz, ng - g) : 0;
+            }
+            mrg_run(mrg_join_proc, jjobs, sizeof(mrg_join_job_t), nj, ng);
+            delete [] jjobs;
+
+            // Replace the group members with the new boxes, which are
+            // searched in the next pass.
+            nb = 0;
+            for (unsigned int i = 0; i < ng; i++)
+                nb += Zlist::length(groups[i].zlist);
+            boxes = new CDo*[nb ? nb : 1];
+            tags = new mrg_tag_t[nb ? nb : 1];
+            nb = 0;
+            for (unsigned int i = 0; i < ng; i++) {
+                mrg_group_t *g = groups + i;
+                if (g->failed || !ok) {
+                    Zlist::destroy(g->zlist);
+                    ok = false;
+                    continue;
+                }
+                // Take the members out of the database before adding
+                // the new boxes, as in ClipMerge, so that a new box that
+                // matches a member is not taken as a duplicate.  The
+                // members are kept for their properties.
+                unsigned int nu = 0;
+                for ( ; nu < g->nboxes; nu++) {
+                    if (!unlink(g->boxes[nu], true))
+                        break;
+                }
+                if (nu < g->nboxes) {
+                    mrg_restore(this, g->boxes, nu);
+                    Zlist::destroy(g->zlist);
+                    ok = false;
+                    continue;
+                }
+                bool has_prps = false;
+                for (unsigned int j = 0; j < g->nboxes; j++) {
+                    if (g->boxes[j]->prpty_list()) {
+                        has_prps = true;
+                        break;
+                    }
+                }
+                for (Zlist *z = g->zlist; z; z = z->next) {
+                    BBox BB(z->Z.xll, z->Z.yl, z->Z.xur, z->Z.yu);
+                    CDo *newo;
+                    if (makeBox(ld, &BB, &newo) != CDok) {
+                        ok = false;
+                        break;
+                    }
+                    if (!newo)
+                        continue;
+                    if (has_prps) {
+                        prp_accum_t acc(isElectrical());
+                        for (unsigned int j = 0; j < g->nboxes; j++) {
+                            if (newo->intersect(g->boxes[j], false))
+                                acc.add_properties(g->boxes[j]);
+                        }
+                        newo->set_prpty_list(acc.list_properties());
+                    }
+                    tags[nb].odesc = newo;
+                    tags[nb].group = i;
+                    boxes[nb++] = newo;
+                }
+                Zlist::destroy(g->zlist);
+                if (!ok) {
+                    // Don't lose geometry, put the members back.
+                    mrg_restore(this, g->boxes, g->nboxes);
+                    continue;
+                }
+                for (unsigned int j = 0; j < g->nboxes; j++)
+                    delete g->boxes[j];
+            }
+            delete [] groups;
+            delete [] objs;
+            if (!ok)
+                break;
+            std::sort(tags, tags + nb, mrg_tag_cmp);
+            ntgroups = ng;
+        }
+        delete [] boxes;
+        delete [] tags;
+    }
+    delete [] lds;
+    return (ok);
+}
 // End of CDs functions.
 
 
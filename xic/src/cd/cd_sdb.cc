@@ -42,6 +42,10 @@
 #include "cd_types.h"
 #include "cd_sdb.h"
 #include "geo_ylist.h"
+#include "geo_poly.h"
+#include "geo_wire.h"
+#include <algorithm>
+#include <math.h>
 
 
 // Print the bin dimensions before calling merge.
@@ -138,6 +142,8 @@ cCDsdbDB::listDB()
             dbt = "(Zldb)";
         else if (db->type() == sdbZbdb)
             dbt = "(Zbdb)";
+        else if (db->type() == sdbPdb)
+            dbt = "(Pdb)";
         else
             continue;
         snprintf(buf, 256, "%-20s %s", db->name(), dbt);
@@ -197,9 +203,9 @@ cCDsdbDB::destroyDB(const char *name)
 
 // The "special" database: cSDB
 // This is a polymorphic symbol table, stored by name in cCDsdbDB. 
-// The element can be odb_t, zdb_t, etc., according to the type field. 
-// All have in common that the elements are referenced by the layer
-// descriptor pointers, and represent geometry.
+// The element can be odb_t, zdb_t, pdb_t, etc., according to the type
+// field.  All have in common that the elements are referenced by the
+// layer descriptor pointers, and represent geometry.
 
 cSDB::cSDB(const char *n, SymTab *d, sdbType t)
 {
@@ -208,7 +214,8 @@ cSDB::cSDB(const char *n, SymTab *d, sdbType t)
     dbtype = t;
     dbowner = 0;
     if (db) {
-        if (dbtype == sdbBdb || dbtype == sdbOdb || dbtype == sdbZdb) {
+        if (dbtype == sdbBdb || dbtype == sdbOdb || dbtype == sdbZdb ||
+                dbtype == sdbPdb) {
             SymTabGen gen(db);
             SymTabEnt *h;
             bool first = true;
@@ -279,6 +286,13 @@ cSDB::~cSDB()
             delete h;
         }
     }
+    else if (dbtype == sdbPdb) {
+        SymTabEnt *h;
+        while ((h = gen.next()) != 0) {
+            delete (pdb_t*)h->stData;
+            delete h;
+        }
+    }
     delete db;
 }
 
@@ -877,6 +891,420 @@ zdb_t::setup_col(unsigned int num, int xmin, int xmax)
 }
 
 
+//----------------------------------------------------------------------------
+// Struct pdb_t
+// This is a packed list of boxes, polygons, and wires, with a static
+// spatial index.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Sort-Tile-Recursive ordering.  The records are sorted by the x
+    // center into vertical slabs of about sqrt(nodes) index nodes
+    // each, then each slab is sorted by the y center.  The index
+    // nodes then cover compact, nearly square areas.
+
+    inline long long xcen(const BBox &BB)
+    {
+        return ((long long)BB.left + BB.right);
+    }
+
+    inline long long ycen(const BBox &BB)
+    {
+        return ((long long)BB.bottom + BB.top);
+    }
+
+    bool box_xcmp(const BBox &b1, const BBox &b2)
+    {
+        return (xcen(b1) < xcen(b2));
+    }
+
+    bool box_ycmp(const BBox &b1, const BBox &b2)
+    {
+        return (ycen(b1) < ycen(b2));
+    }
+
+    bool path_xcmp(const pdb_path_t &p1, const pdb_path_t &p2)
+    {
+        return (xcen(p1.BB) < xcen(p2.BB));
+    }
+
+    bool path_ycmp(const pdb_path_t &p1, const pdb_path_t &p2)
+    {
+        return (ycen(p1.BB) < ycen(p2.BB));
+    }
+
+    template <class T> void
+    str_sort(T *ary, unsigned int n, bool(*xcmp)(const T&, const T&),
+        bool(*ycmp)(const T&, const T&))
+    {
+        if (n <= PDB_FANOUT)
+            return;
+        std::sort(ary, ary + n, xcmp);
+        unsigned int nnodes = (n + PDB_FANOUT - 1)/PDB_FANOUT;
+        unsigned int nslabs = (unsigned int)ceil(sqrt((double)nnodes));
+        unsigned int ssz = ((nnodes + nslabs - 1)/nslabs)*PDB_FANOUT;
+        for (unsigned int i = 0; i < n; i += ssz)
+            std::sort(ary + i, ary + mmMin(n, i + ssz), ycmp);
+    }
+}
+
+
+// Build the index for the n records, each of size stride bytes
+// starting at base.  Each record begins with its bounding box.  No
+// index is needed if the records fit in one node.
+//
+void
+pdb_index_t::build(const char *base, unsigned int stride, unsigned int n)
+{
+    delete [] ix_BBs;
+    ix_BBs = 0;
+    ix_nlevels = 0;
+    if (n <= PDB_FANOUT)
+        return;
+
+    unsigned int tot = 0;
+    unsigned int c = n;
+    do {
+        c = (c + PDB_FANOUT - 1)/PDB_FANOUT;
+        ix_off[ix_nlevels] = tot;
+        ix_cnt[ix_nlevels] = c;
+        ix_nlevels++;
+        tot += c;
+    } while (c > 1 && ix_nlevels < PDB_MAXLEV);
+    ix_BBs = new BBox[tot];
+
+    for (unsigned int j = 0; j < ix_cnt[0]; j++) {
+        unsigned int i = j*PDB_FANOUT;
+        unsigned int e = mmMin(n, i + PDB_FANOUT);
+        BBox BB = *(const BBox*)(base + (size_t)i*stride);
+        for (i++; i < e; i++)
+            BB.add((const BBox*)(base + (size_t)i*stride));
+        ix_BBs[j] = BB;
+    }
+    for (unsigned int k = 1; k < ix_nlevels; k++) {
+        const BBox *bl = ix_BBs + ix_off[k-1];
+        for (unsigned int j = 0; j < ix_cnt[k]; j++) {
+            unsigned int i = j*PDB_FANOUT;
+            unsigned int e = mmMin(ix_cnt[k-1], i + PDB_FANOUT);
+            BBox BB = bl[i];
+            for (i++; i < e; i++)
+                BB.add(&bl[i]);
+            ix_BBs[ix_off[k] + j] = BB;
+        }
+    }
+}
+
+
+pdb_t::~pdb_t()
+{
+    delete [] pdb_boxes;
+    delete [] pdb_paths;
+    delete [] pdb_points;
+}
+
+
+void
+pdb_t::get_poly(const pdb_path_t *p, Poly *po) const
+{
+    po->points = pdb_points + p->offset;
+    po->numpts = p->numpts;
+}
+
+
+void
+pdb_t::get_wire(const pdb_path_t *p, Wire *w) const
+{
+    w->points = pdb_points + p->offset;
+    w->numpts = p->numpts;
+    w->attributes = p->attributes;
+}
+
+
+// Add a box to the database.
+//
+void
+pdb_t::add(const BBox *BB)
+{
+    if (pdb_nboxes >= pdb_boxsz) {
+        unsigned int sz = pdb_boxsz ? pdb_boxsz + pdb_boxsz : 16;
+        BBox *t = new BBox[sz];
+        if (pdb_nboxes)
+            memcpy(t, pdb_boxes, pdb_nboxes*sizeof(BBox));
+        delete [] pdb_boxes;
+        pdb_boxes = t;
+        pdb_boxsz = sz;
+    }
+    if (!db_num_objects)
+        db_BB = *BB;
+    else
+        db_BB.add(BB);
+    pdb_boxes[pdb_nboxes++] = *BB;
+    db_num_objects++;
+    pdb_frozen = false;
+}
+
+
+// Add a polygon to the database, the points are copied.
+//
+void
+pdb_t::add(const Poly *po)
+{
+    if (!po || po->numpts < 4)
+        return;
+    BBox BB;
+    po->computeBB(&BB);
+    add_path(po->points, po->numpts, 0, CDPOLYGON, &BB);
+}
+
+
+// Add a wire to the database, the points are copied.
+//
+void
+pdb_t::add(const Wire *w)
+{
+    if (!w || w->numpts < 1)
+        return;
+    BBox BB;
+    w->computeBB(&BB);
+    add_path(w->points, w->numpts, w->attributes, CDWIRE, &BB);
+}
+
+
+// Spatially sort the objects and build the index, and release unused
+// array space.  This must be called after adding objects, and before
+// access.
+//
+void
+pdb_t::freeze()
+{
+    if (pdb_frozen)
+        return;
+
+    if (pdb_nboxes < pdb_boxsz) {
+        BBox *t = 0;
+        if (pdb_nboxes) {
+            t = new BBox[pdb_nboxes];
+            memcpy(t, pdb_boxes, pdb_nboxes*sizeof(BBox));
+        }
+        delete [] pdb_boxes;
+        pdb_boxes = t;
+        pdb_boxsz = pdb_nboxes;
+    }
+    str_sort(pdb_boxes, pdb_nboxes, box_xcmp, box_ycmp);
+    pdb_boxidx.build((const char*)pdb_boxes, sizeof(BBox), pdb_nboxes);
+
+    if (pdb_npaths < pdb_pathsz) {
+        pdb_path_t *t = 0;
+        if (pdb_npaths) {
+            t = new pdb_path_t[pdb_npaths];
+            memcpy(t, pdb_paths, pdb_npaths*sizeof(pdb_path_t));
+        }
+        delete [] pdb_paths;
+        pdb_paths = t;
+        pdb_pathsz = pdb_npaths;
+    }
+    str_sort(pdb_paths, pdb_npaths, path_xcmp, path_ycmp);
+    pdb_pathidx.build((const char*)pdb_paths, sizeof(pdb_path_t),
+        pdb_npaths);
+
+    // Put the vertices in the same order as the records, for locality.
+    if (pdb_npoints) {
+        Point *pts = new Point[pdb_npoints];
+        unsigned int off = 0;
+        for (unsigned int i = 0; i < pdb_npaths; i++) {
+            pdb_path_t *p = pdb_paths + i;
+            memcpy(pts + off, pdb_points + p->offset,
+                p->numpts*sizeof(Point));
+            p->offset = off;
+            off += p->numpts;
+        }
+        delete [] pdb_points;
+        pdb_points = pts;
+        pdb_ptsz = pdb_npoints;
+    }
+    pdb_frozen = true;
+}
+
+
+// Return a list of the zoids from objects clipped to zref.
+//
+Zlist *
+pdb_t::getZlist(const Zlist *zref, XIrt *retp)
+{
+    freeze();
+    Zlist *z0 = 0;
+    *retp = XIok;
+    for (const Zlist *zl = zref; zl; zl = zl->next) {
+        BBox BB;
+        zl->Z.BB(&BB);
+        bool manh = zl->Z.is_rect();
+
+        pdb_gen gen(this, &BB);
+        const BBox *pBB;
+        while ((pBB = gen.next_box()) != 0) {
+            Zlist *zx = new Zlist(pBB);
+            if (!manh || !(*pBB <= BB))
+                Zlist::zl_and(&zx, &zl->Z);
+            if (zx) {
+                Zlist *zn = zx;
+                while (zn->next)
+                    zn = zn->next;
+                zn->next = z0;
+                z0 = zx;
+            }
+        }
+        const pdb_path_t *p;
+        while ((p = gen.next_path()) != 0) {
+            Zlist *zx;
+            if (p->type == CDWIRE) {
+                Wire w;
+                get_wire(p, &w);
+                zx = w.toZlist();
+            }
+            else {
+                Poly po;
+                get_poly(p, &po);
+                zx = po.toZlist();
+            }
+            if (!manh || !(p->BB <= BB))
+                Zlist::zl_and(&zx, &zl->Z);
+            if (zx) {
+                Zlist *zn = zx;
+                while (zn->next)
+                    zn = zn->next;
+                zn->next = z0;
+                z0 = zx;
+            }
+        }
+    }
+    try {
+        z0 = Zlist::repartition(z0);
+        return (z0);
+    }
+    catch (XIrt ret) {
+        *retp = ret;
+        return (0);
+    }
+}
+
+
+void
+pdb_t::add_path(const Point *pts, unsigned int num, unsigned int attr,
+    char type, const BBox *BB)
+{
+    if (pdb_npaths >= pdb_pathsz) {
+        unsigned int sz = pdb_pathsz ? pdb_pathsz + pdb_pathsz : 16;
+        pdb_path_t *t = new pdb_path_t[sz];
+        if (pdb_npaths)
+            memcpy(t, pdb_paths, pdb_npaths*sizeof(pdb_path_t));
+        delete [] pdb_paths;
+        pdb_paths = t;
+        pdb_pathsz = sz;
+    }
+    if (pdb_npoints + num > pdb_ptsz) {
+        unsigned int sz = pdb_ptsz ? pdb_ptsz + pdb_ptsz : 64;
+        while (sz < pdb_npoints + num)
+            sz += sz;
+        Point *t = new Point[sz];
+        if (pdb_npoints)
+            memcpy(t, pdb_points, pdb_npoints*sizeof(Point));
+        delete [] pdb_points;
+        pdb_points = t;
+        pdb_ptsz = sz;
+    }
+    pdb_path_t *p = pdb_paths + pdb_npaths++;
+    p->BB = *BB;
+    p->offset = pdb_npoints;
+    p->numpts = num;
+    p->attributes = attr;
+    p->type = type;
+    memcpy(pdb_points + pdb_npoints, pts, num*sizeof(Point));
+    pdb_npoints += num;
+
+    if (!db_num_objects)
+        db_BB = *BB;
+    else
+        db_BB.add(BB);
+    db_num_objects++;
+    pdb_frozen = false;
+}
+// End of pdb_t functions.
+
+
+pdb_gen::pdb_gen(const pdb_t *db, const BBox *AOI)
+{
+    g_db = db;
+    g_AOI = *AOI;
+    g_boxes = true;
+    if (g_db)
+        init_walk(&g_db->pdb_boxidx, g_db->pdb_nboxes);
+    else {
+        g_cur = g_end = 0;
+        g_sp = 0;
+    }
+}
+
+
+// Set up to walk the n records indexed by ix.
+//
+void
+pdb_gen::init_walk(const pdb_index_t *ix, unsigned int n)
+{
+    g_cur = 0;
+    g_end = 0;
+    g_sp = 0;
+    if (!n)
+        return;
+    if (!ix->ix_nlevels) {
+        // No index, scan the records.
+        g_end = n;
+        return;
+    }
+    g_stk[0] = ix->ix_nlevels - 1;
+    g_stn[0] = 0;
+    g_sp = 1;
+}
+
+
+// Return the next record that overlaps the AOI, or 0 when done.
+//
+const char *
+pdb_gen::next_rec(const pdb_index_t *ix, const char *base,
+    unsigned int stride, unsigned int n)
+{
+    for (;;) {
+        while (g_cur < g_end) {
+            const BBox *BB = (const BBox*)(base + (size_t)g_cur*stride);
+            g_cur++;
+            if (BB->intersect(&g_AOI, false))
+                return ((const char*)BB);
+        }
+        if (!g_sp)
+            return (0);
+        g_sp--;
+        unsigned int k = g_stk[g_sp];
+        unsigned int j = g_stn[g_sp];
+        if (!ix->ix_BBs[ix->ix_off[k] + j].intersect(&g_AOI, false))
+            continue;
+        unsigned int c0 = j*PDB_FANOUT;
+        if (k == 0) {
+            g_cur = c0;
+            g_end = mmMin(n, c0 + PDB_FANOUT);
+            continue;
+        }
+        // Push the children in reverse, so they are visited in
+        // order.
+        unsigned int c1 = mmMin(ix->ix_cnt[k-1], c0 + PDB_FANOUT);
+        for (unsigned int c = c1; c > c0; c--) {
+            g_stk[g_sp] = k - 1;
+            g_stn[g_sp] = c - 1;
+            g_sp++;
+        }
+    }
+}
+// End of pdb_gen functions.
+
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 
@@ -580,6 +580,48 @@ WindowDesc::redisplay_sdb(const BBox *AOI)
                 }
                 DisableCache();
             }
+            else if (tab->type() == sdbPdb) {
+                pdb_t *db = (pdb_t*)
+                    SymTab::get(tab->table(), (unsigned long)ld);
+                if (db == (pdb_t*)ST_NIL)
+                    continue;
+                w_draw->SetColor(dsp_prm(ld)->pixel());
+                EnableCache();
+                pdb_gen gen(db, AOI);
+                for (;;) {
+                    const BBox *pBB = gen.next_box();
+                    const pdb_path_t *p = pBB ? 0 : gen.next_path();
+                    if (!pBB && !p)
+                        break;
+                    // Test for user interrupt
+                    if (!(numgeom & 0xff)) {
+                        // check every 256 objects for efficiency
+                        if (numgeom) {
+                            dspPkgIf()->CheckForInterrupt();
+                            if (DSP()->Interrupt()) {
+                                DisableCache();
+                                goto done;
+                            }
+                            w_draw->SetColor(dsp_prm(ld)->pixel());
+                        }
+                    }
+                    if (pBB)
+                        ShowBox(pBB, ld->getAttrFlags(), dsp_prm(ld)->fill());
+                    else if (p->type == CDWIRE) {
+                        Wire w;
+                        db->get_wire(p, &w);
+                        ShowWire(&w, ld->getAttrFlags(), dsp_prm(ld)->fill());
+                    }
+                    else {
+                        Poly po;
+                        db->get_poly(p, &po);
+                        ShowPolygon(&po, ld->getAttrFlags(),
+                            dsp_prm(ld)->fill(), &p->BB);
+                    }
+                    numgeom++;
+                }
+                DisableCache();
+            }
             else if (tab->type() == sdbZdb) {
                 zdb_t *db = (zdb_t*)
                     SymTab::get(tab->table(), (unsigned long)ld);
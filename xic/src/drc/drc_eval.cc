@@ -75,6 +75,7 @@
 #include <sys/wait.h>
 #endif
 #endif
+#include <algorithm>
 
 
 //-----------------------------------------------------------------------------
@@ -469,6 +470,240 @@ done:
 }
 
 
+namespace {
+    // Element of the layer sweep.
+    //
+    struct sw_elt_t
+    {
+        BBox BB;
+        int gap;        // clearance to nearest neighbor, or sw_space
+    };
+
+    // Sort for a sweep along x.
+    //
+    inline bool
+    sw_cmp_x(const sw_elt_t &e1, const sw_elt_t &e2)
+    {
+        if (e1.BB.left != e2.BB.left)
+            return (e1.BB.left < e2.BB.left);
+        if (e1.BB.bottom != e2.BB.bottom)
+            return (e1.BB.bottom < e2.BB.bottom);
+        if (e1.BB.right != e2.BB.right)
+            return (e1.BB.right < e2.BB.right);
+        return (e1.BB.top < e2.BB.top);
+    }
+
+    // Sort for a sweep along y.
+    //
+    inline bool
+    sw_cmp_y(const sw_elt_t &e1, const sw_elt_t &e2)
+    {
+        if (e1.BB.bottom != e2.BB.bottom)
+            return (e1.BB.bottom < e2.BB.bottom);
+        if (e1.BB.left != e2.BB.left)
+            return (e1.BB.left < e2.BB.left);
+        if (e1.BB.right != e2.BB.right)
+            return (e1.BB.right < e2.BB.right);
+        return (e1.BB.top < e2.BB.top);
+    }
+
+
+    // Layer sweep for batch mode.  The edge tests for MinWidth and
+    // MinSpace rules query the database for every edge and corner of
+    // every object, which dominates the checking time for dense
+    // regular layers.  Instead, the extents of all objects on the
+    // layer are sorted along one axis and swept once, recording for
+    // each the distance to the nearest other object.  A box that is
+    // wide enough, or clear of neighbors by at least the rule
+    // dimension, can't fail these rules so they are inhibited while
+    // the box is checked.  Everything else is checked as usual, so
+    // results are unchanged.
+    //
+    struct drc_sweep_t
+    {
+        drc_sweep_t(CDl *ld)
+            {
+                sw_ldesc = ld;
+                sw_elts = 0;
+                sw_rules = 0;
+                sw_dims = 0;
+                sw_num = 0;
+                sw_nrules = 0;
+                sw_space = 0;
+                sw_yaxis = false;
+            }
+
+        ~drc_sweep_t()
+            {
+                delete [] sw_elts;
+                delete [] sw_rules;
+                delete [] sw_dims;
+            }
+
+        bool setup(const CDs*, const BBox*);
+        void inhibit(const CDo*, const BBox*);
+        void restore();
+
+    private:
+        int find_gap(const BBox&) const;
+
+        CDl *sw_ldesc;
+        sw_elt_t *sw_elts;          // sorted object extents
+        DRCtestDesc **sw_rules;     // rules that can be skipped
+        int *sw_dims;               // and their sweep dimensions
+        unsigned int sw_num;        // size of sw_elts
+        unsigned int sw_nrules;     // size of sw_rules, sw_dims
+        int sw_space;               // largest MinSpace dimension
+        bool sw_yaxis;              // sweep is along y
+    };
+
+
+    // Find the rules that can be handled, and if there are MinSpace
+    // rules, sweep the objects within the AOI plus the largest
+    // spacing.  Return false if there is nothing to do.
+    //
+    bool
+    drc_sweep_t::setup(const CDs *sdesc, const BBox *AOI)
+    {
+        DRCtestDesc *td0 = *tech_prm(sw_ldesc)->rules_addr();
+        for (DRCtestDesc *td = td0; td; td = td->next()) {
+            if (td->sweepDimen() > 0)
+                sw_nrules++;
+        }
+        if (!sw_nrules)
+            return (false);
+        sw_rules = new DRCtestDesc*[sw_nrules];
+        sw_dims = new int[sw_nrules];
+        sw_nrules = 0;
+        for (DRCtestDesc *td = td0; td; td = td->next()) {
+            int d = td->sweepDimen();
+            if (d > 0) {
+                sw_rules[sw_nrules] = td;
+                sw_dims[sw_nrules] = d;
+                sw_nrules++;
+                if (td->type() == drMinSpace && d > sw_space)
+                    sw_space = d;
+            }
+        }
+        if (!sw_space)
+            return (true);
+
+        BBox sBB(*AOI);
+        sBB.bloat(sw_space);
+        unsigned int sz = 0;
+        double xsum = 0.0, ysum = 0.0;
+        sPF gen(sdesc, &sBB, sw_ldesc, CDMAXCALLDEPTH);
+        CDo *odesc;
+        while ((odesc = gen.next(false, true)) != 0) {
+            if (sw_num == sz) {
+                sz = sz ? 2*sz : 256;
+                sw_elt_t *tmp = new sw_elt_t[sz];
+                for (unsigned int i = 0; i < sw_num; i++)
+                    tmp[i] = sw_elts[i];
+                delete [] sw_elts;
+                sw_elts = tmp;
+            }
+            sw_elt_t *e = sw_elts + sw_num++;
+            e->BB = odesc->oBB();
+            e->gap = sw_space;
+            xsum += e->BB.width();
+            ysum += e->BB.height();
+            delete odesc;
+        }
+
+        // Sweep across the short dimension of the objects, so that
+        // the window of candidate neighbors is small.
+        sw_yaxis = (xsum > ysum);
+        if (sw_yaxis)
+            std::sort(sw_elts, sw_elts + sw_num, sw_cmp_y);
+        else
+            std::sort(sw_elts, sw_elts + sw_num, sw_cmp_x);
+
+        for (unsigned int i = 0; i < sw_num; i++) {
+            sw_elt_t *e1 = sw_elts + i;
+            int end = (sw_yaxis ? e1->BB.top : e1->BB.right) + sw_space;
+            for (unsigned int j = i + 1; j < sw_num; j++) {
+                sw_elt_t *e2 = sw_elts + j;
+                if ((sw_yaxis ? e2->BB.bottom : e2->BB.left) >= end)
+                    break;
+                int dx = e2->BB.left - e1->BB.right;
+                int t = e1->BB.left - e2->BB.right;
+                if (t > dx)
+                    dx = t;
+                int dy = e2->BB.bottom - e1->BB.top;
+                t = e1->BB.bottom - e2->BB.top;
+                if (t > dy)
+                    dy = t;
+                int g = dx > dy ? dx : dy;
+                if (g < 0)
+                    g = 0;
+                if (g < e1->gap)
+                    e1->gap = g;
+                if (g < e2->gap)
+                    e2->gap = g;
+            }
+        }
+        return (true);
+    }
+
+
+    // Inhibit the rules that the object can't fail.  Only boxes that
+    // lie within clipBB are handled.  This must be the AOI passed to
+    // setup, so that every neighbor of a handled box within the
+    // spacing distance was included in the sweep.
+    //
+    void
+    drc_sweep_t::inhibit(const CDo *odesc, const BBox *clipBB)
+    {
+        if (odesc->type() != CDBOX)
+            return;
+        const BBox &BB = odesc->oBB();
+        if (clipBB && !(BB <= *clipBB))
+            return;
+        int wid = BB.width() < BB.height() ? BB.width() : BB.height();
+        int gap = -1;
+        for (unsigned int i = 0; i < sw_nrules; i++) {
+            if (sw_rules[i]->type() == drMinWidth) {
+                if (wid >= sw_dims[i])
+                    sw_rules[i]->setSwept(true);
+            }
+            else {
+                if (gap < 0)
+                    gap = find_gap(BB);
+                if (gap >= sw_dims[i])
+                    sw_rules[i]->setSwept(true);
+            }
+        }
+    }
+
+
+    void
+    drc_sweep_t::restore()
+    {
+        for (unsigned int i = 0; i < sw_nrules; i++)
+            sw_rules[i]->setSwept(false);
+    }
+
+
+    // Return the clearance recorded for the extent BB, or 0 if not
+    // found.  Objects with the same extent overlap, so a box with
+    // nonzero clearance has a unique extent.
+    //
+    int
+    drc_sweep_t::find_gap(const BBox &BB) const
+    {
+        sw_elt_t ex;
+        ex.BB = BB;
+        sw_elt_t *e = sw_yaxis ?
+            std::lower_bound(sw_elts, sw_elts + sw_num, ex, sw_cmp_y) :
+            std::lower_bound(sw_elts, sw_elts + sw_num, ex, sw_cmp_x);
+        if (e == sw_elts + sw_num || e->BB != BB)
+            return (0);
+        return (e->gap);
+    }
+}
+
+
 // Main function to check a hierarchy in batch mode.  The strategy is
 // to use the pseudo-flat generator to obtain a transformed odesc for
 // every object in the database, and perform drc on the copied object. 
@@ -543,6 +778,8 @@ cDRC::batchTest(const BBox *AOI, FILE *fp, sLstr *lstr, BBox *errBB,
                 continue;
             if (skip_layer(ld))
                 continue;
+            drc_sweep_t sweep(ld);
+            bool swept = !isShowZoids() && sweep.setup(cursdp, AOI);
             sPF gen(cursdp, AOI, ld, CDMAXCALLDEPTH);
             CDo *odesc;
             while ((odesc = gen.next(false, false)) != 0) {
@@ -562,8 +799,12 @@ cDRC::batchTest(const BBox *AOI, FILE *fp, sLstr *lstr, BBox *errBB,
                 // throw out any that overlap NDRC layer
                 if (!Blist::intersect(blist, &odesc->oBB(), false)) {
 
+                    if (swept)
+                        sweep.inhibit(odesc, AOI);
                     DRCerrRet *er;
                     ret = objectRules(odesc, pass_halo ? &bltAOI : 0, &er);
+                    if (swept)
+                        sweep.restore();
                     if (ret != XIok) {
                         delete odesc;
                         done = true;
@@ -602,6 +843,119 @@ cDRC::batchTest(const BBox *AOI, FILE *fp, sLstr *lstr, BBox *errBB,
 }
 
 
+namespace {
+    // Return an array of the coarse grid partitions of BB, in the
+    // order checked.
+    //
+    BBox *
+    grid_tiles(const BBox &BB, int nxc, int nyc, int gsx, int gsy)
+    {
+        BBox *tiles = new BBox[nxc*nyc];
+        BBox *t = tiles;
+        for (int ic = 0; ic < nyc; ic++) {
+            for (int jc = 0; jc < nxc; jc++) {
+                int cur_cx = BB.left + jc*gsx;
+                int cur_cy = BB.bottom + ic*gsy;
+                t->left = cur_cx;
+                t->bottom = cur_cy;
+                t->right = cur_cx + gsx;
+                t->top = cur_cy + gsy;
+                if (t->right > BB.right)
+                    t->right = BB.right;
+                if (t->top > BB.top)
+                    t->top = BB.top;
+                t++;
+            }
+        }
+        return (tiles);
+    }
+
+
+    // Return the number of worker processes to use for a gridded
+    // batch test, or 0 if the partitions should be checked
+    // sequentially.  Workers are used only when not running
+    // interactively, as the error list used for display is not
+    // passed back, and the Threads variable sets the number.
+    //
+    int
+    num_workers(int ntiles)
+    {
+#ifdef WIN32
+        (void)ntiles;
+        return (0);
+#else
+        if (XM()->RunMode() == ModeNormal)
+            return (0);
+        int nwk = DSP()->NumThreads();
+        if (nwk > ntiles)
+            nwk = ntiles;
+        return (nwk > 1 ? nwk : 0);
+#endif
+    }
+
+
+    // DRCtileFunc for memory-resident data.
+    //
+    XIrt
+    mem_tile_test(const BBox *BB, FILE *fp, const char *fbmsg, void*)
+    {
+        return (DRC()->batchTest(BB, fp, 0, 0, fbmsg));
+    }
+
+
+#define STNAME "drc_tmp_table"
+
+    // Context for chd_tile_test.
+    //
+    struct chd_tile_t
+    {
+        cCHD *chd;
+        const char *cellname;
+        symref_t *top;
+        int bloat_val;
+        bool flatten;
+    };
+
+    // DRCtileFunc for use with a CHD.  The geometry needed to check
+    // the partition is read into a temporary symbol table.
+    //
+    XIrt
+    chd_tile_test(const BBox *BB, FILE *fp, const char *fbmsg, void *arg)
+    {
+        chd_tile_t *ct = (chd_tile_t*)arg;
+
+        BBox tcBB(*BB);
+        tcBB.bloat(ct->bloat_val);
+
+        CDcdb()->switchTable(STNAME);
+        bool ne = CD()->IsNoElectrical();
+        CD()->SetNoElectrical(true);
+        FIOcvtPrms prms;
+        prms.set_allow_layer_mapping(true);
+        prms.set_use_window(true);
+        prms.set_window(&tcBB);
+        prms.set_flatten(ct->flatten);
+        prms.set_clip(true);
+        OItype oiret = ct->chd->write(ct->cellname, &prms, true);
+        CD()->SetNoElectrical(ne);
+        if (oiret != OIok) {
+            Errs()->add_error("chdGridBatchTest: read failed at %d,%d.",
+                BB->left, BB->bottom);
+            if (oiret == OIaborted)
+                return (XIintr);
+            return (XIbad);
+        }
+        CDcellName tname = DSP()->MainWdesc()->CurCellName();
+        DSP()->MainWdesc()->SetCurCellName(ct->top->get_name());
+
+        XIrt ret = DRC()->batchTest(BB, fp, 0, 0, fbmsg);
+        CDcdb()->destroyTable(false);
+        DSP()->SetCurCellName(tname);
+        return (ret);
+    }
+}
+
+
 XIrt
 cDRC::gridBatchTest(const BBox *AOI, FILE *outfp)
 {
@@ -631,9 +985,6 @@ cDRC::gridBatchTest(const BBox *AOI, FILE *outfp)
     }
     int nvals = nxc*nyc;
 
-    int bloat_val = haloWidth();
-
-    int regcnt = 0;
     char *outfile = 0;
     FILE *fp = 0;
     if (!outfp) {
@@ -701,40 +1052,11 @@ cDRC::gridBatchTest(const BBox *AOI, FILE *outfp)
         tot_errs += drc_err_count;
     }
 
-    XIrt ret = XIok;
-    for (int ic = 0; ic < nyc; ic++) {
-        for (int jc = 0; jc < nxc; jc++) {
-            int cur_cx = coarseBB.left + jc*gsx;
-            int cur_cy = coarseBB.bottom + ic*gsy;
-            BBox coarse_cBB(cur_cx, cur_cy,
-                cur_cx + gsx, cur_cy + gsy);
-            if (coarse_cBB.right > coarseBB.right)
-                coarse_cBB.right = coarseBB.right;
-            if (coarse_cBB.top > coarseBB.top)
-                coarse_cBB.top = coarseBB.top;
-
-            char fbbuf[64];
-            sprintf(fbbuf, "Checking region %d of %d  ", ic*nxc + jc + 1,
-                nvals);
-            PL()->ShowPromptV("Starting %d of %d.", ic*nxc + jc + 1, nvals);
-
-            BBox tcBB(coarse_cBB);
-            tcBB.bloat(bloat_val);
+    BBox *tiles = grid_tiles(coarseBB, nxc, nyc, gsx, gsy);
+    XIrt ret = grid_batch_mp(tiles, nvals, num_workers(nvals), mem_tile_test,
+        0, fp, &tot_errs, &tot_checked);
+    delete [] tiles;
 
-            fprintf(fp, "# REGION %d (%g,%g %g,%g)\n", regcnt,
-                MICRONS(coarse_cBB.left), MICRONS(coarse_cBB.bottom),
-                MICRONS(coarse_cBB.right), MICRONS(coarse_cBB.top));
-            ret = batchTest(&coarse_cBB, fp, 0, 0, nvals == 1 ? 0 : fbbuf);
-            regcnt++;
-
-            tot_errs += drc_err_count;
-            tot_checked += drc_num_checked;
-
-            if (ret != XIok)
-                goto done;
-        }
-    }
-done:
     drc_start_time = start_time;
     drc_err_count = tot_errs;
     drc_num_checked = tot_checked;
@@ -797,7 +1119,6 @@ cDRC::chdGridBatchTest(cCHD *chd, const char *cellname, const BBox *AOI,
 
     int bloat_val = haloWidth();
 
-    int regcnt = 0;
     char *outfile = 0;
     FILE *fp = 0;
     if (!outfp) {
@@ -828,7 +1149,6 @@ cDRC::chdGridBatchTest(cCHD *chd, const char *cellname, const BBox *AOI,
 
     char *st_old = lstring::copy(CDcdb()->tableName());
 
-#define STNAME "drc_tmp_table"
     if (CDcdb()->findTable(STNAME)) {
         CDcdb()->switchTable(STNAME);
         CDcdb()->destroyTable(false);
@@ -840,76 +1160,484 @@ cDRC::chdGridBatchTest(cCHD *chd, const char *cellname, const BBox *AOI,
     drc_doing_grid = (nvals > 1);
     drc_with_chd = true;
 
-    XIrt ret = XIok;
-    for (int ic = 0; ic < nyc; ic++) {
-        for (int jc = 0; jc < nxc; jc++) {
-            int cur_cx = coarseBB.left + jc*gsx;
-            int cur_cy = coarseBB.bottom + ic*gsy;
-            BBox coarse_cBB(cur_cx, cur_cy,
-                cur_cx + gsx, cur_cy + gsy);
-            if (coarse_cBB.right > coarseBB.right)
-                coarse_cBB.right = coarseBB.right;
-            if (coarse_cBB.top > coarseBB.top)
-                coarse_cBB.top = coarseBB.top;
+    chd_tile_t ct;
+    ct.chd = chd;
+    ct.cellname = cellname;
+    ct.top = top;
+    ct.bloat_val = bloat_val;
+    ct.flatten = flatten;
 
-            char fbbuf[64];
-            sprintf(fbbuf, "Checking region %d of %d  ", ic*nxc + jc + 1,
-                nvals);
-            PL()->ShowPromptV("Starting %d of %d.", ic*nxc + jc + 1, nvals);
+    BBox *tiles = grid_tiles(coarseBB, nxc, nyc, gsx, gsy);
+    XIrt ret = grid_batch_mp(tiles, nvals, num_workers(nvals), chd_tile_test,
+        &ct, fp, &tot_errs, &tot_checked);
+    delete [] tiles;
+
+    drc_start_time = start_time;
+    drc_err_count = tot_errs;
+    drc_num_checked = tot_checked;
+    drc_doing_grid = false;
+    drc_with_chd = false;
+    printFileEnd(fp, getErrCount(), true);
+    if (fp && fp != outfp)
+        fclose(fp);
+    CDcdb()->switchTable(st_old);
+    delete [] st_old;
+    if (outfile) {
+        if (ret == XIok)
+            errReset(outfile, 0);
+        delete [] outfile;
+    }
+    return (ret);
+}
 
-            BBox tcBB(coarse_cBB);
-            tcBB.bloat(bloat_val);
 
-            CDcdb()->switchTable(STNAME);
-            bool ne = CD()->IsNoElectrical();
-            CD()->SetNoElectrical(true);
-            FIOcvtPrms prms;
-            prms.set_allow_layer_mapping(true);
-            prms.set_use_window(true);
-            prms.set_window(&tcBB);
-            prms.set_flatten(flatten);
-            prms.set_clip(true);
-            OItype oiret = chd->write(cellname, &prms, true);
-            CD()->SetNoElectrical(ne);
-            if (oiret != OIok) {
-                Errs()->add_error("chdGridBatchTest: read failed at %d,%d.",
-                    cur_cx, cur_cy);
-                if (oiret == OIaborted)
-                    ret = XIintr;
+namespace {
+    // A worker writes this line to the output file after checking a
+    // partition, followed by the return code and object count.
+    //
+    const char *tile_status = "# Partition status:";
+
+    // Copy the error record in lstr to fp, unless it has been seen
+    // before, or the error limit has been reached.  The number in
+    // the leading "DRC error N in cell ..." line is replaced.
+    //
+    void
+    merge_error(sLstr *lstr, FILE *fp, SymTab *tab, unsigned int *perrs)
+    {
+        const char *str = lstr->string();
+        if (!str)
+            return;
+        unsigned int maxerrs = DRC()->maxErrors();
+        if (maxerrs == 0 || *perrs < maxerrs) {
+            const char *t = strstr(str, " in cell ");
+            if (!t)
+                t = str;
+            if (SymTab::get(tab, t) == ST_NIL) {
+                tab->add(lstring::copy(t), 0, false);
+                (*perrs)++;
+                if (t != str)
+                    fprintf(fp, "DRC error %d%s", *perrs, t);
                 else
-                    ret = XIbad;
-                goto done;
+                    fputs(str, fp);
+            }
+        }
+        lstr->free();
+    }
+
+
+    // Merge the worker output for a partition into fp.  The return
+    // is the status recorded by the worker, or XIbad if the worker
+    // did not finish.
+    //
+    XIrt
+    merge_tile(const char *fname, FILE *fp, SymTab *tab, unsigned int *perrs,
+        unsigned int *pchkd)
+    {
+        FILE *tfp = fopen(fname, "r");
+        if (!tfp)
+            return (XIbad);
+        XIrt ret = XIbad;
+        sLstr lstr;
+        char buf[1024];
+        while (fgets(buf, 1024, tfp) != 0) {
+            if (lstring::prefix(tile_status, buf)) {
+                merge_error(&lstr, fp, tab, perrs);
+                int rc;
+                unsigned int nchkd;
+                if (sscanf(buf + strlen(tile_status), "%d %u", &rc,
+                        &nchkd) == 2) {
+                    ret = (XIrt)rc;
+                    *pchkd += nchkd;
+                }
+                break;
             }
-            CDcellName tname = DSP()->MainWdesc()->CurCellName();
-            DSP()->MainWdesc()->SetCurCellName(top->get_name());
+            if (lstring::prefix("DRC error", buf))
+                merge_error(&lstr, fp, tab, perrs);
+            lstr.add(buf);
+        }
+        fclose(tfp);
+        return (ret);
+    }
 
-            fprintf(fp, "# REGION %d (%g,%g %g,%g)\n", regcnt,
-                MICRONS(coarse_cBB.left), MICRONS(coarse_cBB.bottom),
-                MICRONS(coarse_cBB.right), MICRONS(coarse_cBB.top));
 
-            ret = batchTest(&coarse_cBB, fp, 0, 0, nvals == 1 ? 0 : fbbuf);
-            CDcdb()->destroyTable(false);
-            DSP()->SetCurCellName(tname);
-            regcnt++;
+    // Set BB to the extent of the error record in str, which is the
+    // union of the "bounded by" object box and the "in poly" error
+    // region.  Return false if neither is found.
+    //
+    bool
+    err_extent(const char *str, BBox *pBB)
+    {
+        bool found = false;
+        const char *t = strstr(str, "bounded by ");
+        if (t) {
+            double x1, y1, x2, y2;
+            if (sscanf(t + 11, "%lf,%lf %lf,%lf", &x1, &y1, &x2, &y2) == 4) {
+                pBB->left = INTERNAL_UNITS(x1);
+                pBB->bottom = INTERNAL_UNITS(y1);
+                pBB->right = INTERNAL_UNITS(x2);
+                pBB->top = INTERNAL_UNITS(y2);
+                pBB->fix();
+                found = true;
+            }
+        }
+        t = strstr(str, "in poly ");
+        if (t) {
+            double x[4], y[4];
+            if (sscanf(t + 8, "%lf,%lf %lf,%lf %lf,%lf %lf,%lf",
+                    &x[0], &y[0], &x[1], &y[1], &x[2], &y[2],
+                    &x[3], &y[3]) == 8) {
+                int i = 0;
+                if (!found) {
+                    pBB->left = pBB->right = INTERNAL_UNITS(x[0]);
+                    pBB->bottom = pBB->top = INTERNAL_UNITS(y[0]);
+                    i++;
+                    found = true;
+                }
+                for ( ; i < 4; i++)
+                    pBB->add(INTERNAL_UNITS(x[i]), INTERNAL_UNITS(y[i]));
+            }
+        }
+        return (found);
+    }
 
-            tot_errs += drc_err_count;
-            tot_checked += drc_num_checked;
 
+    // Copy the error records from the previous results in efp to fp,
+    // except for those with an extent that touches an area in blist,
+    // which will be checked again.  Records that can't be located are
+    // kept.  The number of records dropped is returned.
+    //
+    unsigned int
+    carry_errors(FILE *efp, const Blist *blist, FILE *fp, SymTab *tab,
+        unsigned int *perrs)
+    {
+        unsigned int ndrop = 0;
+        sLstr lstr;
+        char buf[1024];
+        for (;;) {
+            char *s = fgets(buf, 1024, efp);
+            bool start = (s && lstring::prefix("DRC error", buf));
+            if (!s || start || *buf == '#' ||
+                    lstring::prefix("End check", buf) ||
+                    lstring::prefix("Elapsed", buf) ||
+                    lstring::prefix("Warning:", buf)) {
+                // End of a record.
+                BBox BB;
+                if (lstr.string() && err_extent(lstr.string(), &BB) &&
+                        Blist::intersect(blist, &BB, true)) {
+                    lstr.free();
+                    ndrop++;
+                }
+                else
+                    merge_error(&lstr, fp, tab, perrs);
+                if (!s)
+                    break;
+                if (!start)
+                    continue;
+            }
+            else if (!lstr.string())
+                continue;
+            lstr.add(buf);
+        }
+        return (ndrop);
+    }
+
+
+    // Bloat the boxes in the list by delta, then replace boxes that
+    // overlap or touch with their union, until all are separated.
+    //
+    Blist *
+    cluster_regions(Blist *b0, int delta)
+    {
+        for (Blist *b = b0; b; b = b->next)
+            b->BB.bloat(delta);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (Blist *b = b0; b; b = b->next) {
+                Blist *bp = b;
+                for (Blist *bx = b->next; bx; bx = bp->next) {
+                    if (b->BB.intersect(&bx->BB, true)) {
+                        b->BB.add(&bx->BB);
+                        bp->next = bx->next;
+                        delete bx;
+                        changed = true;
+                        continue;
+                    }
+                    bp = bx;
+                }
+            }
+        }
+        return (b0);
+    }
+}
+
+
+// Check the partitions in tiles using nwk worker processes, called
+// from the gridded and incremental batch test functions.  If nwk is
+// less than two, or under Windows, the partitions are checked in this
+// process, but the output is handled in the same way.  The rule
+// descriptors keep state while testing, so the rule evaluation is not
+// reentrant and can't be shared between threads.  A forked worker has
+// its own copy of the database and rules, and uses the same code as
+// the sequential case.  Worker n checks partitions n, n + nwk, ...,
+// each into a separate temporary file, calling func with arg.  These are
+// merged into fp in partition order.  The errors are renumbered, and
+// duplicates are dropped.  These come from objects that cross a
+// partition boundary, which are tested from both sides through the
+// halo.  The error and object counts are added to *perrs and *pchkd.
+//
+XIrt
+cDRC::grid_batch_mp(const BBox *tiles, int ntiles, int nwk, DRCtileFunc func,
+    void *arg, FILE *fp, unsigned int *perrs, unsigned int *pchkd)
+{
+    char **tfiles = new char*[ntiles];
+    for (int i = 0; i < ntiles; i++)
+        tfiles[i] = filestat::make_temp("drc");
+
+    if (nwk < 1)
+        nwk = 1;
+    int *pids = new int[nwk];
+
+    if (nwk > 1) {
+        PL()->ShowPromptV("Checking %d regions using %d processes.",
+            ntiles, nwk);
+    }
+    fflush(0);
+    for (int w = 0; w < nwk; w++) {
+#ifdef WIN32
+        int pid = -1;
+#else
+        int pid = nwk > 1 ? fork() : -1;
+#endif
+        if (pid > 0) {
+            pids[w] = pid;
+            continue;
+        }
+
+        // This is the worker, or we're not forking or the fork
+        // failed, in which case this share of the partitions is
+        // checked here.
+
+        for (int i = w; i < ntiles; i += nwk) {
+            FILE *tfp = fopen(tfiles[i], "w");
+            if (!tfp)
+                break;
+            char fbbuf[64];
+            const char *fb = 0;
+            if (nwk == 1 && ntiles > 1) {
+                snprintf(fbbuf, sizeof(fbbuf), "Checking region %d of %d  ",
+                    i + 1, ntiles);
+                PL()->ShowPromptV("Starting %d of %d.", i + 1, ntiles);
+                fb = fbbuf;
+            }
+            drc_err_count = 0;
+            drc_num_checked = 0;
+            XIrt ret = (*func)(&tiles[i], tfp, fb, arg);
+            fprintf(tfp, "%s %d %u\n", tile_status, ret, drc_num_checked);
+            fclose(tfp);
             if (ret != XIok)
-                goto done;
+                break;
+        }
+#ifndef WIN32
+        if (pid == 0)
+            _exit(0);
+#endif
+        pids[w] = 0;
+    }
+#ifndef WIN32
+    for (int w = 0; w < nwk; w++) {
+        // The SIGCHLD handler may reap the worker first.  The exit
+        // status is not used, the worker output tells all.
+        if (pids[w] > 0) {
+            while (waitpid(pids[w], 0, 0) < 0 && errno == EINTR) ;
         }
     }
-done:
+#endif
+    delete [] pids;
+
+    XIrt ret = XIok;
+    SymTab *tab = new SymTab(true, false);
+    for (int i = 0; i < ntiles; i++) {
+        if (ret == XIok) {
+            const BBox &cBB = tiles[i];
+            fprintf(fp, "# REGION %d (%g,%g %g,%g)\n", i,
+                MICRONS(cBB.left), MICRONS(cBB.bottom),
+                MICRONS(cBB.right), MICRONS(cBB.top));
+            ret = merge_tile(tfiles[i], fp, tab, perrs, pchkd);
+            if (ret == XIbad) {
+                Errs()->add_error("grid_batch_mp: region %d check failed.",
+                    i);
+            }
+        }
+        unlink(tfiles[i]);
+        delete [] tfiles[i];
+    }
+    delete tab;
+    delete [] tfiles;
+    drc_stop_time = Timer()->elapsed_msec();
+    return (ret);
+}
+
+
+// Grid parameters for the layout comparison in chdIncrBatchTest,
+// the defaults for flat geometric comparison.
+#define DRC_INCR_FINE_GRID      20.0
+#define DRC_INCR_COARSE_MULT    20
+
+// Incremental batch DRC, for use after small changes to a large
+// layout.  The chd and cellname give the layout to check, which is
+// compared to the reference layout in refchd and refcell, for which
+// the results of an earlier check are in the file preverrs.  The
+// areas that differ on any layer are found with a flat geometric
+// comparison, so that changes anywhere in the hierarchy are seen in
+// context.  These are bloated by the halo width and merged, and only
+// these areas are checked.  Errors from preverrs that are clear of
+// these areas are carried forward into the new results.  If outfp
+// is given, output goes to that file, otherwise a file is created
+// as in chdGridBatchTest.
+//
+XIrt
+cDRC::chdIncrBatchTest(cCHD *chd, const char *cellname, cCHD *refchd,
+    const char *refcell, const char *preverrs, FILE *outfp, bool flatten)
+{
+    if (!chd || !refchd) {
+        Errs()->add_error("chdIncrBatchTest: null CHD pointer given.");
+        return (XIbad);
+    }
+    if (!preverrs || !*preverrs) {
+        Errs()->add_error(
+            "chdIncrBatchTest: no previous results file given.");
+        return (XIbad);
+    }
+    if (!update_rule_disable())
+        return (XIbad);
+
+    symref_t *top = chd->findSymref(cellname, Physical, true);
+    if (!top) {
+        Errs()->add_error("chdIncrBatchTest: unresolved top cell.");
+        return (XIbad);
+    }
+    chd->setBoundaries(top);
+    const char *topname = Tstring(top->get_name());
+    if (!refcell || !*refcell)
+        refcell = topname;
+
+    FILE *efp = fopen(preverrs, "r");
+    if (!efp) {
+        Errs()->add_error("chdIncrBatchTest: can't open %s.", preverrs);
+        return (XIbad);
+    }
+    char buf[256];
+    if (!fgets(buf, 256, efp) || !lstring::prefix(DRC_EFILE_HEADER, buf)) {
+        Errs()->add_error(
+            "chdIncrBatchTest: %s is not a DRC results file.", preverrs);
+        fclose(efp);
+        return (XIbad);
+    }
+
+    if (XM()->RunMode() == ModeNormal)
+        PL()->ShowPrompt("Comparing layouts ... ");
+    Blist *bl0 = 0;
+    unsigned int ndiffs;
+    XIrt ret = cCHD::compareCHDs_bb(refchd, refcell, chd, topname, 0, 0,
+        false, &bl0, &ndiffs, DRC_INCR_COARSE_MULT,
+        INTERNAL_UNITS(DRC_INCR_FINE_GRID));
+    if (ret != XIok) {
+        Blist::destroy(bl0);
+        fclose(efp);
+        return (ret);
+    }
+    bl0 = cluster_regions(bl0, haloWidth());
+    int nregs = Blist::length(bl0);
+
+    char *outfile = 0;
+    FILE *fp = 0;
+    if (!outfp) {
+        outfile = errFilename(topname, 0);
+        if (!filestat::create_bak(outfile)) {
+            Errs()->add_error(
+                "chdIncrBatchTest: can't open backup output file %s.",
+                outfile);
+            delete [] outfile;
+            Blist::destroy(bl0);
+            fclose(efp);
+            return (XIbad);
+        }
+        fp = fopen(outfile, "w");
+        if (!fp) {
+            Errs()->add_error("chdIncrBatchTest: can't open output file %s.",
+                outfile);
+            delete [] outfile;
+            Blist::destroy(bl0);
+            fclose(efp);
+            return (XIbad);
+        }
+    }
+    else
+        fp = outfp;
+
+    if (!printFileHeader(fp, topname, 0, chd)) {
+        if (fp && fp != outfp)
+            fclose(fp);
+        delete [] outfile;
+        Blist::destroy(bl0);
+        fclose(efp);
+        return (XIbad);
+    }
+    fprintf(fp, "# Incremental check from %s, %d region%s to check.\n",
+        preverrs, nregs, nregs == 1 ? "" : "s");
+
+    long start_time = Timer()->elapsed_msec();
+    unsigned int tot_errs = 0;
+    unsigned int tot_checked = 0;
+
+    SymTab *tab = new SymTab(true, false);
+    unsigned int ndrop = carry_errors(efp, bl0, fp, tab, &tot_errs);
+    delete tab;
+    fclose(efp);
+    fprintf(fp, "# Carried forward %u errors, %u to be checked again.\n",
+        tot_errs, ndrop);
+
+    if (nregs > 0) {
+        BBox *regs = new BBox[nregs];
+        int i = 0;
+        for (Blist *b = bl0; b; b = b->next)
+            regs[i++] = b->BB;
+
+        char *st_old = lstring::copy(CDcdb()->tableName());
+        if (CDcdb()->findTable(STNAME)) {
+            CDcdb()->switchTable(STNAME);
+            CDcdb()->destroyTable(false);
+        }
+        drc_doing_grid = true;
+        drc_with_chd = true;
+
+        chd_tile_t ct;
+        ct.chd = chd;
+        ct.cellname = cellname;
+        ct.top = top;
+        ct.bloat_val = haloWidth();
+        ct.flatten = flatten;
+
+        ret = grid_batch_mp(regs, nregs, num_workers(nregs), chd_tile_test,
+            &ct, fp, &tot_errs, &tot_checked);
+
+        drc_doing_grid = false;
+        drc_with_chd = false;
+        CDcdb()->switchTable(st_old);
+        delete [] st_old;
+        delete [] regs;
+    }
+    else
+        drc_stop_time = Timer()->elapsed_msec();
+    Blist::destroy(bl0);
+
     drc_start_time = start_time;
     drc_err_count = tot_errs;
     drc_num_checked = tot_checked;
-    drc_doing_grid = false;
-    drc_with_chd = false;
     printFileEnd(fp, getErrCount(), true);
     if (fp && fp != outfp)
         fclose(fp);
-    CDcdb()->switchTable(st_old);
-    delete [] st_old;
     if (outfile) {
         if (ret == XIok)
             errReset(outfile, 0);
@@ -919,6 +1647,415 @@ done:
 }
 
 
+namespace {
+    // Instance context for the hierarchical check.  This determines
+    // which objects in the instance hierarchy may interact with
+    // geometry outside of the master, and so must be checked again in
+    // the parent.  These are objects within the halo of another
+    // instance or of geometry in the parent, and for arrays, objects
+    // within the halo of the element boundary, which may interact
+    // with neighboring elements.
+    //
+    struct hier_ctx_t
+    {
+        hier_ctx_t(const CDc *cd, int halo)
+            {
+                hc_cdesc = cd;
+                hc_areas = 0;
+                hc_halo = halo;
+                hc_array = false;
+                hc_allself = false;
+            }
+
+        ~hier_ctx_t()
+            {
+                Blist::destroy(hc_areas);
+            }
+
+        bool setup(const CDs*);
+        bool needs_check(const CDo*) const;
+
+        const BBox *iterBB()    const { return (&hc_iterBB); }
+
+    private:
+        void add_area(const BBox&);
+        int elt_index(int, int, int, int) const;
+
+        const CDc *hc_cdesc;
+        Blist *hc_areas;            // interaction areas, parent coords
+        BBox hc_msBB;               // master BB
+        BBox hc_iterBB;             // area to search
+        CDap hc_ap;                 // array parameters
+        cTfmStack hc_stk;           // inverse instance transform
+        int hc_halo;
+        bool hc_array;              // instance is arrayed
+        bool hc_allself;            // array elements overlap
+    };
+
+
+    // Find the interaction areas for the instance in parent.  Return
+    // false if the instance has nothing to check in context.
+    //
+    bool
+    hier_ctx_t::setup(const CDs *parent)
+    {
+        CDs *msd = hc_cdesc->masterCell(true);
+        if (!msd)
+            return (false);
+        hc_msBB = *msd->BB();
+        hc_ap = CDap(hc_cdesc);
+        hc_array = (hc_ap.nx > 1 || hc_ap.ny > 1);
+        if (hc_array) {
+            if ((hc_ap.nx > 1 && abs(hc_ap.dx) < hc_msBB.width()) ||
+                    (hc_ap.ny > 1 && abs(hc_ap.dy) < hc_msBB.height()))
+                hc_allself = true;
+            hc_stk.TPush();
+            hc_stk.TApplyTransform(hc_cdesc);
+            hc_stk.TInverse();
+        }
+
+        BBox bBB(hc_cdesc->oBB());
+        bBB.bloat(hc_halo);
+        CDg gdesc;
+        gdesc.init_gen(parent, CellLayer(), &bBB);
+        CDo *odesc;
+        while ((odesc = gdesc.next()) != 0) {
+            if (odesc == hc_cdesc || !odesc->is_normal())
+                continue;
+            add_area(odesc->oBB());
+        }
+        CDl *ld;
+        CDlgen lgen(Physical);
+        while ((ld = lgen.next()) != 0) {
+            gdesc.init_gen(parent, ld, &bBB);
+            while ((odesc = gdesc.next()) != 0) {
+                if (!odesc->is_normal() || odesc->type() == CDLABEL)
+                    continue;
+                add_area(odesc->oBB());
+            }
+        }
+
+        if (hc_array)
+            hc_iterBB = hc_cdesc->oBB();
+        else if (hc_areas) {
+            hc_iterBB = hc_areas->BB;
+            for (Blist *b = hc_areas->next; b; b = b->next)
+                hc_iterBB.add(&b->BB);
+        }
+        else
+            return (false);
+        return (true);
+    }
+
+
+    // Return true if the object, from the instance hierarchy, must be
+    // checked in the parent.
+    //
+    bool
+    hier_ctx_t::needs_check(const CDo *odesc) const
+    {
+        if (Blist::intersect(hc_areas, &odesc->oBB(), false))
+            return (true);
+        if (!hc_array)
+            return (false);
+        if (hc_allself)
+            return (true);
+
+        // Find the array element containing the object, and see if
+        // the object is within the halo of the element boundary.
+        BBox oBB(odesc->oBB());
+        hc_stk.TInverseBB(&oBB, 0);
+        int ix = elt_index((oBB.left + oBB.right)/2 - hc_msBB.left,
+            hc_ap.dx, hc_ap.nx, hc_msBB.width());
+        int iy = elt_index((oBB.bottom + oBB.top)/2 - hc_msBB.bottom,
+            hc_ap.dy, hc_ap.ny, hc_msBB.height());
+        if (ix < 0 || iy < 0)
+            return (true);
+        oBB.left -= ix*hc_ap.dx;
+        oBB.right -= ix*hc_ap.dx;
+        oBB.bottom -= iy*hc_ap.dy;
+        oBB.top -= iy*hc_ap.dy;
+        return (oBB.left < hc_msBB.left + hc_halo ||
+            oBB.bottom < hc_msBB.bottom + hc_halo ||
+            oBB.right > hc_msBB.right - hc_halo ||
+            oBB.top > hc_msBB.top - hc_halo);
+    }
+
+
+    // Add the part of BB bloated by the halo that overlaps the
+    // instance.
+    //
+    void
+    hier_ctx_t::add_area(const BBox &BB)
+    {
+        const BBox &cBB = hc_cdesc->oBB();
+        BBox aBB(BB);
+        aBB.bloat(hc_halo);
+        if (aBB.left < cBB.left)
+            aBB.left = cBB.left;
+        if (aBB.bottom < cBB.bottom)
+            aBB.bottom = cBB.bottom;
+        if (aBB.right > cBB.right)
+            aBB.right = cBB.right;
+        if (aBB.top > cBB.top)
+            aBB.top = cBB.top;
+        if (aBB.left < aBB.right && aBB.bottom < aBB.top)
+            hc_areas = new Blist(&aBB, hc_areas);
+    }
+
+
+    // Return the index of the array element along one axis that
+    // contains the offset c from the first element origin, given the
+    // pitch d, count n and element size w.  Return -1 if not found.
+    //
+    int
+    hier_ctx_t::elt_index(int c, int d, int n, int w) const
+    {
+        if (n <= 1 || !d)
+            return (0);
+        int i0 = (int)floor(c/(double)d);
+        for (int i = i0 - 1; i <= i0 + 1; i++) {
+            if (i < 0 || i >= n)
+                continue;
+            if (c >= i*d && c <= i*d + w)
+                return (i);
+        }
+        return (-1);
+    }
+}
+
+
+// Hierarchical batch check of the current cell.  Each cell in the
+// hierarchy is checked once:  the objects in the cell are checked in
+// the context of the cell's hierarchy, and objects in subcell
+// instances are checked again only where they are within the halo of
+// another instance, of geometry in the parent, or of the boundary of
+// an array element.  For layouts built from repeated masters, such as
+// memory arrays and standard cell rows, the work is reduced by about
+// the repetition factor.
+//
+// Errors are reported for each cell under a "# Cell" comment line, in
+// the coordinates of that cell, followed by the errors found in the
+// instance contexts under a "# Context" line.  The Connected and
+// NoHoles tests are applied to the current cell only.  Rules that
+// use derived layers, which are evaluated flat, can't be handled, in
+// which case the usual flat check is done.
+//
+XIrt
+cDRC::hierBatchTest(FILE *fp, sLstr *lstr)
+{
+    CDs *topsd = CurCell(Physical);
+    if (!topsd)
+        return (XIbad);
+    if (!update_rule_disable())
+        return (XIbad);
+    if (rules_use_derived()) {
+        if (fp) {
+            fprintf(fp,
+                "# Rules use derived layers, running flat check.\n");
+        }
+        return (batchTest(0, fp, lstr, 0));
+    }
+
+    int halo = haloWidth();
+    long start_time = Timer()->elapsed_msec();
+    unsigned int tot_errs = 0;
+    unsigned int tot_checked = 0;
+    DRCerrList *el0 = 0;
+    XIrt ret = XIok;
+
+    CDcellName tname = DSP()->CurCellName();
+    CDgenHierDn_s gen(topsd);
+    CDs *sd;
+    while ((sd = gen.next()) != 0) {
+        if (XM()->RunMode() == ModeNormal)
+            PL()->ShowPromptV("Checking %s ...", Tstring(sd->cellname()));
+        DSP()->SetCurCellName(sd->cellname());
+        drc_err_count = tot_errs;
+        drc_num_checked = tot_checked;
+        ret = hier_cell_test(sd, halo, (sd == topsd), fp, lstr, &el0);
+        tot_errs = drc_err_count;
+        tot_checked = drc_num_checked;
+        if (ret != XIok)
+            break;
+        if (maxErrors() > 0 && tot_errs >= maxErrors())
+            break;
+    }
+    DSP()->SetCurCellName(tname);
+
+    // The errors are in the coordinates of the cells, so can't be
+    // displayed in the current cell.
+    while (el0) {
+        DRCerrList *el = el0;
+        el0 = el0->next();
+        delete el;
+    }
+
+    drc_start_time = start_time;
+    drc_stop_time = Timer()->elapsed_msec();
+    drc_err_count = tot_errs;
+    drc_num_checked = tot_checked;
+    return (ret);
+}
+
+
+// Return true if any of the rules in use reference a derived layer.
+//
+bool
+cDRC::rules_use_derived()
+{
+    CDlgenDrv lgen;
+    CDl *ld;
+    while ((ld = lgen.next()) != 0) {
+        if (skip_layer(ld))
+            continue;
+        for (DRCtestDesc *td = *tech_prm(ld)->rules_addr(); td;
+                td = td->next()) {
+            if (td->inhibited() || drc_rule_disable[td->type()])
+                continue;
+            if (ld->layerType() == CDLderived)
+                return (true);
+            bool found = false;
+            CDll *l0 = td->sourceLayers();
+            for (CDll *l = l0; l; l = l->next) {
+                if (l->ldesc->layerType() == CDLderived)
+                    found = true;
+            }
+            CDll::destroy(l0);
+            l0 = td->targetLayers();
+            for (CDll *l = l0; l; l = l->next) {
+                if (l->ldesc->layerType() == CDLderived)
+                    found = true;
+            }
+            CDll::destroy(l0);
+            if (found)
+                return (true);
+        }
+    }
+    return (false);
+}
+
+
+// Check one cell for hierBatchTest, sdesc is the current cell.
+// The error count and checked object count accumulate.
+//
+XIrt
+cDRC::hier_cell_test(CDs *sdesc, int halo, bool top, FILE *fp,
+    sLstr *lstr, DRCerrList **pel0)
+{
+    unsigned int errs = drc_err_count;
+    unsigned int chkd = drc_num_checked;
+    Blist *blist;
+    XIrt ret = init_drc(0, &blist, true);
+    if (ret != XIok)
+        return (ret);
+    drc_err_count = errs;
+    drc_num_checked = chkd;
+    if (fp)
+        fprintf(fp, "# Cell %s\n", Tstring(sdesc->cellname()));
+
+    bool done = false;
+    if (top) {
+        CDl *ld;
+        CDlgenDrv lgen;
+        while ((ld = lgen.next()) != 0) {
+            if (!*tech_prm(ld)->rules_addr())
+                continue;
+            if (skip_layer(ld))
+                continue;
+            DRCerrRet *er = 0;
+            ret = layerRules(ld, sdesc->BB(), &er);
+            done = handle_errors(er, 0, 0, 0, pel0, fp, lstr);
+            if (ret != XIok || done)
+                break;
+        }
+    }
+
+    // The objects in the cell.
+    CDl *ld;
+    CDlgenDrv lgen;
+    while (ret == XIok && !done && (ld = lgen.next()) != 0) {
+        if (!*tech_prm(ld)->rules_addr())
+            continue;
+        if (skip_layer(ld))
+            continue;
+        sPF gen(sdesc, sdesc->BB(), ld, 0);
+        CDo *odesc;
+        while ((odesc = gen.next(false, false)) != 0) {
+            drc_num_checked++;
+            if (!Blist::intersect(blist, &odesc->oBB(), false)) {
+                DRCerrRet *er;
+                ret = objectRules(odesc, 0, &er);
+                if (ret == XIok)
+                    done = handle_errors(er, &gen, odesc, 0, pel0, fp, lstr);
+            }
+            delete odesc;
+            if (ret != XIok || done)
+                break;
+            if (check_interrupt(false)) {
+                ret = XIintr;
+                break;
+            }
+        }
+    }
+
+    // The objects in instances that may interact with the
+    // surroundings.
+    bool hdr = false;
+    CDm_gen mgen(sdesc, GEN_MASTERS);
+    for (CDm *md = mgen.m_first(); md; md = mgen.m_next()) {
+        if (ret != XIok || done)
+            break;
+        if (!md->celldesc())
+            continue;
+        CDc_gen cgen(md);
+        for (CDc *cd = cgen.c_first(); cd; cd = cgen.c_next()) {
+            if (ret != XIok || done)
+                break;
+            hier_ctx_t cx(cd, halo);
+            if (!cx.setup(sdesc))
+                continue;
+            if (fp && !hdr) {
+                fprintf(fp, "# Context %s\n", Tstring(sdesc->cellname()));
+                hdr = true;
+            }
+            CDlgenDrv tlgen;
+            while (ret == XIok && !done && (ld = tlgen.next()) != 0) {
+                if (!*tech_prm(ld)->rules_addr())
+                    continue;
+                if (skip_layer(ld))
+                    continue;
+                sPF gen(cd, cx.iterBB(), ld, CDMAXCALLDEPTH);
+                CDo *odesc;
+                while ((odesc = gen.next(false, false)) != 0) {
+                    if (!cx.needs_check(odesc) ||
+                            Blist::intersect(blist, &odesc->oBB(), false)) {
+                        delete odesc;
+                        continue;
+                    }
+                    drc_num_checked++;
+                    DRCerrRet *er;
+                    ret = objectRules(odesc, 0, &er);
+                    if (ret == XIok) {
+                        done = handle_errors(er, &gen, odesc, 0, pel0,
+                            fp, lstr);
+                    }
+                    delete odesc;
+                    if (ret != XIok || done)
+                        break;
+                    if (check_interrupt(false)) {
+                        ret = XIintr;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    close_drc(blist);
+    return (ret);
+}
+
+
 // As for batchTest, but act on a list (slist) of objects (no subcells
 // allowed).
 //
@@ -1445,6 +1445,43 @@ DRCtestDesc::cornerOverlapTest(DRCedgeEval *ev, int width)
 }
 
 
+// If this is a MinWidth or MinSpace rule in its basic form, with no
+// region, target, or edge conditions, return the largest dimension
+// that can be used in the Manhattan edge and corner tests, otherwise
+// return 0.  A box on the object layer will pass a MinWidth rule if
+// its width and height are at least this value, and will pass a
+// MinSpace rule if no other geometry on the layer is closer than
+// this value.  The batch checker uses this to skip the edge tests.
+//
+int
+DRCtestDesc::sweepDimen() const
+{
+    if (td_type != drMinWidth && td_type != drMinSpace)
+        return (0);
+    if (td_user_rule || td_source.tree() ||
+            td_source.ldesc() != td_objlayer)
+        return (0);
+    if (hasTarget() || hasInside() || hasOutside())
+        return (0);
+
+    // The tests return an error if the dimension is not larger than
+    // the fudge value, leave these alone.
+    int dim = dimen();
+    if (dim <= td_fudge)
+        return (0);
+    if (td_spacing) {
+        for (unsigned int i = 0; i < td_spacing->entries; i++) {
+            int d = td_spacing[i].dimen;
+            if (d <= td_fudge)
+                return (0);
+            if (d > dim)
+                dim = d;
+        }
+    }
+    return (dim);
+}
+
+
 //
 // Error reporting functions.
 //
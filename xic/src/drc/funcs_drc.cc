@@ -54,6 +54,8 @@
 #include "si_interp.h"
 #include "si_lexpr.h"
 #include "cd_digest.h"
+#include "fio.h"
+#include "fio_chd.h"
 #include "layertab.h"
 #include "menu.h"
 #include "drc_menu.h"
@@ -93,7 +95,9 @@ namespace {
         bool IFdrcSetLevel(Variable*, Variable*, void*);
         bool IFdrcGetLevel(Variable*, Variable*, void*);
         bool IFdrcCheckArea(Variable*, Variable*, void*);
+        bool IFdrcCheckHier(Variable*, Variable*, void*);
         bool IFdrcChdCheckArea(Variable*, Variable*, void*);
+        bool IFdrcChdCheckChanges(Variable*, Variable*, void*);
         bool IFdrcCheckObjects(Variable*, Variable*, void*);
         bool IFdrcRegisterExpr(Variable*, Variable*, void*);
         bool IFdrcTestBox(Variable*, Variable*, void*);
@@ -128,7 +132,9 @@ namespace {
     PY_FUNC(DRCsetLevel,            1,  IFdrcSetLevel);
     PY_FUNC(DRCgetLevel,            0,  IFdrcGetLevel);
     PY_FUNC(DRCcheckArea,           2,  IFdrcCheckArea);
+    PY_FUNC(DRCcheckHier,           1,  IFdrcCheckHier);
     PY_FUNC(DRCchdCheckArea,        6,  IFdrcChdCheckArea);
+    PY_FUNC(DRCchdCheckChanges,     7,  IFdrcChdCheckChanges);
     PY_FUNC(DRCcheckObjects,        1,  IFdrcCheckObjects);
     PY_FUNC(DRCregisterExpr,        1,  IFdrcRegisterExpr);
     PY_FUNC(DRCtestBox,             5,  IFdrcTestBox);
@@ -160,7 +166,9 @@ namespace {
       cPyIf::register_func("DRCsetLevel",            pyDRCsetLevel);
       cPyIf::register_func("DRCgetLevel",            pyDRCgetLevel);
       cPyIf::register_func("DRCcheckArea",           pyDRCcheckArea);
+      cPyIf::register_func("DRCcheckHier",           pyDRCcheckHier);
       cPyIf::register_func("DRCchdCheckArea",        pyDRCchdCheckArea);
+      cPyIf::register_func("DRCchdCheckChanges",     pyDRCchdCheckChanges);
       cPyIf::register_func("DRCcheckObjects",        pyDRCcheckObjects);
       cPyIf::register_func("DRCregisterExpr",        pyDRCregisterExpr);
       cPyIf::register_func("DRCtestBox",             pyDRCtestBox);
@@ -195,7 +203,9 @@ namespace {
     TCL_FUNC(DRCsetLevel,            1,  IFdrcSetLevel);
     TCL_FUNC(DRCgetLevel,            0,  IFdrcGetLevel);
     TCL_FUNC(DRCcheckArea,           2,  IFdrcCheckArea);
+    TCL_FUNC(DRCcheckHier,           1,  IFdrcCheckHier);
     TCL_FUNC(DRCchdCheckArea,        6,  IFdrcChdCheckArea);
+    TCL_FUNC(DRCchdCheckChanges,     7,  IFdrcChdCheckChanges);
     TCL_FUNC(DRCcheckObjects,        1,  IFdrcCheckObjects);
     TCL_FUNC(DRCregisterExpr,        1,  IFdrcRegisterExpr);
     TCL_FUNC(DRCtestBox,             5,  IFdrcTestBox);
@@ -227,7 +237,9 @@ namespace {
       cTclIf::register_func("DRCsetLevel",            tclDRCsetLevel);
       cTclIf::register_func("DRCgetLevel",            tclDRCgetLevel);
       cTclIf::register_func("DRCcheckArea",           tclDRCcheckArea);
+      cTclIf::register_func("DRCcheckHier",           tclDRCcheckHier);
       cTclIf::register_func("DRCchdCheckArea",        tclDRCchdCheckArea);
+      cTclIf::register_func("DRCchdCheckChanges",     tclDRCchdCheckChanges);
       cTclIf::register_func("DRCcheckObjects",        tclDRCcheckObjects);
       cTclIf::register_func("DRCregisterExpr",        tclDRCregisterExpr);
       cTclIf::register_func("DRCtestBox",             tclDRCtestBox);
@@ -268,7 +280,9 @@ cDRC::loadScriptFuncs()
   SIparse()->registerFunc("DRCsetLevel",            1,  IFdrcSetLevel);
   SIparse()->registerFunc("DRCgetLevel",            0,  IFdrcGetLevel);
   SIparse()->registerFunc("DRCcheckArea",           2,  IFdrcCheckArea);
+  SIparse()->registerFunc("DRCcheckHier",           1,  IFdrcCheckHier);
   SIparse()->registerFunc("DRCchdCheckArea",        6,  IFdrcChdCheckArea);
+  SIparse()->registerFunc("DRCchdCheckChanges",     7,  IFdrcChdCheckChanges);
   SIparse()->registerFunc("DRCcheckObjects",        1,  IFdrcCheckObjects);
   SIparse()->registerFunc("DRCregisterExpr",        1,  IFdrcRegisterExpr);
   SIparse()->registerFunc("DRCtestBox",             5,  IFdrcTestBox);
@@ -954,6 +968,117 @@ drc_funcs::IFdrcCheckArea(Variable *res, Variable *args, void*)
 }
 
 
+// (int) DRCcheckHier(file_handle_or_name)
+//
+// This function performs hierarchical batch-mode design rule checking
+// of the current cell.  Each cell in the hierarchy is checked once,
+// and objects in subcell instances are checked again in the parent
+// only where they are close enough to other instances, to geometry in
+// the parent, or to the edges of array elements to possibly interact.
+// This can be much faster than DRCcheckArea for layouts that contain
+// many instances of the same cells.
+//
+// Errors are listed for each cell, following a "# Cell cellname"
+// comment line, with coordinates in that cell.  Errors found when
+// checking instances in context follow a "# Context cellname" line,
+// and may repeat errors already listed for the master.  The Connected
+// and NoHoles tests are applied to the current cell only.  If any
+// active rule uses a derived layer, a flat check of the current cell
+// is performed instead, as for DRCcheckArea.
+//
+// The argument sets the error output destination, as for the second
+// argument of DRCcheckArea.  The function returns an integer, either
+// the number of errors found or -1 on error.
+//
+bool
+drc_funcs::IFdrcCheckHier(Variable *res, Variable *args, void*)
+{
+    int id = 0;
+    const char *fname = 0;
+    if (args[0].type == TYP_HANDLE)
+        ARG_CHK(arg_handle(args, 0, &id))
+    else if (args[0].type == TYP_STRING || args[0].type == TYP_NOTYPE ||
+            args[0].type == TYP_SCALAR)
+        ARG_CHK(arg_string(args, 0, &fname))
+
+    res->type = TYP_SCALAR;
+    res->content.value = -1;
+    CDs *sd = CurCell(Physical);
+    if (!sd) {
+        Errs()->add_error("no current cell.");
+        return (OK);
+    }
+
+    char *outfile = 0;
+    FILE *fp = 0;
+    if (id > 0) {
+        sHdl *hdl = sHdl::get(id);
+        if (hdl) {
+            if (hdl->type != HDLfd)
+                return (BAD);
+            fp = fdopen(id, (char*)hdl->data);
+            if (!fp) {
+                Errs()->add_error(
+                    "failed to open file pointer from descriptor.");
+                return (OK);
+            }
+        }
+        else {
+            Errs()->add_error("unresolved handle.");
+            return (OK);
+        }
+    }
+    else if (!fname) {
+        outfile = DRC()->errFilename(Tstring(sd->cellname()), 0);
+        if (!filestat::create_bak(outfile)) {
+            Errs()->add_error("can't open backup output file %s.",
+                outfile);
+            delete [] outfile;
+            return (OK);
+        }
+        fp = fopen(outfile, "w");
+        if (!fp) {
+            Errs()->add_error("can't open output file %s.", outfile);
+            delete [] outfile;
+            return (OK);
+        }
+    }
+    else if (*fname) {
+        if (!filestat::create_bak(fname)) {
+            Errs()->add_error("can't open backup output file %s.", fname);
+            return (OK);
+        }
+        fp = fopen(fname, "w");
+        if (!fp) {
+            Errs()->add_error("can't open output file %s.", fname);
+            return (OK);
+        }
+    }
+    if (fp) {
+        if (!DRC()->printFileHeader(fp, Tstring(sd->cellname()), 0))
+            return (OK);
+        fprintf(fp, "# Hierarchical check\n");
+    }
+
+    // implicit "Commit"
+    EditIf()->ulCommitChanges();
+
+    XIrt ret = DRC()->hierBatchTest(fp, 0);
+    if (ret != XIbad)
+        res->content.value = DRC()->getErrCount();
+    DRC()->printFileEnd(fp, DRC()->getErrCount(), true);
+    if (fp)
+        fclose(fp);
+    if (outfile) {
+        // Using default file name, update the "next" command.
+        DRC()->errReset(outfile, 0);
+        delete [] outfile;
+    }
+    PL()->ShowPrompt("Done.");
+    return (OK);
+}
+
+
 // (int) DRCchdCheckArea(chdname, cellname, gridsize, array,
 //   file_handle_or_name, flatten)
 //
@@ -1093,6 +1218,150 @@ drc_funcs::IFdrcChdCheckArea(Variable *res, Variable *args, void*)
 }
 
 
+// (int) DRCchdCheckChanges(chdname, cellname, ref_chd_or_file,
+//   refcell, preverrs, file_handle_or_name, flatten)
+//
+// This function performs an incremental batch-mode DRC of the given
+// top-level cell from the CHD whose access name is given as the
+// first argument, after changes to a layout that has been checked
+// previously.  If the given cellname is null or 0 is passed, the
+// default cell for the named CHD is assumed.
+//
+// The third argument is the access name of a CHD, or the name of a
+// layout file, containing the earlier version of the layout, and
+// refcell is the name of its top-level cell, which defaults to
+// cellname if null or 0 is passed.  The preverrs argument is the
+// name of the error file produced by checking the earlier version,
+// for example by DRCchdCheckArea.
+//
+// The two layouts are compared geometrically, on all layers, and
+// only the areas that differ, expanded by the largest rule distance
+// in use, are checked.  Errors listed in preverrs that are clear of
+// these areas are copied into the new results, so that the output
+// has the same form as from a full check.  The checking is done in
+// parallel if the Threads variable is set, as in DRCchdCheckArea.
+//
+// The file_handle_or_name and flatten arguments are as described for
+// DRCchdCheckArea.  The function returns an integer, either the
+// total number of errors or -1 on error.  If -1 is returned, an error
+// message is probably available from the GetError function.
+//
+bool
+drc_funcs::IFdrcChdCheckChanges(Variable *res, Variable *args, void*)
+{
+    const char *chdname;
+    ARG_CHK(arg_string(args, 0, &chdname))
+    const char *cname;
+    ARG_CHK(arg_string(args, 1, &cname))
+    const char *refname;
+    ARG_CHK(arg_string(args, 2, &refname))
+    const char *refcell;
+    ARG_CHK(arg_string(args, 3, &refcell))
+    const char *preverrs;
+    ARG_CHK(arg_string(args, 4, &preverrs))
+    int id = 0;
+    const char *fname = 0;
+    if (args[5].type == TYP_HANDLE)
+        ARG_CHK(arg_handle(args, 5, &id))
+    else if (args[5].type == TYP_STRING || args[5].type == TYP_NOTYPE ||
+            args[5].type == TYP_SCALAR)
+        ARG_CHK(arg_string(args, 5, &fname))
+    bool flatten;
+    ARG_CHK(arg_boolean(args, 6, &flatten))
+
+    if (!chdname || !*chdname)
+        return (BAD);
+    if (!refname || !*refname)
+        return (BAD);
+    if (!preverrs || !*preverrs)
+        return (BAD);
+
+    res->type = TYP_SCALAR;
+    res->content.value = -1;
+    cCHD *chd = CDchd()->chdRecall(chdname, false);
+    if (!chd) {
+        Errs()->add_error("Unresolved CHD access name");
+        return (OK);
+    }
+
+    // The reference can be a CHD access name or a layout file.  In
+    // the latter case, a temporary CHD is created.
+    cCHD *refchd = CDchd()->chdRecall(refname, false);
+    cCHD *tmpchd = 0;
+    if (!refchd) {
+        char *realname;
+        FILE *fp = FIO()->POpen(refname, "r", &realname);
+        if (!fp) {
+            Errs()->add_error("Unresolved reference CHD or file %s.",
+                refname);
+            return (OK);
+        }
+        FileType ft = FIO()->GetFileType(fp);
+        fclose(fp);
+        if (FIO()->IsSupportedArchiveFormat(ft))
+            tmpchd = FIO()->NewCHD(realname, ft, Physical, 0);
+        else
+            Errs()->add_error("Reference file %s type not supported.",
+                refname);
+        delete [] realname;
+        if (!tmpchd)
+            return (OK);
+        refchd = tmpchd;
+    }
+
+    FILE *fp = 0;
+    if (id > 0) {
+        sHdl *hdl = sHdl::get(id);
+        if (hdl) {
+            if (hdl->type != HDLfd) {
+                delete tmpchd;
+                return (BAD);
+            }
+            fp = fdopen(id, (char*)hdl->data);
+            if (!fp) {
+                Errs()->add_error(
+                    "failed to open file pointer from descriptor.");
+                delete tmpchd;
+                return (OK);
+            }
+        }
+        else {
+            Errs()->add_error("unresolved handle.");
+            delete tmpchd;
+            return (OK);
+        }
+    }
+    else if (fname && *fname) {
+        if (!filestat::create_bak(fname)) {
+            Errs()->add_error("can't open backup output file %s.", fname);
+            delete tmpchd;
+            return (OK);
+        }
+        fp = fopen(fname, "w");
+        if (!fp) {
+            Errs()->add_error("can't open output file %s.", fname);
+            delete tmpchd;
+            return (OK);
+        }
+    }
+    switch (DRC()->chdIncrBatchTest(chd, cname, refchd, refcell, preverrs,
+        fp, flatten)) {
+    case XIok:
+        res->content.value = DRC()->getErrCount();
+        break;
+    case XIbad:
+        break;
+    case XIintr:
+        SI()->SetInterrupt();
+        break;
+    }
+    if (fp && id <= 0)
+        fclose(fp);
+    delete tmpchd;
+    return (OK);
+}
+
+
 // (int) DRCcheckObjects(file_handle)
 //
 // This function checks each selected object for design rule
@@ -529,8 +529,10 @@ namespace {
         if (set) {
             int i;
             if (str_to_int(&i, vstring) && i >= DSP_MIN_THREADS &&
-                    i <= DSP_MAX_THREADS)
+                    i <= DSP_MAX_THREADS) {
                 DSP()->SetNumThreads(i);
+                GEO()->setNumThreads(i);
+            }
             else {
                 Log()->ErrorLogV(mh::Variables,
                     "Incorrect Threads: range %d-%d.",
@@ -538,8 +540,10 @@ namespace {
                 return (false);
             }
         }
-        else
+        else {
             DSP()->SetNumThreads(DSP_DEF_THREADS);
+            GEO()->setNumThreads(DSP_DEF_THREADS);
+        }
         CDvdb()->registerPostFunc(postset_lx);
         return (true);
     }
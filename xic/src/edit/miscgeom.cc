@@ -256,6 +256,28 @@ namespace {
         BBox AOI;
     };
 
+    // Add the trapezoids to the layer according to the mode, zl is
+    // freed.
+    //
+    XIrt add_zlist(Zlist *zl, CDs *sdesc, CDl *ld, int mode, bool ud,
+        bool merge)
+    {
+        if (mode == CLsplitH) {
+            Zlist::add(zl, sdesc, ld, ud, merge);
+            Zlist::destroy(zl);
+        }
+        else if (mode == CLsplitV) {
+            zl = Zlist::to_r(zl);
+            Zlist::add_r(zl, sdesc, ld, ud, merge);
+            Zlist::destroy(zl);
+        }
+        else {
+            // default
+            return (Zlist::to_poly_add(zl, sdesc, ld, ud, 0, merge));
+        }
+        return (XIok);
+    }
+
     // The thread work function.
     //
     int thread_proc(sTPthreadData*, void *arg)
@@ -284,23 +306,94 @@ namespace {
         if (gv->blval > 0)
             Zlist::zl_and(&zret, new Zlist(&lv->AOI, 0));
 
-        if (gv->mode == CLsplitH) {
-            Zlist::add(zret, gv->sdesc, gv->ldesc, gv->ud, gv->tmp_merge);
-            Zlist::destroy(zret);
-        }
-        else if (gv->mode == CLsplitV) {
-            zret = Zlist::to_r(zret);
-            Zlist::add_r(zret, gv->sdesc, gv->ldesc, gv->ud, gv->tmp_merge);
-            Zlist::destroy(zret);
-        }
-        else {
-            // default
-            ret = Zlist::to_poly_add(zret, gv->sdesc, gv->ldesc, gv->ud, 0,
-                gv->tmp_merge);
-        }
+        add_zlist(zret, gv->sdesc, gv->ldesc, gv->mode, gv->ud,
+            gv->tmp_merge);
         delete lv;  // Clean up done here!
         return (0);
     }
+
+
+    // When evaluating derived layers, the layers that can be
+    // evaluated at the same time are evaluated together in each grid
+    // cell, with subexpressions common to the expressions evaluated
+    // once (see SIlexprDag).
+
+    // Global parameters for a group of derived layers.
+    //
+    struct th_bvars_t
+    {
+        th_bvars_t(CDs *sd, CDl **l, sLspec **s, int n, const SIlexprDag *d,
+            int b)
+            {
+                sdesc = sd;
+                ldescs = l;
+                lspecs = s;
+                nlayers = n;
+                dag = d;
+                blval = b;
+            }
+
+        CDs *sdesc;
+        CDl **ldescs;
+        sLspec **lspecs;
+        int nlayers;
+        const SIlexprDag *dag;
+        int blval;
+    };
+
+    // Local parameters, passed to the thread work function.
+    //
+    struct th_blvars_t
+    {
+        th_blvars_t(th_bvars_t *b, const BBox *bb) : bvars(b), AOI(*bb) { }
+
+        th_bvars_t *bvars;
+        BBox AOI;
+    };
+
+    // Evaluate the layers of the group in the grid cell.  The
+    // expressions are evaluated in order, shared results are freed
+    // after the last reference.
+    //
+    XIrt eval_group(th_bvars_t *bv, const BBox *gBB)
+    {
+        BBox xBB(*gBB);
+        if (bv->blval > 0)
+            xBB.bloat(bv->blval);
+        SIlexprCx cx(bv->sdesc, CDMAXCALLDEPTH, &xBB);
+        SIlexprCache cache(bv->dag, &cx);
+
+        for (int i = 0; i < bv->nlayers; i++) {
+            Zlist *zret;
+            XIrt ret = bv->lspecs[i]->tree()->evalTree(&cx, &zret,
+                PolarityDark);
+            if (ret != XIok)
+                return (ret);
+            if (!zret)
+                continue;
+            if (bv->blval > 0)
+                Zlist::zl_and(&zret, new Zlist(gBB, 0));
+
+            CDl *ld = bv->ldescs[i];
+            ret = add_zlist(zret, bv->sdesc, ld, ld->drvMode() & CLmode,
+                false, ld->drvMode() & CLmerge);
+            if (ret != XIok)
+                return (ret);
+        }
+        return (XIok);
+    }
+
+    // The thread work function for groups.
+    //
+    int group_thread_proc(sTPthreadData*, void *arg)
+    {
+        th_blvars_t *lv = (th_blvars_t*)arg;
+        XIrt ret = eval_group(lv->bvars, &lv->AOI);
+        delete lv;
+        if (ret != XIok)
+            return (1);
+        return (0);
+    }
 }
 
 
@@ -444,21 +537,9 @@ cEdit::createLayer(CDs *sdesc, const BBox *pAOI, CDl *ld, const char *str,
             if (bloatval > 0)
                 Zlist::zl_and(&zret, new Zlist(gBB, 0));
 
-            if (mode == CLsplitH) {
-                Zlist::add(zret, sdesc, ld, ud, tmp_merge);
-                Zlist::destroy(zret);
-            }
-            else if (mode == CLsplitV) {
-                zret = Zlist::to_r(zret);
-                Zlist::add_r(zret, sdesc, ld, ud, tmp_merge);
-                Zlist::destroy(zret);
-            }
-            else {
-                // default
-                ret = Zlist::to_poly_add(zret, sdesc, ld, ud, 0, tmp_merge);
-                if (ret != XIok)
-                    return (ret);
-            }
+            ret = add_zlist(zret, sdesc, ld, mode, ud, tmp_merge);
+            if (ret != XIok)
+                return (ret);
         }
     }
 
@@ -854,6 +935,7 @@ cEdit::evalDerivedLayers(CDll **plist, CDs *sdesc, const BBox *AOI)
 
     XIrt ret = XIok;
     dltab = new SymTab(false, false);
+    CDl **ready = new CDl*[asize];
     for (;;) {
         int added = 0;
         for (int i = 0; i < asize; i++) {
@@ -868,6 +950,7 @@ cEdit::evalDerivedLayers(CDll **plist, CDs *sdesc, const BBox *AOI)
                     "Parse failed for %s layer expression:\n%s",
                     ary[i]->name(), ex, Errs()->get_error());
                 delete [] ary;
+                delete [] ready;
                 ret = XIbad;
                 goto err;
             }
@@ -883,24 +966,26 @@ cEdit::evalDerivedLayers(CDll **plist, CDs *sdesc, const BBox *AOI)
             }
             CDll::destroy(l0);
             if (!defer) {
-                // For now at least, depth is always maximum, and
-                // non-mode flags are ignored except to impose
-                // no-undo.
-
-                ret = createLayer(sdesc, AOI, ary[i], ex,
-                    CDMAXCALLDEPTH, ary[i]->drvMode() | CLnoUndo);
-                if (ret != XIok) {
-                    delete [] ary;
-                    goto err;
-                }
-                dltab->add((unsigned long)ary[i], 0, false);
+                ready[added++] = ary[i];
                 ary[i] = 0;
-                added++;
             }
         }
         if (!added)
             break;
+
+        // The ready layers reference only normal layers and layers
+        // evaluated in earlier passes, so can be evaluated together.
+
+        ret = createDerivedLayers(sdesc, AOI, ready, added);
+        for (int i = 0; i < added; i++)
+            dltab->add((unsigned long)ready[i], 0, false);
+        if (ret != XIok) {
+            delete [] ary;
+            delete [] ready;
+            goto err;
+        }
     }
+    delete [] ready;
 
     {
         sLstr lstr;
@@ -937,6 +1022,141 @@ err:
 }
 
 
+// Evaluate a group of derived layers that do not reference each
+// other.  Layers whose expressions have the same bloat value are
+// evaluated together, one pass over the grid evaluating each
+// expression in each grid cell, so that subexpressions common to the
+// expressions (such as shared layer references and terms like
+// "M1&!VIA1") are computed only once per grid cell.  Others are
+// evaluated individually with createLayer.
+//
+XIrt
+cEdit::createDerivedLayers(CDs *sdesc, const BBox *AOI, CDl **lds, int nlds)
+{
+    if (!sdesc || !lds || nlds < 1)
+        return (XIok);
+    if (!AOI)
+        AOI = sdesc->BB();
+
+    // For now at least, depth is always maximum, and non-mode flags
+    // are ignored except to impose no-undo.
+
+    sLspec **lspecs = new sLspec*[nlds];
+    int *bloats = new int[nlds];
+    XIrt ret = XIok;
+    for (int i = 0; i < nlds; i++) {
+        lspecs[i] = 0;
+        bloats[i] = 0;
+        if (ret != XIok)
+            continue;
+        const char *str = lds[i]->drvExpr();
+        sLspec *lspec = new sLspec;
+        if (!lspec->parseExpr(&str) || lspec->lname() || !lspec->tree()) {
+            delete lspec;
+            lspec = 0;
+        }
+        else {
+            char *bad = lspec->tree()->checkLayersInTree();
+            if (!bad) {
+                BBox BB(*AOI);
+                bad = lspec->tree()->checkCellsInTree(&BB);
+            }
+            if (bad || lspec->tree()->isLayerInTree(lds[i])) {
+                delete [] bad;
+                delete lspec;
+                lspec = 0;
+            }
+        }
+        if (!lspec) {
+            // Let createLayer handle it, including errors.
+            ret = createLayer(sdesc, AOI, lds[i], lds[i]->drvExpr(),
+                CDMAXCALLDEPTH, lds[i]->drvMode() | CLnoUndo);
+            continue;
+        }
+        lspecs[i] = lspec;
+        lspec->tree()->getBloat(&bloats[i]);
+    }
+
+    CDl **gld = new CDl*[nlds];
+    sLspec **gls = new sLspec*[nlds];
+    for (int i = 0; ret == XIok && i < nlds; i++) {
+        if (!lspecs[i])
+            continue;
+
+        // Gather the layers with the same bloat value, the group
+        // takes ownership of the lspecs.
+        int blval = bloats[i];
+        int ng = 0;
+        for (int j = i; j < nlds; j++) {
+            if (lspecs[j] && bloats[j] == blval) {
+                gld[ng] = lds[j];
+                gls[ng] = lspecs[j];
+                lspecs[j] = 0;
+                ng++;
+            }
+        }
+        if (ng == 1) {
+            delete gls[0];
+            ret = createLayer(sdesc, AOI, gld[0], gld[0]->drvExpr(),
+                CDMAXCALLDEPTH, gld[0]->drvMode() | CLnoUndo);
+            continue;
+        }
+
+        SIlexprDag dag;
+        for (int j = 0; j < ng; j++) {
+            sdesc->clearLayer(gld[j], false);
+            dag.addTree(gls[j]->tree());
+        }
+        dag.compile();
+
+        grd_t grd(AOI, grd_t::def_gridsize());
+        const BBox *gBB;
+        int numgrd = grd.numgrid() - 1;
+        int nth = DSP()->NumThreads();
+        if (nth > numgrd)
+            nth = numgrd;
+        numgrd++;
+
+        th_bvars_t bvars(sdesc, gld, gls, ng, &dag, blval);
+        if (nth > 0) {
+            cThreadPool pool(nth);
+            while ((gBB = grd.advance()) != 0)
+                pool.submit(group_thread_proc, new th_blvars_t(&bvars, gBB));
+            pool.run(0);
+        }
+        else {
+            int cnt = 0;
+            unsigned long check_time = 0;
+            Timer()->check_interval(check_time);
+            while ((gBB = grd.advance()) != 0) {
+                cnt++;
+                if (Timer()->check_interval(check_time)) {
+                    PL()->ShowPromptV("Evaluating region %d/%d.", cnt,
+                        numgrd);
+                }
+                ret = eval_group(&bvars, gBB);
+                if (ret != XIok) {
+                    if (ret == XIbad) {
+                        Log()->ErrorLog(layer_creation,
+                            "createLayer: Evaluation failed.");
+                    }
+                    break;
+                }
+            }
+        }
+        for (int j = 0; j < ng; j++)
+            delete gls[j];
+    }
+    for (int i = 0; i < nlds; i++)
+        delete lspecs[i];
+    delete [] lspecs;
+    delete [] bloats;
+    delete [] gld;
+    delete [] gls;
+    return (ret);
+}
+
+
 // Parse the arguments and advance the string pointer for the syntax
 //   [split|splitv|join] -s[h] -sv -j [-d depth] -da [-r] [-c] [-m] [-f]
 //     layername [=] expr
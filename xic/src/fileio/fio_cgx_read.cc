@@ -557,8 +557,10 @@ cgx_in::parse(DisplayMode mode, bool listonly, double sc, bool save_bb,
             if (type == R_ENDLIB) {
                 if (in_action == cvOpenModePrint && in_printing_done)
                     return (true);
-                if (!(this->*ftab[R_ENDLIB])(size, flags))
+                if (!(this->*ftab[R_ENDLIB])(size, flags)) {
+                    cancel_merge();
                     return (false);
+                }
                 if (in_mode == Physical)
                     FIO()->ifPrintCvLog(IFLOG_INFO, "End physical records");
                 else
@@ -570,9 +572,12 @@ cgx_in::parse(DisplayMode mode, bool listonly, double sc, bool save_bb,
             warning(buf);
             continue;
         }
-        if (!(this->*ftab[type])(size, flags))
+        if (!(this->*ftab[type])(size, flags)) {
+            cancel_merge();
             return (false);
+        }
     }
+    cancel_merge();
     FIO()->ifPrintCvLog(IFLOG_FATAL, "Premature end of file");
     return (false);
 }
@@ -716,6 +721,8 @@ cgx_in::chd_read_cell(symref_t *p, bool use_inst_list, CDs **sdret)
         *sdret = in_sdesc;
     if (ret && !end_struct())
         ret = false;
+    if (!ret)
+        cancel_merge();
     in_chd_state.pop_state(&stbak);
 
     if (!ret && in_out && in_out->was_interrupted())
@@ -1000,6 +1007,17 @@ cgx_in::read_header(bool quick)
 }
 
 
+// After an error or interrupt, make sure that box merging is no
+// longer deferred in the current cell.
+//
+void
+cgx_in::cancel_merge()
+{
+    if (in_sdesc)
+        in_sdesc->db_cancel_deferred_merge();
+}
+
+
 // Finalize cell reading, database and translation modes.
 //
 bool
@@ -1039,6 +1057,8 @@ cgx_in::end_struct()
     }
     else if (in_sdesc) {
         if (in_mode == Physical) {
+            if (!in_sdesc->endDeferredMerge())
+                return (false);
             if (!in_savebb && !in_no_test_empties && in_sdesc->isEmpty()) {
                 FIO()->ifPrintCvLog(IFLOG_INFO,
                     "Cell %s physical definition is empty at offset %llu.",
@@ -1298,6 +1318,9 @@ cgx_in::a_struct(int, int)
                 in_sdesc = sd;
             }
         }
+        // Boxes are merged when the cell is finished.
+        if (in_sdesc == sd && in_mode == Physical && FIO()->IsMergeInput())
+            in_sdesc->db_begin_deferred_merge();
     }
     return (true);
 }
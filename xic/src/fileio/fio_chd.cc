@@ -1231,6 +1231,7 @@ cCHD::write(const char *cellname, const FIOcvtPrms *prms, bool allcells)
         wc.out->read_alias(fname);
     }
 
+    CDs *bulk_sd = 0;
     if (prms->flatten() && todb) {
         // some stuff from readFlat.
 
@@ -1252,6 +1253,9 @@ cCHD::write(const char *cellname, const FIOcvtPrms *prms, bool allcells)
             Errs()->add_error("cCHD::write: back-end setup failed.");
             return (OIerror);
         }
+        // Objects are added to the new layer databases in bulk.
+        bulk_sd = sd;
+        bulk_sd->db_begin_bulk();
     }
 
     // This takes care of enabling and cleaning up after the
@@ -1268,6 +1272,8 @@ cCHD::write(const char *cellname, const FIOcvtPrms *prms, bool allcells)
         if (oiret == OIok && srf_elec)
             oiret = write(srf_elec, wc.in, prms, allcells);
     }
+    if (bulk_sd)
+        bulk_sd->endBulkLoad();
     if (todb) {
         FIO()->DecMergeControl();
         CDcbin cbin(CDcdb()->findCell(cellname, Physical));
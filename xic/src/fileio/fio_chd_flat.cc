@@ -458,7 +458,14 @@ cCHD::readFlat(const char *cellname, const FIOcvtPrms *prms,
         return (OIerror);
     }
 
+    // When flattening into the database, objects are added to the
+    // new layer databases in bulk.
+    CDs *sd = rfc.out->rf_targcell;
+    if (sd)
+        sd->db_begin_bulk();
     OItype oiret = flatten(p, rfc.in, maxdepth, prms);
+    if (sd)
+        sd->endBulkLoad();
     return (oiret);
 }
 
@@ -497,6 +504,46 @@ cCHD::readFlat_odb(SymTab **tabptr, const char *cellname,
 }
 
 
+// Read cell and its flattened hierarchy into a packed database.
+//
+// Special readFlat to read objects into a compact flat database.
+// This is a symbol table keyed by layer pointers, with the payload
+// being packed arrays of boxes, polygons, and wires with a static
+// spatial index (cd_sdb.cc/cd_sdb.h).  This uses a fraction of the
+// memory of readFlat_odb.
+//
+//  Return values:
+//    OIerror       unspecified error
+//    OIok          ok
+//    OIaborted     user aborted
+//
+// WARNING: *tabptr must be 0, or a new Symtab(false, false)
+//
+OItype
+cCHD::readFlat_pdb(SymTab **tabptr, const char *cellname,
+    const FIOcvtPrms *prms)
+{
+    cv_backend_pdb bk;
+    OItype oiret = readFlat(cellname, prms, &bk);
+    if (oiret != OIok) {
+        SymTabGen gen(bk.table, true);
+        SymTabEnt *h;
+        while ((h = gen.next()) != 0) {
+            delete (pdb_t*)h->stData;
+            delete h;
+        }
+        delete bk.table;
+        return (oiret);
+    }
+    SymTabGen gen(bk.table);
+    SymTabEnt *h;
+    while ((h = gen.next()) != 0)
+        ((pdb_t*)h->stData)->freeze();
+    *tabptr = bk.table;
+    return (OIok);
+}
+
+
 // Read cell and its flattened hierarchy into a trapezoid database.
 //
 // Special readFlat to read objects as trapezoids into a database.
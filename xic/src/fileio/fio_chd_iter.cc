@@ -757,21 +757,33 @@ namespace {
                 ci_fp = fp;
                 ci_ltab = 0;
                 ci_ldiffs = 0;
+                ci_blist = 0;
                 ci_last_ld = 0;
                 ci_diffmax = dm;
                 ci_diffcnt = 0;
                 ci_last_state = 0;
                 ci_lskip = false;
+                ci_bbonly = false;
             }
 
         ~sCmpIter()
             {
                 delete ci_ltab;
                 delete getDiffs();
+                Blist::destroy(ci_blist);
             }
 
         unsigned int diffCount() { return (ci_diffcnt); }
         void setupLdiffs() { ci_ldiffs = new SymTab(false, false); }
+        void setupBlist() { ci_bbonly = true; }
+
+        // Return the list of difference areas, the caller should free.
+        Blist *getBlist()
+            {
+                Blist *bl = ci_blist;
+                ci_blist = 0;
+                return (bl);
+            }
 
         void setupLayers(const char*, bool);
         Sdiff *getDiffs();
@@ -782,11 +794,13 @@ namespace {
         FILE *ci_fp;
         SymTab *ci_ltab;
         SymTab *ci_ldiffs;
+        Blist *ci_blist;
         CDl *ci_last_ld;
         unsigned int ci_diffmax;
         unsigned int ci_diffcnt;
         short ci_last_state;
         bool ci_lskip;
+        bool ci_bbonly;
     };
 
 
@@ -956,6 +970,30 @@ namespace {
                         goto done;
                     }
 
+                    if (ci_bbonly) {
+                        // Record only the extent of the differences
+                        // in the fine grid cell.
+                        if (z1 || z2) {
+                            BBox BB(CDnullBB);
+                            if (z1) {
+                                BBox tBB;
+                                Zlist::BB(z1, tBB);
+                                BB.add(&tBB);
+                                ci_diffcnt++;
+                            }
+                            if (z2) {
+                                BBox tBB;
+                                Zlist::BB(z2, tBB);
+                                BB.add(&tBB);
+                                ci_diffcnt++;
+                            }
+                            ci_blist = new Blist(&BB, ci_blist);
+                            Zlist::destroy(z1);
+                            Zlist::destroy(z2);
+                        }
+                        continue;
+                    }
+
                     unsigned int diffcnt = 0;
                     bool skip = false;
                     CDo *o1 = Zlist::to_obj_list(z1, ld);
@@ -1123,3 +1161,46 @@ cCHD::compareCHDs_sd(
     return (ret);
 }
 
+
+// Static function.
+// Run the comparison, returning a list of areas where differences
+// were found in blist.  The areas are fine grid cells clipped to the
+// differences, not merged.
+//
+XIrt
+cCHD::compareCHDs_bb(
+    cCHD *chd1, const char *cname1, cCHD *chd2, const char *cname2,
+    const BBox *AOI, const char *layer_list, bool skip,
+    Blist **blist, unsigned int *errcnt, int cgm, int fg)
+{
+    if (!chd1 || !chd2) {
+        Errs()->add_error("compareCHDs: null CHD pointer.");
+        return (XIbad);
+    }
+    if (MICRONS(fg) < 1.0 || MICRONS(fg) > 100.0) {
+        Errs()->add_error(
+            "compareCHDs: fine grid out of range (1.0 - 100.0).");
+        return (XIbad);
+    }
+    if (cgm < 1 || cgm > 100) {
+        Errs()->add_error(
+            "compareCHDs: coarse grid multiple out of range (1 - 100).");
+        return (XIbad);
+    }
+    if (errcnt)
+        *errcnt = 0;
+    *blist = 0;
+
+    sCmpIter iter(0, 0, cgm, fg);
+    iter.setupLayers(layer_list, skip);
+    iter.setupBlist();
+    XIrt ret = iter.run2(chd1, cname1, chd2, cname2, AOI);
+    if (ret != XIbad) {
+        *blist = iter.getBlist();
+        if (errcnt)
+            *errcnt = iter.diffCount();
+    }
+    return (ret);
+}
+
+
@@ -2418,9 +2418,20 @@ gds_in::a_bgnstr()
     }
     clear_properties();
 
+    // Objects are added to the new layer databases in bulk.  If
+    // merging, the boxes are merged after the cell is read.
+    CDs *bulk_sd = 0;
+    if (in_sdesc && in_mode == Physical) {
+        bulk_sd = in_sdesc;
+        bulk_sd->db_begin_bulk();
+        if (FIO()->IsMergeInput())
+            bulk_sd->db_begin_deferred_merge();
+    }
+
     uint64_t symoff = in_offset;
 
     bool nbad;
+    bool ret = true;
     while ((nbad = get_record())) {
         if (in_rectype == II_ENDSTR)
             break;
@@ -2429,16 +2440,24 @@ gds_in::a_bgnstr()
         if (in_rectype == II_EOF) {
             Errs()->add_error("Premature end of file.");
             fatal_error();
-            return (false);
+            ret = false;
+            break;
         }
         if (in_rectype >= GDS_NUM_REC_TYPES) {
             unsup();
             continue;
         }
-        if (!(this->*ftab[in_rectype])())
-            return (false);
+        if (!(this->*ftab[in_rectype])()) {
+            ret = false;
+            break;
+        }
     }
-    if (!nbad)
+    if (bulk_sd) {
+        bulk_sd->endBulkLoad();
+        if (!bulk_sd->endDeferredMerge())
+            ret = false;
+    }
+    if (!ret || !nbad)
         return (false);
 
     if (in_listonly) {
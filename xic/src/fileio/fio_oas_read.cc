@@ -894,6 +894,7 @@ oas_in::parse(DisplayMode mode, bool listonly, double sc, bool save_bb,
                     !in_byte_stream->error())
                 // Done reading stream.
                 break;
+            cancel_merge();
             return (false);
         }
         if (ix == 0) {
@@ -918,6 +919,7 @@ oas_in::parse(DisplayMode mode, bool listonly, double sc, bool save_bb,
             info()->add_record(ix);
         if (!dispatch(ix)) {
             Errs()->add_error("parse: failed in record type %d.", ix);
+            cancel_merge();
             return (false);
         }
         if (ix == 2) {
@@ -1032,6 +1034,8 @@ oas_in::parse_incremental(double sc)
         if (in_state != oasNeedRecord)
             break;
     }
+    if (in_state == oasError)
+        cancel_merge();
     return (!in_nogo);
 }
 
@@ -1407,6 +1411,7 @@ oas_in::chd_read_cell(symref_t *p, bool use_inst_list, CDs **sdret)
                     Errs()->add_error(
                         "Unresolved symref back-pointer from %s.",
                         in_chd_state.symref()->get_name());
+                    cancel_merge();
                     return (false);
                 }
                 if (cp->should_skip())
@@ -1419,6 +1424,7 @@ oas_in::chd_read_cell(symref_t *p, bool use_inst_list, CDs **sdret)
                 if (!CD()->FindAttr(c->attr, &at)) {
                     Errs()->add_error(
                         "Unresolved transform ticket %d.", c->attr);
+                    cancel_merge();
                     return (false);
                 }
                 int x, y, tdx, tdy;
@@ -1444,8 +1450,10 @@ oas_in::chd_read_cell(symref_t *p, bool use_inst_list, CDs **sdret)
                     CallDesc calldesc(cname, 0);
                     CDc *newo;
                     if (OIfailed(in_sdesc->makeCall(&calldesc, &tx, &ap,
-                            CDcallDb, &newo)))
+                            CDcallDb, &newo))) {
+                        cancel_merge();
                         return (false);
+                    }
                     if (newo)
                         a_add_properties(in_sdesc, newo);
                 }
@@ -1480,8 +1488,10 @@ oas_in::chd_read_cell(symref_t *p, bool use_inst_list, CDs **sdret)
 
                 oas_byte_stream *bs;
                 if (!in_cgd->get_byte_stream(Tstring(p->get_name()),
-                        s->string, &bs))
+                        s->string, &bs)) {
+                    cancel_merge();
                     return (false);
+                }
                 if (!bs)
                     continue;
 
@@ -1510,8 +1520,10 @@ oas_in::chd_read_cell(symref_t *p, bool use_inst_list, CDs **sdret)
                     }
                 }
                 delete bs;
-                if (!ret)
+                if (!ret) {
+                    cancel_merge();
                     return (false);
+                }
             }
         }
         if (ret) {
@@ -1589,6 +1601,8 @@ oas_in::chd_read_cell(symref_t *p, bool use_inst_list, CDs **sdret)
         *sdret = in_sdesc;
     if (ret)
         ret = end_cell();
+    if (!ret)
+        cancel_merge();
     in_chd_state.pop_state(&stbak);
 
     if (!ret && in_out && in_out->was_interrupted())
@@ -2082,6 +2096,17 @@ oas_in::read_header(bool)
 }
 
 
+// After an error or interrupt, make sure that box merging is no
+// longer deferred in the current cell.
+//
+void
+oas_in::cancel_merge()
+{
+    if (in_sdesc)
+        in_sdesc->db_cancel_deferred_merge();
+}
+
+
 // Finalize cell reading, database and translation modes.
 //
 bool
@@ -2111,6 +2136,8 @@ oas_in::end_cell()
     }
     else if (in_sdesc) {
         if (in_mode == Physical) {
+            if (!in_sdesc->endDeferredMerge())
+                return (false);
             if (in_cell_offset && !in_savebb && !in_no_test_empties &&
                     in_sdesc->isEmpty()) {
                 FIO()->ifPrintCvLog(IFLOG_INFO,
@@ -2388,6 +2415,9 @@ oas_in::a_cell(const char *name)
                 in_sdesc = sd;
             }
         }
+        // Boxes are merged when the cell is finished.
+        if (in_sdesc == sd && in_mode == Physical && FIO()->IsMergeInput())
+            in_sdesc->db_begin_deferred_merge();
         a_add_properties(in_sdesc, 0);
     }
     return (true);
@@ -55,6 +55,8 @@ cGEO::cGEO()
     geoSpotSize = -1;   // Defaults to MfgGrid
     geoElecRoundSides = DEF_RoundFlashSides;
     geoPhysRoundSides = DEF_RoundFlashSides;
+    geoThreads = 0;
+    geoMainThread = pthread_self();
     geoUseSclFuncs = false;
 
     new cGEOmmgr;   // Memory manager.
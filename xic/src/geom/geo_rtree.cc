@@ -41,6 +41,7 @@
 #include "geo.h"
 #include "geo_rtree.h"
 #include "geo_zlist.h"
+#include "miscutil/threadpool.h"
 #include <algorithm>
 
 
@@ -58,6 +59,9 @@
 // Check ordering after insertion.
 // #define RT_DEBUG
 
+// Minimum element count for a multi-threaded sort in bulk loading.
+#define RT_PSORT_MIN 65536
+
 int RTelem::e_minlinks = 4;
 int RTelem::e_maxlinks = 8;
 
@@ -202,12 +206,82 @@ namespace {
     {
         return (r2->op_gt(r1));
     }
+
+
+    // Parallel sort support.  The array is divided into one chunk per
+    // thread, the chunks are sorted concurrently, then adjacent runs
+    // are merged pairwise, also concurrently, until one run remains.
+
+    struct rt_sort_job_t
+    {
+        RTelem **ary;
+        unsigned int lo;
+        unsigned int mid;   // Sort [lo, hi) if mid == hi, else merge.
+        unsigned int hi;
+    };
+
+    int rt_sort_proc(sTPthreadData*, void *arg)
+    {
+        rt_sort_job_t *j = (rt_sort_job_t*)arg;
+        if (j->mid == j->hi)
+            std::sort(j->ary + j->lo, j->ary + j->hi, rt_cmp);
+        else {
+            std::inplace_merge(j->ary + j->lo, j->ary + j->mid,
+                j->ary + j->hi, rt_cmp);
+        }
+        return (0);
+    }
+
+
+    // Sort the elements into database order.  Helper threads are used
+    // for large arrays, if enabled, and if called from the main
+    // thread.
+    //
+    void rt_sort(RTelem **ary, unsigned int cnt)
+    {
+        int nth = GEO()->numThreads();
+        if (cnt < RT_PSORT_MIN || nth <= 0 || !GEO()->inMainThread()) {
+            std::sort(ary, ary + cnt, rt_cmp);
+            return;
+        }
+        int nch = nth + 1;
+        unsigned int *bnd = new unsigned int[nch + 1];
+        for (int i = 0; i <= nch; i++)
+            bnd[i] = (unsigned int)(((unsigned long long)cnt*i)/nch);
+        rt_sort_job_t *jobs = new rt_sort_job_t[nch];
+
+        cThreadPool pool(nth);
+        for (int i = 0; i < nch; i++) {
+            jobs[i].ary = ary;
+            jobs[i].lo = bnd[i];
+            jobs[i].mid = bnd[i+1];
+            jobs[i].hi = bnd[i+1];
+            pool.submit(rt_sort_proc, jobs + i);
+        }
+        pool.run(0);
+
+        for (int w = 1; w < nch; w *= 2) {
+            pool.clear();
+            int nj = 0;
+            for (int i = 0; i + w < nch; i += 2*w) {
+                jobs[nj].ary = ary;
+                jobs[nj].lo = bnd[i];
+                jobs[nj].mid = bnd[i + w];
+                jobs[nj].hi = bnd[mmMin(i + 2*w, nch)];
+                pool.submit(rt_sort_proc, jobs + nj);
+                nj++;
+            }
+            pool.run(0);
+        }
+        delete [] jobs;
+        delete [] bnd;
+    }
 }
 
 
 // Unset "deferred mode", sort the objects, and create the actual
-// database tree.  Adding object in sorted order can be much faster
-// than adding objects in arbitrary order.
+// database tree.  The tree is built by packing the sorted objects, as
+// in bulk_load.
 //
 bool
 RTree::unset_deferred()
@@ -228,21 +302,49 @@ RTree::unset_deferred()
             break;
         ary[cnt++] = rt;
     }
-    std::sort(ary, ary + cnt, rt_cmp);
+    for (unsigned int i = 0; i < cnt; i++) {
+        ary[i]->e_right = 0;
+        ary[i]->e_up = 0;
+    }
 
     rt_root = 0;
     rt_allocated = 0;
     rt_deferred = false;
 
-    bool ok = true;
+    rt_sort(ary, cnt);
+    pack_prv(ary, cnt);
+    delete [] ary;
+    return (true);
+}
+
+
+// Create the database from an array of new data elements, which
+// replaces the one-at-a-time insertion when populating an empty tree.
+// The elements are sorted into database order, then packed bottom-up
+// into nodes which are filled to capacity, except possibly the last
+// two on each level which share the remainder.  The resulting tree is
+// valid for subsequent insertions and removals.
+//
+// The tree must be empty and not in deferred mode, and the elements
+// must be unlinked data elements, or false is returned with the tree
+// unchanged.  The array is reordered but not freed, the tree takes
+// ownership of the elements.
+//
+bool
+RTree::bulk_load(RTelem **ary, unsigned int cnt)
+{
+    if (rt_root || rt_deferred)
+        return (false);
     for (unsigned int i = 0; i < cnt; i++) {
-        ary[i]->e_right = 0;
-        ary[i]->e_up = 0;
-        if (!insert_prv(ary[i]))
-            ok = false;
+        RTelem *rd = ary[i];
+        if (!rd || rd->e_up || rd->e_right || !rd->is_leaf())
+            return (false);
     }
-    delete [] ary;
-    return (ok);
+    if (!cnt)
+        return (true);
+    rt_sort(ary, cnt);
+    pack_prv(ary, cnt);
+    return (true);
 }
 
 
@@ -769,6 +871,57 @@ RTree::insert_prv(RTelem *rnew)
 #endif
     return (true);
 }
+
+
+// Build the tree from the sorted array of cnt unlinked data elements,
+// the tree must be empty.  The array is used as scratch space for the
+// node list at each level.  All nodes have at least e_minlinks
+// children.
+//
+void
+RTree::pack_prv(RTelem **ary, unsigned int cnt)
+{
+    rt_allocated = cnt;
+    unsigned int maxl = RTelem::e_maxlinks;
+    unsigned int minl = RTelem::e_minlinks;
+    while (cnt > 1) {
+        unsigned int ncnt = 0;
+        unsigned int i = 0;
+        while (i < cnt) {
+            unsigned int n = cnt - i;
+            if (n > maxl) {
+                // If the remainder would be too small to form a
+                // node, the last two nodes share the tail equally.
+                unsigned int rem = n - maxl;
+                if (rem < minl)
+                    n = n/2;
+                else
+                    n = maxl;
+            }
+            RTelem *rn = new RTelem;
+            rn->set_children(ary[i]);
+            rn->e_BB = ary[i]->e_BB;
+            for (unsigned int j = 0; j < n; j++) {
+                RTelem *r = ary[i + j];
+                r->set_parent(rn);
+                r->set_sibling(j + 1 < n ? ary[i + j + 1] : 0);
+                rn->e_BB.add(&r->e_BB);
+            }
+            rn->set_count(n);
+
+            // The write position never passes the read position.
+            ary[ncnt++] = rn;
+            i += n;
+        }
+        cnt = ncnt;
+    }
+    rt_root = ary[0];
+    rt_root->set_parent(RT_ROOT_UP);
+
+#ifdef RT_DEBUG
+    test();
+#endif
+}
 // End of RTree functions
 
 
@@ -0,0 +1,272 @@
+
+/*========================================================================*
+ *                                                                        *
+ *  Distributed by Whiteley Research Inc., Sunnyvale, California, USA     *
+ *                       http://wrcad.com                                 *
+ *  Copyright (C) 2017 Whiteley Research Inc., all rights reserved.       *
+ *  Author: Stephen R. Whiteley, except as indicated.                     *
+ *                                                                        *
+ *  As fully as possible recognizing licensing terms and conditions       *
+ *  imposed by earlier work from which this work was derived, if any,     *
+ *  this work is released under the Apache License, Version 2.0 (the      *
+ *  "License").  You may not use this file except in compliance with      *
+ *  the License, and compliance with inherited licenses which are         *
+ *  specified in a sub-header below this one if applicable.  A copy       *
+ *  of the License is provided with this distribution, or you may         *
+ *  obtain a copy of the License at                                       *
+ *                                                                        *
+ *        http://www.apache.org/licenses/LICENSE-2.0                      *
+ *                                                                        *
+ *  See the License for the specific language governing permissions       *
+ *  and limitations under the License.                                    *
+ *                                                                        *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      *
+ *   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      *
+ *   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-        *
+ *   INFRINGEMENT.  IN NO EVENT SHALL WHITELEY RESEARCH INCORPORATED      *
+ *   OR STEPHEN R. WHITELEY BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER     *
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,      *
+ *   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE       *
+ *   USE OR OTHER DEALINGS IN THE SOFTWARE.                               *
+ *                                                                        *
+ *========================================================================*
+ *               XicTools Integrated Circuit Design System                *
+ *                                                                        *
+ * Xic Integrated Circuit Layout and Schematic Editor                     *
+ *                                                                        *
+ *========================================================================*
+ $Id:$
+ *========================================================================*/
+
+#include "cd.h"
+#include "geo_yarray.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+//
+// Packed trapezoid list, used as the reference operand in clipping.
+//
+
+Yarray::Yarray(const Ylist *yl)
+{
+    init(yl);
+}
+
+
+Yarray::Yarray(const Zlist *zl)
+{
+    Ylist *yl = zl ? new Ylist(Zlist::copy(zl)) : 0;
+    init(yl);
+    Ylist::destroy(yl);
+}
+
+
+Yarray::~Yarray()
+{
+    delete [] ya_block;
+}
+
+
+// Return a copy of the zoids as a Zlist, in Ylist order.
+//
+Zlist *
+Yarray::to_zlist() const
+{
+    Zlist *z0 = 0, *ze = 0;
+    for (int i = 0; i < ya_nzoids; i++) {
+        Zoid Z(zoid(i));
+        if (!z0)
+            z0 = ze = new Zlist(&Z);
+        else {
+            ze->next = new Zlist(&Z);
+            ze = ze->next;
+        }
+    }
+    return (z0);
+}
+
+
+// Return a copy of the zoids as a Ylist.  The rows are already
+// ordered, so no sorting is needed.
+//
+Ylist *
+Yarray::to_ylist() const
+{
+    Ylist *y0 = 0, *ye = 0;
+    for (int r = 0; r < ya_nrows; r++) {
+        Zlist *z0 = 0, *ze = 0;
+        for (int i = ya_rowoff[r]; i < ya_rowoff[r+1]; i++) {
+            Zoid Z(zoid(i));
+            if (!z0)
+                z0 = ze = new Zlist(&Z);
+            else {
+                ze->next = new Zlist(&Z);
+                ze = ze->next;
+            }
+        }
+        if (!z0)
+            continue;
+        Ylist *y = new Ylist(z0, true);
+        y->y_yl = ya_rowyl[r];
+        if (!y0)
+            y0 = ye = y;
+        else {
+            ye->next = y;
+            ye = y;
+        }
+    }
+    return (y0);
+}
+
+
+// Restart the row scanning for find.
+//
+void
+Yarray::reset()
+{
+    ya_nlive = ya_nrows;
+    for (int i = 0; i < ya_nrows; i++)
+        ya_live[i] = i;
+}
+
+
+// Return the indices of zoids that may overlap the region given by
+// minleft, maxright, yu, and yl, in the same order and by the same
+// tests as the ovlchk_t loops over a Ylist.  The count is returned
+// in pcnt, the returned array belongs to this and is overwritten on
+// the next call.
+//
+// As for Ymgr, the calls must be made in descending order of yu,
+// as rows entirely above yu are dropped from consideration until
+// reset is called.
+//
+const int *
+Yarray::find(int minl, int maxr, int yu, int yl, int *pcnt)
+{
+    int n = 0, w = 0, k = 0;
+    for ( ; k < ya_nlive; k++) {
+        int r = ya_live[k];
+        if (ya_rowyl[r] >= yu)
+            continue;
+        ya_live[w++] = r;
+        if (ya_rowyu[r] <= yl) {
+            k++;
+            break;
+        }
+        n += screen_row(r, minl, maxr, yu, ya_ibuf + n);
+    }
+    for ( ; k < ya_nlive; k++)
+        ya_live[w++] = ya_live[k];
+    ya_nlive = w;
+    *pcnt = n;
+    return (ya_ibuf);
+}
+
+
+// Private initialization function.
+//
+void
+Yarray::init(const Ylist *yl)
+{
+    ya_nzoids = 0;
+    ya_nrows = 0;
+    for (const Ylist *y = yl; y; y = y->next) {
+        ya_nrows++;
+        for (const Zlist *z = y->y_zlist; z; z = z->next)
+            ya_nzoids++;
+    }
+    int n = ya_nzoids;
+    int nr = ya_nrows;
+    ya_block = new int[9*n + 4*nr + 1];
+    int *p = ya_block;
+    ya_xll = p;     p += n;
+    ya_xlr = p;     p += n;
+    ya_yl = p;      p += n;
+    ya_xul = p;     p += n;
+    ya_xur = p;     p += n;
+    ya_yu = p;      p += n;
+    ya_minl = p;    p += n;
+    ya_maxr = p;    p += n;
+    ya_ibuf = p;    p += n;
+    ya_rowoff = p;  p += nr + 1;
+    ya_rowyu = p;   p += nr;
+    ya_rowyl = p;   p += nr;
+    ya_live = p;
+
+    int i = 0, r = 0;
+    for (const Ylist *y = yl; y; y = y->next) {
+        ya_rowoff[r] = i;
+        ya_rowyu[r] = y->y_yu;
+        ya_rowyl[r] = y->y_yl;
+        r++;
+        for (const Zlist *z = y->y_zlist; z; z = z->next) {
+            const Zoid &Z = z->Z;
+            ya_xll[i] = Z.xll;
+            ya_xlr[i] = Z.xlr;
+            ya_yl[i] = Z.yl;
+            ya_xul[i] = Z.xul;
+            ya_xur[i] = Z.xur;
+            ya_yu[i] = Z.yu;
+            ya_minl[i] = Z.minleft();
+            ya_maxr[i] = Z.maxright();
+            i++;
+        }
+    }
+    ya_rowoff[r] = i;
+    reset();
+}
+
+
+// Private function to put the indices of zoids of row r that pass
+// the overlap screen into idx, returning the count.  A zoid is
+// skipped if maxright <= minl or yl >= yu, and the scan ends at the
+// first zoid with minleft >= maxr.
+//
+int
+Yarray::screen_row(int r, int minl, int maxr, int yu, int *idx) const
+{
+    int n = 0;
+    int i = ya_rowoff[r];
+    int e = ya_rowoff[r+1];
+#ifdef __SSE2__
+    const __m128i vl = _mm_set1_epi32(minl);
+    const __m128i vr = _mm_set1_epi32(maxr);
+    const __m128i vy = _mm_set1_epi32(yu);
+    for ( ; i + 4 <= e; i += 4) {
+        __m128i mnl = _mm_loadu_si128((const __m128i*)(ya_minl + i));
+        __m128i mxr = _mm_loadu_si128((const __m128i*)(ya_maxr + i));
+        __m128i zyl = _mm_loadu_si128((const __m128i*)(ya_yl + i));
+
+        int cont = _mm_movemask_ps(_mm_castsi128_ps(
+            _mm_cmplt_epi32(mnl, vr)));
+        int keep = _mm_movemask_ps(_mm_castsi128_ps(
+            _mm_and_si128(_mm_cmpgt_epi32(mxr, vl),
+            _mm_cmplt_epi32(zyl, vy))));
+        if (cont != 0xf) {
+            // Stop at the first zoid with minleft >= maxr.
+            for (int j = 0; j < 4; j++) {
+                if (!(cont & (1 << j)))
+                    return (n);
+                if (keep & (1 << j))
+                    idx[n++] = i + j;
+            }
+        }
+        for (int j = 0; keep; j++, keep >>= 1) {
+            if (keep & 1)
+                idx[n++] = i + j;
+        }
+    }
+#endif
+    for ( ; i < e; i++) {
+        if (ya_minl[i] >= maxr)
+            break;
+        if (ya_maxr[i] <= minl || ya_yl[i] >= yu)
+            continue;
+        idx[n++] = i;
+    }
+    return (n);
+}
+// End of Yarray functions.
+
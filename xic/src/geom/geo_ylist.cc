@@ -39,13 +39,20 @@
  *========================================================================*/
 
 #include "cd.h"
+#include "geo.h"
 #include "geo_zgroup.h"
 #include "geo_ylist.h"
 #include "geo_poly.h"
 #include "geo_intdb.h"
 #include "geo_ymgr.h"
+#include "geo_yarray.h"
 #include "cd_chkintr.h"
 #include "miscutil/timedbg.h"
+#include "miscutil/threadpool.h"
+
+
+// Minimum row count for band-parallel processing.
+#define YL_BAND_MIN_ROWS 1024
 
 
 // Ylist constructor, z0 is consumed.
@@ -913,6 +920,72 @@ Ylist::clip_to_zoid(const Ylist *thisyl, const Zoid *Z)
 }
 
 
+namespace {
+    // Append zt to the list, ze is advanced to the end.
+    //
+    inline void
+    append_zl(Zlist **pz0, Zlist **pze, Zlist *zt)
+    {
+        if (*pze) {
+            while ((*pze)->next)
+                *pze = (*pze)->next;
+            (*pze)->next = zt;
+        }
+        else
+            *pz0 = *pze = zt;
+    }
+
+
+    // Clip-to using the packed form of the reference list, as for
+    // Ylist::clip_to_ylist.
+    //
+    Zlist *ya_clip_to(const Ylist *thisyl, Yarray &ya) THROW_XIrt
+    {
+        Zlist *z0 = 0, *ze = 0;
+        try {
+            for (const Ylist *y = thisyl; y; y = y->next) {
+                for (Zlist *zl1 = y->y_zlist; zl1; zl1 = zl1->next) {
+                    if (checkInterrupt())
+                        throw (XIintr);
+                    int cnt;
+                    const int *ix = ya.find(zl1->Z.minleft(),
+                        zl1->Z.maxright(), zl1->Z.yu, zl1->Z.yl, &cnt);
+                    for (int i = 0; i < cnt; i++) {
+                        Zoid Z(ya.zoid(ix[i]));
+                        Zlist *zt = zl1->Z.clip_to(&Z);
+                        if (zt)
+                            append_zl(&z0, &ze, zt);
+                    }
+                }
+            }
+            return (z0);
+        }
+        catch (XIrt) {
+            Zlist::destroy(z0);
+            throw;
+        }
+    }
+
+
+    // Return a list of the zoids in ya that overlap Z, as for
+    // Ylist::overlapping.
+    //
+    Zlist *ya_overlapping(Yarray &ya, const Zoid *Z)
+    {
+        Zlist *z0 = 0;
+        int cnt;
+        const int *ix = ya.find(Z->minleft() - 1, Z->maxright() + 1,
+            Z->yu + 1, Z->yl - 1, &cnt);
+        for (int i = 0; i < cnt; i++) {
+            Zoid Zt(ya.zoid(ix[i]));
+            if (Z->intersect(&Zt, false))
+                z0 = new Zlist(&Zt, z0);
+        }
+        return (z0);
+    }
+}
+
+
 // Static function.
 // The original clip-to function for Ylists.
 // Return a zoid list representing (this & yl0).  On exception: 
@@ -924,6 +997,11 @@ Ylist::clip_to_zoid(const Ylist *thisyl, const Zoid *Z)
 Zlist *
 Ylist::clip_to_ylist(const Ylist *thisyl, const Ylist *yl0) THROW_XIrt
 {
+    if (thisyl && count_zoids(yl0) >= YA_MIN_ZOIDS) {
+        Yarray ya(yl0);
+        return (ya_clip_to(thisyl, ya));
+    }
+
     Ymgr ym(yl0);
     Zlist *z0 = 0, *ze = 0;
     try {
@@ -1122,6 +1200,9 @@ Ylist::clip_out_zoid(Ylist *thisyl, const Zoid *Z)
 Zlist *
 Ylist::clip_out_ylist(const Ylist *thisyl, const Ylist *yr) THROW_XIrt
 {
+    Yarray *yar = 0;
+    if (thisyl && count_zoids(yr) >= YA_MIN_ZOIDS)
+        yar = new Yarray(yr);
     Zlist *z0 = 0;
     try {
         for (const Ylist *y = thisyl; y; y = y->next) {
@@ -1134,7 +1215,8 @@ Ylist::clip_out_ylist(const Ylist *thisyl, const Ylist *yr) THROW_XIrt
                 // appears to be much faster than using scl_clip_out
                 // directly on the entire list.
 
-                Zlist *zb = yr->overlapping(&zl1->Z);
+                Zlist *zb = yar ? ya_overlapping(*yar, &zl1->Z) :
+                    yr->overlapping(&zl1->Z);
                 if (!zb) {
                     // No overlap, zoid is not clipped, save it.
                     z0 = new Zlist(&zl1->Z, z0);
@@ -1172,9 +1254,11 @@ Ylist::clip_out_ylist(const Ylist *thisyl, const Ylist *yr) THROW_XIrt
                 }
             }
         }
+        delete yar;
         return (z0);
     }
     catch (XIrt) {
+        delete yar;
         Zlist::destroy(z0);
         throw;
     }
@@ -1254,6 +1338,108 @@ namespace {
 }
 
 
+namespace {
+    // Band-parallel support.  Once the operands have been sliced at
+    // the scan lines, the work in each row is independent of the
+    // other rows.  For large lists, the rows are divided into
+    // horizontal bands of contiguous rows, which are processed by
+    // helper threads and the main thread.  The rows stay in place in
+    // the list, so the seams are stitched by the column/row merge
+    // that follows, as in the serial case.
+
+    // Row work function, returns true if the row changed.
+    typedef bool(*row_func_t)(Ylist*, const Zlist*);
+
+    struct band_row_t
+    {
+        Ylist *ya;
+        const Zlist *zb;
+    };
+
+    struct band_job_t
+    {
+        band_row_t *rows;
+        row_func_t func;
+        int nrows;
+        bool change;
+    };
+
+    int band_proc(sTPthreadData*, void *arg)
+    {
+        band_job_t *job = (band_job_t*)arg;
+        for (int i = 0; i < job->nrows; i++) {
+            if ((*job->func)(job->rows[i].ya, job->rows[i].zb))
+                job->change = true;
+        }
+        return (0);
+    }
+
+
+    // Return true if nrows should be processed in parallel.  Helper
+    // threads never start more threads.
+    //
+    inline bool band_parallel(int nrows)
+    {
+        return (nrows >= YL_BAND_MIN_ROWS && GEO()->numThreads() > 0 &&
+            GEO()->inMainThread());
+    }
+
+
+    // Apply func to the rows, in bands if the list is large.  Return
+    // false if interrupted.  If pchg is given, it is set if any row
+    // changed.
+    //
+    bool band_run(band_row_t *rows, int nrows, row_func_t func,
+        bool *pchg = 0)
+    {
+        bool chg = false;
+        if (band_parallel(nrows)) {
+            int nth = GEO()->numThreads();
+            int nb = nth + 1;
+            int bsz = (nrows + nb - 1)/nb;
+            band_job_t *jobs = new band_job_t[nb];
+            cThreadPool pool(nth);
+            for (int i = 0; i < nb; i++) {
+                jobs[i].rows = rows + i*bsz;
+                jobs[i].func = func;
+                jobs[i].nrows = mmMin(bsz, nrows - i*bsz);
+                jobs[i].change = false;
+                if (jobs[i].nrows > 0)
+                    pool.submit(band_proc, jobs + i);
+            }
+            pool.run(0);
+            for (int i = 0; i < nb; i++) {
+                if (jobs[i].change)
+                    chg = true;
+            }
+            delete [] jobs;
+            if (pchg)
+                *pchg = chg;
+            return (!checkInterrupt());
+        }
+        for (int i = 0; i < nrows; i++) {
+            if ((*func)(rows[i].ya, rows[i].zb))
+                chg = true;
+            if (checkInterrupt())
+                return (false);
+        }
+        if (pchg)
+            *pchg = chg;
+        return (true);
+    }
+
+
+    bool row_clip_to(Ylist *ya, const Zlist *zb)
+    {
+        Zlist *z0 = band_clip_to(ya->y_zlist, zb);
+        z0 = Zlist::sort(z0, 1);
+        Ylist::scl_merge(z0);
+        ya->set_zlist(z0);
+        return (true);
+    }
+}
+
+
 // Static function.
 // A clip-to function based on scan lines.
 //
@@ -1274,34 +1460,42 @@ Ylist::scl_clip_to_ylist(Ylist *thisyl, Ylist *y) THROW_XIrt
     }
     slice_scans(&y0, &yb);
 
-    // Run down the lists, processing each band.  We know that if
-    // zoids exist in a band, all have the same height, and none of
-    // the edges overlap if height > 1.  We keep the results in y0.
+    // Run down the lists, pairing the bands to process.  We know
+    // that if zoids exist in a band, all have the same height, and
+    // none of the edges overlap if height > 1.  We keep the results
+    // in y0.
 
+    int nr = 0;
+    for (Ylist *yt = y0; yt; yt = yt->next)
+        nr++;
+    band_row_t *rows = new band_row_t[nr];
+    nr = 0;
     Ylist *ya = y0;
-    while (ya || yb) {
-        if (ya && (!yb || ya->y_yu > yb->y_yu)) {
+    Ylist *yy = yb;
+    while (ya || yy) {
+        if (ya && (!yy || ya->y_yu > yy->y_yu)) {
             ya->set_zlist(0);
             ya = ya->next;
             continue;
         }
-        if (ya && ya->y_yu == yb->y_yu) {
-            if (!ya->y_zlist || !yb->y_zlist)
+        if (ya && ya->y_yu == yy->y_yu) {
+            if (!ya->y_zlist || !yy->y_zlist)
                 ya->set_zlist(0);
             else {
-                Zlist *z0 = band_clip_to(ya->y_zlist, yb->y_zlist);
-                z0 = Zlist::sort(z0, 1);
-                scl_merge(z0);
-                ya->set_zlist(z0);
-            }
-            if (checkInterrupt()) {
-                destroy(y0);
-                destroy(yb);
-                throw XIintr;
+                rows[nr].ya = ya;
+                rows[nr].zb = yy->y_zlist;
+                nr++;
             }
             ya = ya->next;
         }
-        yb = clear_to_next(yb);
+        yy = yy->next;
+    }
+    bool ok = band_run(rows, nr, row_clip_to);
+    delete [] rows;
+    destroy(yb);
+    if (!ok) {
+        destroy(y0);
+        throw XIintr;
     }
     y0 = strip_empty(y0);
     col_row_merge(y0);
@@ -1372,6 +1566,18 @@ namespace {
 }
 
 
+namespace {
+    bool row_clip_out_self(Ylist *ya, const Zlist*)
+    {
+        Zlist *zl = band_clip_out(ya->y_zlist);
+        zl = Zlist::sort(zl, 1);
+        Ylist::scl_merge(zl);
+        ya->y_zlist = zl;
+        return (true);
+    }
+}
+
+
 // Static function.
 // A self clip-out based on scan lines.  This may be less prone to
 // artifacts in all-angle collections than other methods.  The 'this'
@@ -1422,17 +1628,25 @@ Ylist::scl_clip_out_self(Ylist *thisyl) THROW_XIrt
     // Now, there is no overlap between scans, and every zoid in a
     // scan has the same height.
 
+    if (checkInterrupt()) {
+        destroy(y0);
+        throw XIintr;
+    }
+    int nr = 0;
+    for (Ylist *y = y0; y; y = y->next)
+        nr++;
+    band_row_t *rows = new band_row_t[nr];
+    nr = 0;
     for (Ylist *y = y0; y; y = y->next) {
-
-        if (checkInterrupt()) {
-            destroy(y0);
-            throw XIintr;
-        }
-
-        Zlist *zl = band_clip_out(y->y_zlist);
-        zl = Zlist::sort(zl, 1);
-        scl_merge(zl);
-        y->y_zlist = zl;
+        rows[nr].ya = y;
+        rows[nr].zb = 0;
+        nr++;
+    }
+    bool ok = band_run(rows, nr, row_clip_out_self);
+    delete [] rows;
+    if (!ok) {
+        destroy(y0);
+        throw XIintr;
     }
     col_row_merge(y0);
     return (y0);
@@ -1502,6 +1716,18 @@ namespace {
 }
 
 
+namespace {
+    bool row_clip_out(Ylist *ya, const Zlist *zb)
+    {
+        Zlist *z0 = band_clip_out(ya->y_zlist, zb);
+        z0 = Zlist::sort(z0, 1);
+        Ylist::scl_merge(z0);
+        ya->set_zlist(z0);
+        return (true);
+    }
+}
+
+
 // Static function.
 // A clip-out based on scan lines.  This may be less prone to
 // artifacts in all-angle collections than other methods.  Both this
@@ -1536,31 +1762,38 @@ Ylist::scl_clip_out_ylist(Ylist *thisyl, Ylist *y) THROW_XIrt
         return (y0);
     slice_scans(&y0, &yb);
 
-    // Run down the lists, processing each band.  We know that if
-    // zoids exist in a band, all have the same height, and none of
-    // the edges overlap if height > 1.
+    // Run down the lists, pairing the bands to process.  We know
+    // that if zoids exist in a band, all have the same height, and
+    // none of the edges overlap if height > 1.
 
+    int nr = 0;
+    for (Ylist *yy = y0; yy; yy = yy->next)
+        nr++;
+    band_row_t *rows = new band_row_t[nr];
+    nr = 0;
     Ylist *ya = y0;
-    while (ya || yb) {
-        if (ya && (!yb || ya->y_yu > yb->y_yu)) {
+    Ylist *yy = yb;
+    while (ya || yy) {
+        if (ya && (!yy || ya->y_yu > yy->y_yu)) {
             ya = ya->next;
             continue;
         }
-        if (ya && ya->y_yu == yb->y_yu) {
-            if (ya->y_zlist && yb->y_zlist) {
-                Zlist *z0 = band_clip_out(ya->y_zlist, yb->y_zlist);
-                z0 = Zlist::sort(z0, 1);
-                scl_merge(z0);
-                ya->set_zlist(z0);
-            }
-            if (checkInterrupt()) {
-                destroy(y0);
-                destroy(yb);
-                throw XIintr;
+        if (ya && ya->y_yu == yy->y_yu) {
+            if (ya->y_zlist && yy->y_zlist) {
+                rows[nr].ya = ya;
+                rows[nr].zb = yy->y_zlist;
+                nr++;
             }
             ya = ya->next;
         }
-        yb = clear_to_next(yb);
+        yy = yy->next;
+    }
+    bool ok = band_run(rows, nr, row_clip_out);
+    delete [] rows;
+    destroy(yb);
+    if (!ok) {
+        destroy(y0);
+        throw XIintr;
     }
     y0 = strip_empty(y0);
     col_row_merge(y0);
@@ -1655,6 +1888,18 @@ namespace {
 }
 
 
+namespace {
+    bool row_clip_xor(Ylist *ya, const Zlist *zb)
+    {
+        Zlist *z0 = band_clip_xor(ya->y_zlist, zb);
+        z0 = Zlist::sort(z0, 1);
+        Ylist::scl_merge(z0);
+        ya->set_zlist(z0);
+        return (true);
+    }
+}
+
+
 // Static function.
 // A clip-xor function based on scan lines.  This may be less prone
 // to artifacts in all-angle collections than other methods.  Both
@@ -1671,10 +1916,18 @@ Ylist::scl_clip_xor_ylist(Ylist *thisyl, Ylist *y) THROW_XIrt
         return (y0);
     slice_scans(&y0, &yb);
 
-    // Run down the lists, processing each band.  We know that if
-    // zoids exist in a band, all have the same height, and none of
-    // the edges overlap if height > 1.
-
+    // Run down the lists, merging rows of yb into y0 and pairing
+    // the bands to process.  We know that if zoids exist in a band,
+    // all have the same height, and none of the edges overlap if
+    // height > 1.  The paired rows of yb are kept in ydone until
+    // processed.
+
+    int nr = 0;
+    for (Ylist *yy = y0; yy; yy = yy->next)
+        nr++;
+    band_row_t *rows = new band_row_t[nr];
+    nr = 0;
+    Ylist *ydone = 0;
     Ylist *ya = y0;
     Ylist *yap = 0;
     while (ya || yb) {
@@ -1708,21 +1961,25 @@ Ylist::scl_clip_xor_ylist(Ylist *thisyl, Ylist *y) THROW_XIrt
                 yb->y_zlist = 0;
             }
             else if (yb->y_zlist) {
-                Zlist *z0 = band_clip_xor(ya->y_zlist, yb->y_zlist);
-                z0 = Zlist::sort(z0, 1);
-                scl_merge(z0);
-                ya->set_zlist(z0);
+                rows[nr].ya = ya;
+                rows[nr].zb = yb->y_zlist;
+                nr++;
             }
             yap = ya;
             ya = ya->next;
-            yb = clear_to_next(yb);
-        }
-        if (checkInterrupt()) {
-            destroy(y0);
-            destroy(yb);
-            throw XIintr;
+            Ylist *yx = yb;
+            yb = yb->next;
+            yx->next = ydone;
+            ydone = yx;
         }
     }
+    bool ok = band_run(rows, nr, row_clip_xor);
+    delete [] rows;
+    destroy(ydone);
+    if (!ok) {
+        destroy(y0);
+        throw XIintr;
+    }
     y0 = strip_empty(y0);
     col_row_merge(y0);
     return (y0);
@@ -1774,20 +2031,13 @@ Ylist::debug_row()
 }
 
 
-//--- Start of Ylist private functions
-
-// For each row, join adjacent elements.  On exception:  'this' is
-// freed.
-//
-bool
-Ylist::merge_rows() THROW_XIrt
-{
-    bool change = false;
-    for (Ylist *y = this; y; y = y->next) {
-        if (checkInterrupt()) {
-            destroy(this);
-            throw (XIintr);
-        }
+namespace {
+    // Join adjacent elements in the row, return true if any were
+    // joined.
+    //
+    bool row_merge(Ylist *y, const Zlist*)
+    {
+        bool change = false;
         for (Zlist *zl1 = y->y_zlist; zl1; zl1 = zl1->next) {
             Zlist *zn;
             Zlist *zp = zl1;
@@ -1804,6 +2054,49 @@ Ylist::merge_rows() THROW_XIrt
                 zp = zl2;
             }
         }
+        return (change);
+    }
+}
+
+
+//--- Start of Ylist private functions
+
+// For each row, join adjacent elements.  On exception:  'this' is
+// freed.
+//
+bool
+Ylist::merge_rows() THROW_XIrt
+{
+    int nr = 0;
+    for (Ylist *y = this; y; y = y->next)
+        nr++;
+    if (band_parallel(nr)) {
+        // The rows are independent, merge in bands.
+        band_row_t *rows = new band_row_t[nr];
+        nr = 0;
+        for (Ylist *y = this; y; y = y->next) {
+            rows[nr].ya = y;
+            rows[nr].zb = 0;
+            nr++;
+        }
+        bool change;
+        bool ok = band_run(rows, nr, row_merge, &change);
+        delete [] rows;
+        if (!ok) {
+            destroy(this);
+            throw (XIintr);
+        }
+        return (change);
+    }
+
+    bool change = false;
+    for (Ylist *y = this; y; y = y->next) {
+        if (checkInterrupt()) {
+            destroy(this);
+            throw (XIintr);
+        }
+        if (row_merge(y, 0))
+            change = true;
     }
     return (change);
 }
@@ -4257,6 +4257,7 @@ cvrt_funcs::IFchdOpenFlat(Variable *res, Variable *args, void*)
 //    ChdWriteSplit
 //    ChdGetZlist
 //    ChdOpenOdb
+//    ChdOpenPdb
 //    ChdOpenZdb
 //    ChdOpenZbdb
 //
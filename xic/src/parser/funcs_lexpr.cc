@@ -162,6 +162,7 @@ namespace {
 
         // Polymorphic Flat Database
         bool IFchdOpenOdb(Variable*, Variable*, void*);
+        bool IFchdOpenPdb(Variable*, Variable*, void*);
         bool IFchdOpenZdb(Variable*, Variable*, void*);
         bool IFchdOpenZbdb(Variable*, Variable*, void*);
         bool IFgetObjectsOdb(Variable*, Variable*, void*);
@@ -244,6 +245,7 @@ namespace {
 
     // Polymorphic Flat Database
     PY_FUNC(ChdOpenOdb,             6,  IFchdOpenOdb);
+    PY_FUNC(ChdOpenPdb,             6,  IFchdOpenPdb);
     PY_FUNC(ChdOpenZdb,             6,  IFchdOpenZdb);
     PY_FUNC(ChdOpenZbdb,            9,  IFchdOpenZbdb);
     PY_FUNC(GetObjectsOdb,          3,  IFgetObjectsOdb);
@@ -319,6 +321,7 @@ namespace {
 
       // Polymorphic Flat Database
       cPyIf::register_func("ChdOpenOdb",             pyChdOpenOdb);
+      cPyIf::register_func("ChdOpenPdb",             pyChdOpenPdb);
       cPyIf::register_func("ChdOpenZdb",             pyChdOpenZdb);
       cPyIf::register_func("ChdOpenZbdb",            pyChdOpenZbdb);
       cPyIf::register_func("GetObjectsOdb",          pyGetObjectsOdb);
@@ -397,6 +400,7 @@ namespace {
 
     // Polymorphic Flat Database
     TCL_FUNC(ChdOpenOdb,             6,  IFchdOpenOdb);
+    TCL_FUNC(ChdOpenPdb,             6,  IFchdOpenPdb);
     TCL_FUNC(ChdOpenZdb,             6,  IFchdOpenZdb);
     TCL_FUNC(ChdOpenZbdb,            9,  IFchdOpenZbdb);
     TCL_FUNC(GetObjectsOdb,          3,  IFgetObjectsOdb);
@@ -473,6 +477,7 @@ namespace {
 
       // Polymorphic Flat Database
       cTclIf::register_func("ChdOpenOdb",             tclChdOpenOdb);
+      cTclIf::register_func("ChdOpenPdb",             tclChdOpenPdb);
       cTclIf::register_func("ChdOpenZdb",             tclChdOpenZdb);
       cTclIf::register_func("ChdOpenZbdb",            tclChdOpenZbdb);
       cTclIf::register_func("GetObjectsOdb",          tclGetObjectsOdb);
@@ -589,6 +594,7 @@ SIparser::funcs_lexpr_init()
 
   // Polymorphic Flat Database
   registerFunc("ChdOpenOdb",             6,  IFchdOpenOdb);
+  registerFunc("ChdOpenPdb",             6,  IFchdOpenPdb);
   registerFunc("ChdOpenZdb",             6,  IFchdOpenZdb);
   registerFunc("ChdOpenZbdb",            9,  IFchdOpenZbdb);
   registerFunc("GetObjectsOdb",          3,  IFgetObjectsOdb);
@@ -3419,6 +3425,71 @@ lexpr_funcs::IFchdOpenOdb(Variable *res, Variable *args, void*)
 }
 
 
+// (int) ChdOpenPdb(chd_name, scale, cellname, array, clip, dbname)
+//
+// This function is like ChdOpenOdb, however the boxes, polygons, and
+// wires are saved in packed arrays with a static spatial index,
+// rather than as database objects.  This requires a fraction of the
+// memory, so is the better choice for large read-only reference
+// data.  The database can be accessed with the same functions as
+// databases created with ChdOpenOdb.
+//
+bool
+lexpr_funcs::IFchdOpenPdb(Variable *res, Variable *args, void*)
+{
+    const char *chdname;
+    ARG_CHK(arg_string(args, 0, &chdname))
+    double scale;
+    ARG_CHK(arg_real(args, 1, &scale))
+    const char *cname;
+    ARG_CHK(arg_string(args, 2, &cname))
+    double *array;
+    ARG_CHK(arg_array_if(args, 3, &array, 4))
+    bool clip;
+    ARG_CHK(arg_boolean(args, 4, &clip))
+    const char *dbname;
+    ARG_CHK(arg_string(args, 5, &dbname))
+
+    if (!chdname || !*chdname)
+        return (BAD);
+    if (!dbname || !*dbname)
+        return (BAD);
+    res->type = TYP_SCALAR;
+    res->content.value = 0;
+    cCHD *chd = CDchd()->chdRecall(chdname, false);
+    if (chd) {
+        BBox BB;
+        if (array) {
+            BB.left = INTERNAL_UNITS(array[0]);
+            BB.bottom = INTERNAL_UNITS(array[1]);
+            BB.right = INTERNAL_UNITS(array[2]);
+            BB.top = INTERNAL_UNITS(array[3]);
+            BB.fix();
+        }
+
+        FIOcvtPrms prms;
+        prms.set_scale(scale);
+        prms.set_allow_layer_mapping(true);
+        if (array) {
+            prms.set_use_window(true);
+            prms.set_window(&BB);
+            prms.set_clip(clip);
+        }
+
+        SymTab *tab = 0;  // important to initialize this
+        bool ret = chd->readFlat_pdb(&tab, cname, &prms);
+        if (ret) {
+            cSDB *db = new cSDB(dbname, tab, sdbPdb);
+            CDsdb()->saveDB(db);
+        }
+        res->content.value = ret;
+    }
+    else
+        Errs()->add_error("Unresolved CHD access name");
+    return (OK);
+}
+
+
 // (int) ChdOpenZdb(chd_name, scale, cellname, array, clip, dbname)
 //
 // This function will create a "special database" of the trapezoid
@@ -3612,22 +3683,66 @@ lexpr_funcs::IFchdOpenZbdb(Variable *res, Variable *args, void*)
 }
 
 
+namespace {
+    // Append to the list copies of the objects in pdb on ld that
+    // overlap BB.
+    //
+    void
+    pdb_copy_objects(const pdb_t *pdb, CDl *ld, const BBox *BB,
+        CDol **pol0, CDol **poe)
+    {
+        pdb_gen gen(pdb, BB);
+        for (;;) {
+            CDo *od;
+            const BBox *pBB = gen.next_box();
+            if (pBB)
+                od = new CDo(ld, pBB);
+            else {
+                const pdb_path_t *p = gen.next_path();
+                if (!p)
+                    break;
+                if (p->type == CDWIRE) {
+                    Wire w;
+                    pdb->get_wire(p, &w);
+                    w.points = Point::dup(w.points, w.numpts);
+                    od = new CDw(ld, &w);
+                }
+                else {
+                    Poly po;
+                    pdb->get_poly(p, &po);
+                    po.points = Point::dup(po.points, po.numpts);
+                    od = new CDpo(ld, &po);
+                }
+            }
+            od->set_copy(true);
+            if (*pol0) {
+                (*poe)->next = new CDol(od, 0);
+                *poe = (*poe)->next;
+            }
+            else
+                *poe = *pol0 = new CDol(od, 0);
+        }
+    }
+}
+
+
 // (object_handle) GetObjectsOdb(dbname, layer_list, array)
 //
 // This returns a handle to a list of objects, extracted from a named
-// database created with ChdOpenOdb.  The first argument is a database
-// name string as given to ChdOpenOdb (This function will not work
-// with ChdOpenZdb).  The second argument is a string containing a
-// space-separated list of layer names, or 0.  Objects for each of
-// the given layers will be obtained.  Objects on the same layer will
-// be grouped together, with groups ordered as in the layer_list.  If
-// this argument is 0, all layers will be used, ordered bottom-up as
-// in the layer table.  The third argument is an array, as passed to
-// ChdOpenOdb, or 0.  If 0, all objects for the specified layers in
-// the database will be retrieved.  Otherwise, only those objects
-// with bounding boxes that overlap the array rectangle with nonzero
-// area will be retrieved.  The objects retrieved are copies of the
-// database objects, which are not affected.
+// database created with ChdOpenOdb or ChdOpenPdb.  The first argument
+// is a database name string as given to ChdOpenOdb (This function
+// will not work with ChdOpenZdb).  The second argument is a string
+// containing a space-separated list of layer names, or 0.  Objects
+// for each of the given layers will be obtained.  Objects on the same
+// layer will be grouped together, with groups ordered as in the
+// layer_list.  If this argument is 0, all layers will be used,
+// ordered bottom-up as in the layer table.  The third argument is an
+// array, as passed to ChdOpenOdb, or 0.  If 0, all objects for the
+// specified layers in the database will be retrieved.  Otherwise,
+// only those objects with bounding boxes that overlap the array
+// rectangle with nonzero area will be retrieved.  The objects
+// retrieved are copies of the database objects, which are not
+// affected.
 //
 bool
 lexpr_funcs::IFgetObjectsOdb(Variable *res, Variable *args, void*)
@@ -3654,7 +3769,39 @@ lexpr_funcs::IFgetObjectsOdb(Variable *res, Variable *args, void*)
     res->content.value = 0;
 
     cSDB *db = CDsdb()->findDB(dbname);
-    if (db && db->type() == sdbOdb && db->table()) {
+    if (db && db->type() == sdbPdb && db->table()) {
+        const BBox *pBB = array ? &BB : &CDinfiniteBB;
+        CDol *ol0 = 0, *oe = 0;
+        if (!llist) {
+            CDlgen gen(Physical);
+            CDl *ld;
+            while ((ld = gen.next()) != 0) {
+                pdb_t *pdb = (pdb_t*)SymTab::get(
+                    db->table(), (unsigned long)ld);
+                if (pdb != (pdb_t*)ST_NIL)
+                    pdb_copy_objects(pdb, ld, pBB, &ol0, &oe);
+            }
+        }
+        else {
+            const char *llist_bak = llist;
+            char *lname;
+            while ((lname = lstring::gettok(&llist)) != 0) {
+                CDl *ld = CDldb()->findLayer(lname, Physical);
+                if (ld) {
+                    pdb_t *pdb = (pdb_t*)SymTab::get(
+                        db->table(), (unsigned long)ld);
+                    if (pdb != (pdb_t*)ST_NIL)
+                        pdb_copy_objects(pdb, ld, pBB, &ol0, &oe);
+                }
+                delete [] lname;
+            }
+            delete [] llist_bak;
+        }
+        sHdl *h = new sHdlObject(ol0, SIparse()->ifGetCurPhysCell(), true);
+        res->type = TYP_HANDLE;
+        res->content.value = h->id;
+    }
+    else if (db && db->type() == sdbOdb && db->table()) {
         if (!llist) {
             CDol *ol0 = 0, *oe = 0;
             CDlgen gen(Physical);
@@ -3743,15 +3890,16 @@ lexpr_funcs::IFlistLayersDb(Variable *res, Variable *args, void*)
 // (zoidlist) GetZlistDb(dbname, layer_name, zoidlist)
 //
 // This returns a zoidlist associated with a layer, extracted from a
-// named database created with ChdOpenOdb, ChdOpenZdb, or ChdOpenZbdb.
-// The first argument is a database name string as given to ChdOpenOdb
-// or equivalent.  The second argument is the associated layer name.
+// named database created with ChdOpenOdb, ChdOpenPdb, ChdOpenZdb, or
+// ChdOpenZbdb.  The first argument is a database name string as given
+// to ChdOpenOdb or equivalent.  The second argument is the associated
+// layer name.
 //
 // The third argument is the reference trapezoid list.  If the
-// database was opened with ChdOpenOdb or ChdOpenZdb, the returned
-// zoidlist will be clipped to the reference list.  If the database
-// was opened with ChdOpenZbdb, the trapezoids for the bin containg
-// the center of the first trapezoid in the reference list will be
+// database was opened with ChdOpenOdb, ChdOpenPdb, or ChdOpenZdb, the
+// returned zoidlist will be clipped to the reference list.  If the
+// database was opened with ChdOpenZbdb, the trapezoids for the bin
+// containg the center of the first trapezoid in the reference list will be
 // returned.  In all cases, the returned trapezoids are copies, the
 // database is not affected.
 //
@@ -3802,6 +3950,22 @@ lexpr_funcs::IFgetZlistDb(Variable *res, Variable *args, void *datap)
                     }
                 }
             }
+            else if (db->type() == sdbPdb) {
+                pdb_t *pdb = (pdb_t*)SymTab::get(
+                    db->table(), (unsigned long)ld);
+                if (pdb != (pdb_t*)ST_NIL) {
+                    res->content.zlist = pdb->getZlist(zl, &ret);
+                    if (ret != XIok) {
+                        FREE_CHK_ZL(free_zl, zl)
+                        if (ret == XIbad)
+                            return (BAD);
+                        res->type = TYP_ZLIST;
+                        res->content.zlist = 0;
+                        SI()->SetInterrupt();
+                        return (OK);
+                    }
+                }
+            }
             else if (db->type() == sdbZdb) {
                 zdb_t *zdb = (zdb_t*)SymTab::get(
                     db->table(), (unsigned long)ld);
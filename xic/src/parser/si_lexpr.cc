@@ -201,6 +201,19 @@ SIlexprCx::getDbZlist(const CDl *ld, const char *name, Zlist **zret)
         }
         return (XIok);
     }
+    if (sdb->type() == sdbPdb) {
+        pdb_t *db = (pdb_t*)SymTab::get(sdb->table(), (unsigned long)ld);
+        if (db != (pdb_t*)ST_NIL) {
+            if (cx_verbose)
+                SIparse()->ifSendMessage("Zoidifying %s ...", name);
+            if (SIparse()->ifCheckInterrupt())
+                return (XIintr);
+            XIrt ret;
+            *zret = db->getZlist(getZref(), &ret);
+            return (ret);
+        }
+        return (XIok);
+    }
     if (sdb->type() == sdbZdb) {
         zdb_t *db = (zdb_t*)SymTab::get(sdb->table(), (unsigned long)ld);
         if (db != (zdb_t*)ST_NIL) {
@@ -283,6 +296,282 @@ SIlexprCx::handleInterrupt() const
 // End of SIlexprCx functions.
 
 
+namespace {
+    // Occurrence list element for SIlexprDag.
+    //
+    struct docc_t
+    {
+        docc_t(ParseNode *p, docc_t *n) : node(p), next(n) { }
+
+        ParseNode *node;
+        docc_t *next;
+    };
+
+    // The occurrences of a subexpression.  Only the first occurrence
+    // is descended, since later ones will use the cached result, so
+    // that refs is the number of times that the result is requested.
+    //
+    struct dkey_t
+    {
+        dkey_t(ParseNode *p) : occs(new docc_t(p, 0)), refs(1) { }
+
+        ~dkey_t()
+            {
+                while (occs) {
+                    docc_t *o = occs;
+                    occs = occs->next;
+                    delete o;
+                }
+            }
+
+        docc_t *occs;
+        int refs;
+    };
+}
+
+
+SIlexprDag::~SIlexprDag()
+{
+    if (ld_keytab) {
+        SymTabGen gen(ld_keytab);
+        SymTabEnt *ent;
+        while ((ent = gen.next()) != 0)
+            delete (dkey_t*)ent->stData;
+        delete ld_keytab;
+    }
+    if (ld_nodetab) {
+        // Restore the original evaluation functions.
+        SymTabGen gen(ld_nodetab);
+        SymTabEnt *ent;
+        while ((ent = gen.next()) != 0) {
+            ParseNode *p = (ParseNode*)ent->stTag;
+            node_t *n = (node_t*)ent->stData;
+            p->evfunc = n->evfunc;
+            delete n;
+        }
+        delete ld_nodetab;
+    }
+    delete [] ld_refs;
+}
+
+
+// Add a tree to the group.  This can be called only before compile.
+//
+void
+SIlexprDag::addTree(ParseNode *p)
+{
+    if (ld_nodetab)
+        return;
+    if (!ld_keytab)
+        ld_keytab = new SymTab(true, false);
+    add_node(p);
+}
+
+
+// Assign slots to the shared subexpressions, and patch in the
+// caching evaluation function.  The return is the number of slots.
+//
+int
+SIlexprDag::compile()
+{
+    if (ld_nodetab || !ld_keytab)
+        return (ld_nslots);
+    ld_nodetab = new SymTab(false, false);
+
+    SymTabGen gen(ld_keytab);
+    SymTabEnt *ent;
+    while ((ent = gen.next()) != 0) {
+        if (((dkey_t*)ent->stData)->refs > 1)
+            ld_nslots++;
+    }
+    if (ld_nslots) {
+        ld_refs = new int[ld_nslots];
+        int slot = 0;
+        gen = SymTabGen(ld_keytab);
+        while ((ent = gen.next()) != 0) {
+            dkey_t *k = (dkey_t*)ent->stData;
+            if (k->refs < 2)
+                continue;
+            ld_refs[slot] = k->refs;
+            for (docc_t *o = k->occs; o; o = o->next) {
+                ParseNode *p = o->node;
+                ld_nodetab->add((unsigned long)p, new node_t(slot, p->evfunc),
+                    false);
+                p->evfunc = &SIlexprCache::eval;
+            }
+            slot++;
+        }
+    }
+
+    gen = SymTabGen(ld_keytab);
+    while ((ent = gen.next()) != 0)
+        delete (dkey_t*)ent->stData;
+    delete ld_keytab;
+    ld_keytab = 0;
+    return (ld_nslots);
+}
+
+
+const SIlexprDag::node_t *
+SIlexprDag::findNode(const ParseNode *p) const
+{
+    void *n = SymTab::get(ld_nodetab, (unsigned long)p);
+    if (n == ST_NIL)
+        return (0);
+    return ((const node_t*)n);
+}
+
+
+// Private function to record the occurrence of a node, descending
+// into the subtree on the first occurrence only.  Constants and
+// string arguments are not considered.
+//
+void
+SIlexprDag::add_node(ParseNode *p)
+{
+    if (!p)
+        return;
+    if (p->type == PT_VAR) {
+        if (p->lexpr_string)
+            return;
+    }
+    else if (p->type != PT_BINOP && p->type != PT_UNOP &&
+            p->type != PT_FUNCTION)
+        return;
+
+    sLstr lstr;
+    p->string(lstr, true);
+    if (!lstr.string())
+        return;
+    void *k = SymTab::get(ld_keytab, lstr.string());
+    if (k != ST_NIL) {
+        ((dkey_t*)k)->refs++;
+        ((dkey_t*)k)->occs = new docc_t(p, ((dkey_t*)k)->occs);
+        return;
+    }
+    ld_keytab->add(lstring::copy(lstr.string()), new dkey_t(p), false);
+
+    if (p->type == PT_BINOP) {
+        add_node(p->left);
+        add_node(p->right);
+    }
+    else if (p->type == PT_UNOP)
+        add_node(p->left);
+    else if (p->type == PT_FUNCTION) {
+        for (ParseNode *a = p->left; a; a = a->next)
+            add_node(a);
+    }
+}
+// End of SIlexprDag functions.
+
+
+SIlexprCache::SIlexprCache(const SIlexprDag *dag, SIlexprCx *cx)
+{
+    lc_dag = dag;
+    lc_cx = cx;
+    lc_ref = cx->refZlist();
+    if (lc_ref)
+        lc_refZ = lc_ref->Z;
+    lc_depth = cx->hierDepth();
+    lc_slots = 0;
+    int n = dag->numSlots();
+    if (n > 0) {
+        lc_slots = new slot_t[n];
+        for (int i = 0; i < n; i++) {
+            lc_slots[i].zlist = 0;
+            lc_slots[i].value = 0.0;
+            lc_slots[i].refs = dag->refs(i);
+            lc_slots[i].type = TYP_NOTYPE;
+            lc_slots[i].set = false;
+        }
+    }
+    cx->setLexprCache(this);
+}
+
+
+SIlexprCache::~SIlexprCache()
+{
+    // Results from references not reached, e.g., skipped by AND
+    // look-ahead, are freed here.
+    int n = lc_dag->numSlots();
+    for (int i = 0; i < n; i++)
+        Zlist::destroy(lc_slots[i].zlist);
+    delete [] lc_slots;
+    lc_cx->setLexprCache(0);
+}
+
+
+// Static function.
+// Evaluation function patched into shared nodes.  The first request
+// for a slot evaluates the node, later requests get a copy of the
+// result, with the last request taking the saved result itself.
+//
+bool
+SIlexprCache::eval(ParseNode *p, siVariable *res, void *datap)
+{
+    SIlexprCx *cx = (SIlexprCx*)datap;
+    SIlexprCache *c = cx ? cx->lexprCache() : 0;
+    if (!c)
+        return (BAD);
+    const SIlexprDag::node_t *n = c->lc_dag->findNode(p);
+    if (!n)
+        return (BAD);
+    if (!c->in_context(cx))
+        return ((*n->evfunc)(p, res, datap));
+
+    slot_t *s = c->lc_slots + n->slot;
+    if (!s->set) {
+        bool ok = (*n->evfunc)(p, res, datap);
+        if (ok != OK)
+            return (ok);
+        s->refs--;
+        if (s->refs > 0) {
+            if (res->type == TYP_ZLIST) {
+                s->zlist = Zlist::copy(res->content.zlist);
+                s->type = TYP_ZLIST;
+                s->set = true;
+            }
+            else if (res->type == TYP_SCALAR) {
+                s->value = res->content.value;
+                s->type = TYP_SCALAR;
+                s->set = true;
+            }
+        }
+        return (OK);
+    }
+
+    s->refs--;
+    res->type = s->type;
+    if (s->type == TYP_ZLIST) {
+        if (s->refs > 0)
+            res->content.zlist = Zlist::copy(s->zlist);
+        else {
+            res->content.zlist = s->zlist;
+            s->zlist = 0;
+        }
+    }
+    else
+        res->content.value = s->value;
+    return (OK);
+}
+
+
+// Return true if the context has the reference area and depth that
+// were in effect when the cache was attached.
+//
+bool
+SIlexprCache::in_context(const SIlexprCx *cx) const
+{
+    if (cx->refZlist() != lc_ref || cx->hierDepth() != lc_depth)
+        return (false);
+    if (!lc_ref)
+        return (true);
+    Zoid Z(lc_ref->Z);
+    return (Z == lc_refZ);
+}
+// End of SIlexprCache functions.
+
+
 LDorig::LDorig(const char *name)
 {
     char *cname, *stname;
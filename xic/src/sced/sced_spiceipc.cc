@@ -97,6 +97,10 @@
 #include <fcntl.h>
 #include "miscutil/msw.h"
 #else
+#ifdef HAVE_SHMGET
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netdb.h>
@@ -214,6 +218,18 @@ cSpiceIPC::InitSpice()
             char *tbf = send_to_spice(tbuf, 120);
             delete [] tbf;
         }
+
+#ifdef HAVE_SHMGET
+        // If WRspice is running on this host, ask that bulk data be
+        // returned in shared memory.  WRspice releases that support
+        // this will append " shm" to the ping return, others ignore
+        // the option.
+        if (ipc_parent_sp_port > 0 || !ipc_spice_host || !*ipc_spice_host) {
+            char *tbf = send_to_spice("ping -shm", 10);
+            ipc_use_shm = (tbf && strstr(tbf, " shm"));
+            delete [] tbf;
+        }
+#endif
     }
     return (ipc_msg_skt > 0);
 }
@@ -1155,6 +1171,7 @@ cSpiceIPC::ctor_init()
     ipc_stdout_async = false;
 #endif
     ipc_in_spice = false;
+    ipc_use_shm = false;
     ipc_startup = false;
     ipc_level = 0;
 
@@ -1983,6 +2000,29 @@ cSpiceIPC::read_msg(int fd, int timeout, char **bufp, bool line_brk,
                 delete [] dbuf;
         }
     }
+#ifdef HAVE_SHMGET
+    else if (ipc_use_shm && lstring::match("shm", lstr.string())) {
+        // If the message is "shm id numbytes", the data are in the
+        // shared memory segment created by WRspice.  The format is
+        // the same as for "data".  WRspice owns the segment, and may
+        // reuse it for the next transfer.
+        int id, nbytes;
+        if (sscanf(lstr.string() + 4, "%d %d", &id, &nbytes) == 2 &&
+                nbytes > 0) {
+            void *addr = shmat(id, 0, SHM_RDONLY);
+            if (addr == (void*)-1) {
+                Errs()->sys_error("read_msg: shmat");
+                return (false);
+            }
+            if (databuf) {
+                unsigned char *dbuf = new unsigned char[nbytes];
+                memcpy(dbuf, addr, nbytes);
+                *databuf = dbuf;
+            }
+            shmdt(addr);
+        }
+    }
+#endif
     return (true);
 }
 
@@ -81,13 +81,15 @@ printf("terminal dealloc shm segment id %d\n", e->id);
 // Static function.
 // Allocate a shared memory block if possible, returning the shmid in
 // the argument.  If not using shared memory, return a heap allocation
-// with id = 0.
+// with id = 0.  Shared memory is used if the graphics package uses
+// it, or if ipc is set, in which case the block is used to pass data
+// to another process.
 //
 void *
-ShmCtl::allocate(int *retid, unsigned int sz)
+ShmCtl::allocate(int *retid, unsigned int sz, bool ipc)
 {
 #ifdef HAVE_SHMGET
-    if (GRpkgIf()->UseSHM()) {
+    if (ipc || GRpkgIf()->UseSHM()) {
         if (!instance) {
             fprintf(stderr, "Class ShmCtl used before allocated.\n");
             exit (1);
@@ -95,7 +97,7 @@ ShmCtl::allocate(int *retid, unsigned int sz)
 #ifdef SHMDBG
 printf("allocating shm %d bytes\n", sz);
 #endif
-        int shmid = shmget(IPC_PRIVATE, sz, IPC_CREAT | 0777);
+        int shmid = shmget(IPC_PRIVATE, sz, IPC_CREAT | 0600);
         if (shmid == -1) {
             // Some kind of error, can't use SHM.
             shmid = 0;
@@ -155,3 +157,17 @@ printf("normal dallocation\n");
     delete [] (char*)addr;
 }
 
+
+// Static function.
+// Return true if shared memory is supported.
+//
+bool
+ShmCtl::available()
+{
+#ifdef HAVE_SHMGET
+    return (true);
+#else
+    return (false);
+#endif
+}
+
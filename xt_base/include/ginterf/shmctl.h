@@ -46,8 +46,9 @@
 
 //
 // An allocator and manager for SYSV shared memory segments used for
-// the X shared memory extension when available.  This takes care of
-// cleanup when the application terminates.
+// the X shared memory extension when available, and for passing bulk
+// data between Xic and WRspice.  This takes care of cleanup when the
+// application terminates.
 //
 
 struct ShmCtl
@@ -77,8 +78,9 @@ struct ShmCtl
 
     ~ShmCtl();
 
-    static void *allocate(int*, unsigned int);
+    static void *allocate(int*, unsigned int, bool = false);
     static void deallocate(void*);
+    static bool available();
 
 private:
     itable_t<shm_el> *shm_tab;
@@ -135,6 +135,7 @@ struct sParamTab
         {
             pt_table = new sHtab(sHtab::get_ciflag(CSE_PARAM));
             pt_rctab = new sHtab(sHtab::get_ciflag(CSE_PARAM));
+            pt_memo = new sHtab(sHtab::get_ciflag(CSE_PARAM));
             pt_collapse = false;
             pt_no_sqexp = false;
             if (pt_set_predefs)
@@ -218,12 +219,15 @@ struct sParamTab
                 sParam *prm = new sParam(lstring::copy(nm), lstring::copy(val));
                 prm->set_readonly();
                 pt_table->add(prm->name(), prm);
+                invalidate();
             }
         }
 
     static void register_set_predef_callback(void(*cb)(sParamTab*))
         { pt_set_predefs = cb; }
 
+    static void clear_eval_cache();
+
     static sParamTab *copy(const sParamTab*);
     static sParamTab *extract_params(sParamTab*, const char*);
     static sParamTab *update(sParamTab*, const sParamTab*);
@@ -248,13 +252,18 @@ private:
     void squote_subst(char**) const;
     bool subst(char**) const;
     static bool tokenize(const char**, char**, char**, PTmode, const char** =0);
+    void invalidate();
 
     sHtab *pt_table;        // Main table for elements.
     sHtab *pt_rctab;        // Used for recursion testing.
+    sHtab *pt_memo;         // Expanded parameter values, computed as
+                            // needed and cleared when the table changes.
     bool pt_collapse;
     bool pt_no_sqexp;       // Don't do single-quote expansion.
 
     static void(*pt_set_predefs)(sParamTab*);
+    static sHtab *pt_evcache;   // Evaluated constant expressions.
+    static bool pt_nondet;      // Expansion evaluated a random function.
 };
 
 // Mapping used when promoting macros.
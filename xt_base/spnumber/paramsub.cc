@@ -64,6 +64,8 @@ struct ParseNode;
 
 char *sParamTab::errString = 0;
 void(*sParamTab::pt_set_predefs)(sParamTab*);
+sHtab *sParamTab::pt_evcache = 0;
+bool sParamTab::pt_nondet = false;
 
 namespace {
     char *ptok(char**, char**, char**);
@@ -80,6 +82,142 @@ namespace {
     {
         delete (sParam*)pp;
     }
+
+    // Functions that return the same value given the same arguments.
+    // Random-number functions are not included, nor is limit, which
+    // is a random function in HSPICE.
+    const char *const_funcs[] = {
+        "sqrt", "exp", "ln", "log", "log10", "abs", "sin", "cos", "tan",
+        "asin", "acos", "atan", "sinh", "cosh", "tanh", "cbrt", "floor",
+        "ceil", "int", "sgn", "pow", "pwr", "sign", 0
+    };
+
+
+    // Return true if the len characters of n name a function listed
+    // above.
+    //
+    bool is_const_func(const char *n, int len)
+    {
+        for (const char **f = const_funcs; *f; f++) {
+            if ((int)strlen(*f) == len && !strncasecmp(*f, n, len))
+                return (true);
+        }
+        return (false);
+    }
+
+
+#ifdef WRSPICE
+    // Return the number of arguments of the function call whose
+    // argument list starts at the '(' pointed to by t.
+    //
+    int call_argc(const char *t)
+    {
+        int argc = 0;
+        int depth = 0;
+        for (t++; *t; t++) {
+            if (*t == '(')
+                depth++;
+            else if (*t == ')') {
+                if (!depth)
+                    break;
+                depth--;
+            }
+            else if (*t == ',' && !depth)
+                argc++;
+            else if (!argc && !isspace(*t))
+                argc = 1;
+        }
+        return (argc);
+    }
+#endif
+
+
+    // Return true if the expression calls a function not listed
+    // above, such as a random-number function, so that evaluations
+    // may differ.
+    //
+    bool has_var_call(const char *expr)
+    {
+        for (const char *s = expr; *s; ) {
+            if (!isalpha(*s) && *s != '_') {
+                s++;
+                continue;
+            }
+            if (s > expr && (isdigit(s[-1]) || s[-1] == '.')) {
+                // Number suffix, exponent or scale factor.
+                while (isalnum(*s) || *s == '_')
+                    s++;
+                continue;
+            }
+            const char *n = s;
+            while (isalnum(*s) || *s == '_')
+                s++;
+            int len = s - n;
+            const char *t = s;
+            while (isspace(*t))
+                t++;
+            if (*t != '(')
+                continue;
+            if (!is_const_func(n, len))
+                return (true);
+#ifdef WRSPICE
+            char buf[16];
+            strncpy(buf, n, len);
+            buf[len] = 0;
+            if (Sp.IsUserFunc(buf, call_argc(t)))
+                return (true);
+#endif
+        }
+        return (false);
+    }
+
+#ifdef WRSPICE
+    // Limit on the size of the evaluated expression cache.
+#define EVCACHE_MAX 100000
+
+    // Return true if the expression evaluates to a constant that
+    // depends only on the text, i.e., it contains only numbers,
+    // operators, and calls to the functions above that are not
+    // redefined as user functions.  Names that may be vectors, such
+    // as "temper", are not constant.
+    //
+    bool is_const_expr(const char *expr)
+    {
+        for (const char *s = expr; *s; ) {
+            if (*s == '"' || *s == '$' || *s == '@' || *s == '[' ||
+                    *s == '\'') {
+                return (false);
+            }
+            if (!isalpha(*s) && *s != '_') {
+                s++;
+                continue;
+            }
+            if (s > expr && (isdigit(s[-1]) || s[-1] == '.')) {
+                // Number suffix, exponent or scale factor.
+                while (isalnum(*s) || *s == '_')
+                    s++;
+                continue;
+            }
+            const char *n = s;
+            while (isalnum(*s) || *s == '_')
+                s++;
+            int len = s - n;
+            const char *t = s;
+            while (isspace(*t))
+                t++;
+            if (*t != '(')
+                return (false);
+            if (!is_const_func(n, len))
+                return (false);
+            char buf[16];
+            strncpy(buf, n, len);
+            buf[len] = 0;
+            if (Sp.IsUserFunc(buf, call_argc(t)))
+                return (false);
+        }
+        return (true);
+    }
+#endif
 }
 
 
@@ -88,6 +226,24 @@ sParamTab::~sParamTab()
     pt_table->clear_data(&free_param, 0);
     delete pt_table;
     delete pt_rctab;
+    pt_memo->clear_data(0, 0);
+    delete pt_memo;
+}
+
+
+// Static function.
+// Clear the table of evaluated single-quoted expressions.  This
+// should be called before processing a new deck, as the saved text
+// depends on the number formatting in effect.
+//
+void
+sParamTab::clear_eval_cache()
+{
+    if (pt_evcache) {
+        pt_evcache->clear_data(0, 0);
+        delete pt_evcache;
+        pt_evcache = 0;
+    }
 }
 
 
@@ -249,6 +405,8 @@ sParamTab::extract_params(sParamTab *thispt, const char *str)
             }
         }
     }
+    if (ptab)
+        ptab->invalidate();
     return (ptab);
 }
 
@@ -288,6 +446,7 @@ sParamTab::update(sParamTab *thispt, const sParamTab *ptab)
             p0->pt_table->add(pnew->name(), pnew);
         }
     }
+    p0->invalidate();
     return (p0);
 }
 
@@ -300,6 +459,7 @@ sParamTab::update(const char *str)
 {
     if (!str)
         return;
+    invalidate();
     while (*str) {
         char *pname, *psub;
         if (!tokenize(&str, &pname, &psub, PTparam))
@@ -372,6 +532,7 @@ sParamTab::eval(const sParam *p) const
 void
 sParamTab::collapse()
 {
+    invalidate();
     sHgen gen(pt_table);
     sHent *h;
     while ((h = gen.next()) != 0) {
@@ -394,6 +555,8 @@ void
 sParamTab::define_macros(bool nopush)
 {
 #ifdef WRSPICE
+    // Expansions may depend on the functions in scope.
+    invalidate();
     if (!nopush)
         Sp.PushUserFuncs(0);
 
@@ -428,6 +591,7 @@ void
 sParamTab::undefine_macros()
 {
 #ifdef WRSPICE
+    invalidate();
     delete Sp.PopUserFuncs();
 #endif
 }
@@ -552,6 +716,7 @@ sParamTab::defn_subst(const sParamTab *thispt, char **str, PTmode mode,
                 p = new sParam(lstring::copy(pname), lstring::copy(psub));
                 tmp_tab->pt_table->add(pname, p);
             }
+            tmp_tab->invalidate();
         }
 
         if (!strcmp(tsub, psub)) {
@@ -607,31 +772,57 @@ sParamTab::line_subst(char **str) const
             chg = true;
         }
         else if (is_namechar(*tok)) {
-            char *ltok = lstring::copy(tok);
-            if (subst(&tok)) {
-                pt_rctab->add(ltok, (void*)1);
-                if (*tok == '\'')
-                    squote_subst(&tok);
-                else {
-                    if (sHtab::get(pt_rctab, tok)) {
-                        // Uh-oh, we're already subbing this token,
-                        // there is a recursive loop.
-                        delete [] errString;
-                        sLstr lstr;
-                        lstr.add("Recursion detected, parameter name: ");
-                        lstr.add(ltok);
-                        lstr.add(" value: ");
-                        lstr.add(tok);
-                        errString = lstr.string_trim();
+            // A parameter is expanded once, the result is saved and
+            // used for subsequent references.  Dependent parameters
+            // are expanded recursively, and saved in turn.
+
+            bool memo = !pt_collapse && !pt_no_sqexp && !errString;
+            const char *mtxt = memo ?
+                (const char*)sHtab::get(pt_memo, tok) : 0;
+            if (mtxt) {
+                delete [] tok;
+                tok = lstring::copy(mtxt);
+                chg = true;
+            }
+            else {
+                // The flag is set if the expansion evaluates a random
+                // function, in which case the value is not saved.
+                bool nd = pt_nondet;
+                pt_nondet = false;
+                char *ltok = lstring::copy(tok);
+                if (subst(&tok)) {
+                    pt_rctab->add(ltok, (void*)1);
+                    if (*tok == '\'')
+                        squote_subst(&tok);
+                    else {
+                        if (sHtab::get(pt_rctab, tok)) {
+                            // Uh-oh, we're already subbing this token,
+                            // there is a recursive loop.
+                            delete [] errString;
+                            sLstr lstr;
+                            lstr.add("Recursion detected, parameter name: ");
+                            lstr.add(ltok);
+                            lstr.add(" value: ");
+                            lstr.add(tok);
+                            errString = lstr.string_trim();
+                        }
+                        else
+                            line_subst(&tok);
                     }
-                    else
-                        line_subst(&tok);
-                }
 
-                pt_rctab->remove(ltok);
-                chg = true;
+                    pt_rctab->remove(ltok);
+                    chg = true;
+
+                    // Don't save unevaluated expressions, these may
+                    // have been rewritten for the function context.
+                    if (memo && !errString && !pt_nondet &&
+                            !strchr(tok, '\'') && get(ltok))
+                        pt_memo->add(ltok, lstring::copy(tok));
+                }
+                delete [] ltok;
+                if (nd)
+                    pt_nondet = true;
             }
-            delete [] ltok;
         }
         if (chg) {
             if (start > *str && start[-1] == '%')
@@ -724,7 +915,22 @@ sParamTab::squote_subst(char **str) const
     double tstart = OP.seconds();
 #endif
     line_subst(&expr);
+    if (has_var_call(expr))
+        pt_nondet = true;
 #ifdef WRSPICE
+    // Expressions which are numeric constants are evaluated once
+    // only, subcircuit instances with the same parameter values will
+    // produce identical expressions.
+    bool cacheable = is_const_expr(expr);
+    if (cacheable && pt_evcache) {
+        const char *val = (const char*)sHtab::get(pt_evcache, expr);
+        if (val) {
+            delete [] expr;
+            delete [] *str;
+            *str = lstring::copy(val);
+            return;
+        }
+    }
     sDataVec::set_temporary(true);
 #endif
 #ifdef TIME_DEBUG
@@ -797,10 +1003,17 @@ sParamTab::squote_subst(char **str) const
         return;
     }
     sDataVec::set_temporary(false);
-    delete [] expr;
     delete [] *str;
     *str = lstring::copy(SPnum.printnum(dv->realval(0), dv->units(), false));
     OP.vecGc(true);
+    if (cacheable) {
+        if (pt_evcache && pt_evcache->allocated() >= EVCACHE_MAX)
+            clear_eval_cache();
+        if (!pt_evcache)
+            pt_evcache = new sHtab(false);
+        pt_evcache->add(expr, lstring::copy(*str));
+    }
+    delete [] expr;
 #else
     const char *eptr = expr;
     double *dp = SCD()->evalExpr(&eptr);
@@ -884,6 +1097,23 @@ sParamTab::subst(char **tok) const
 }
 
 
+// Clear the saved parameter expansions, called when the table or
+// the function context changes.
+//
+void
+sParamTab::invalidate()
+{
+    if (!pt_memo->allocated())
+        return;
+    sHgen gen(pt_memo, true);
+    sHent *h;
+    while ((h = gen.next()) != 0) {
+        delete [] (char*)h->data();
+        delete h;
+    }
+}
+
+
 // Static function.
 // Grab the param = value and advance pstr.  If mode == PTparam, fail
 // on a bad construct, otherwise silently skip over bad constructs. 